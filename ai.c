@@ -1,116 +1,1417 @@
 /*
  * ai.c
- * 
+ *
  * AI opponent implementation for Tic-Tac-Toe
+ * Solves the classic 3x3 board exactly and searches larger N x N boards
+ * to a depth limit with a heuristic evaluation
  * Implements minimax algorithm with three difficulty levels:
  * - Easy (0): Random move selection
  * - Medium (1): Limited minimax with randomness
  * - Hard (2): Full optimal minimax algorithm
  */
 
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
 #include "ai.h"
+#include "trace.h"
 #include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 /**
  * AI_evaluate - Evaluate terminal game state for AI (playing as O)
- * @g: Pointer to Game structure
- * 
+ * @b: Position
+ *
  * Returns:
  *  +10 - AI (O) wins
  *  -10 - Player (X) wins
  *    0 - Draw or ongoing game
- * 
- * Note: AI plays as 'O', so O winning returns positive score
+ *
+ * Note: The search always scores from O's side, so O winning returns a
+ * positive score; AI_searchMove flips it for an AI playing X
  */
-static int AI_evaluate(Game *g) {
-  int s = g->checkWin(g);
-  if (s == -1)  // O wins
+static inline int AI_evaluate(Board b) {
+  int s = Board_winner(b);
+  if (s == BOARD_O_WINS)
     return 10;
-  if (s == 1)   // X wins
+  if (s == BOARD_X_WINS)
     return -10;
   return 0;     // Draw or ongoing
 }
 
-/* Global instrumentation counters for performance tracking */
-static int g_nodesSearched = 0;    // Total nodes explored in minimax tree
-static int g_maxDepthReached = 0;  // Maximum depth reached in search
+/* ==================== TRANSPOSITION TABLE ==================== */
+
+#define AI_SYMMETRIES 8  // 4 rotations x optional mirror
+
+/**
+ * AIKey structure (internal)
+ * Zobrist hash of the position under each of the 8 board symmetries
+ * The smallest of them is the canonical key shared by all equivalent boards
+ */
+typedef struct {
+  uint64_t h[AI_SYMMETRIES];
+} AIKey;
+
+/**
+ * AITableEntry structure (internal)
+ * One memoized node; scores are stored relative to the node so that
+ * an entry is valid whatever depth the position is reached at
+ *
+ * Threads share the table without locks: each word is written
+ * atomically and the key is stored XOR-ed with the data word, so an
+ * entry torn by two concurrent stores fails the key check on probe
+ * instead of returning another position's score
+ */
+typedef struct {
+  _Atomic uint64_t check;  // Canonical position hash ^ data
+  _Atomic uint64_t data;   // Score in bits 0-7, flag in bits 8-15, horizon
+                           // in bits 16-23 (N x N: see AITable_storeGrid)
+} AITableEntry;
+
+/* Entry kinds: alpha-beta only proves bounds for nodes outside the window */
+#define AI_TT_EMPTY 0  // Unused slot
+#define AI_TT_EXACT 1  // Score is the true minimax value
+#define AI_TT_LOWER 2  // True value >= score (search failed high)
+#define AI_TT_UPPER 3  // True value <= score (search failed low)
+
+struct AITable {
+  AITableEntry *entries;  // 2^sizeLog2 slots, indexed by key & mask
+  uint64_t mask;          // Index mask (entry count - 1)
+};
+
+static uint64_t g_zobrist[9][2];          // Random key per cell and side (0=X, 1=O)
+static uint64_t g_symZobrist[AI_SYMMETRIES][9][2];  // g_zobrist seen through each symmetry
+static uint64_t g_sideToMoveKey;          // Mixed in when O is to move
+static uint64_t g_gridZobrist[GAME_MAX_CELLS][2];  // N x N key per cell and side
+static uint64_t g_gridShapeKey[GAME_MAX_SIZE + 1][GAME_MAX_WIN_LENGTH + 1];  // Per size and K
+static int g_keysReady = 0;               // Lazily built on first table creation
+
+/**
+ * AI_splitMix - Next output of a SplitMix64 sequence
+ * @x: Sequence state, advanced
+ *
+ * Spreads one seed over the xoshiro state, so nearby seeds (game 1,
+ * game 2...) still start unrelated streams; also draws the Zobrist keys
+ */
+static uint64_t AI_splitMix(uint64_t *x) {
+  uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+/**
+ * AI_initKeys - Build Zobrist keys and symmetry tables once
+ *
+ * Symmetry s maps cell (r, c) to the cell it lands on after rotating
+ * the board s % 4 quarter turns, mirrored first when s >= 4
+ * Keys come from a fixed-seed splitmix64 so hashes are reproducible
+ * N x N keys continue the same sequence; the shape key keeps boards of
+ * different size or K that share cell indices apart in one table
+ */
+static void AI_initKeys(void) {
+  if (g_keysReady)
+    return;
+
+  uint64_t seed = 0x9E3779B97F4A7C15ull;
+  for (int cell = 0; cell < 9; ++cell)
+    for (int side = 0; side < 2; ++side)
+      g_zobrist[cell][side] = AI_splitMix(&seed);
+  g_sideToMoveKey = g_zobrist[0][0] * 0xBF58476D1CE4E5B9ull;
+  for (int cell = 0; cell < GAME_MAX_CELLS; ++cell)
+    for (int side = 0; side < 2; ++side)
+      g_gridZobrist[cell][side] = AI_splitMix(&seed);
+  for (int n = 0; n <= GAME_MAX_SIZE; ++n)
+    for (int k = 0; k <= GAME_MAX_WIN_LENGTH; ++k)
+      g_gridShapeKey[n][k] = AI_splitMix(&seed);
+
+  for (int s = 0; s < AI_SYMMETRIES; ++s) {
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        int rr = r, cc = (s >= 4) ? 2 - c : c;  // Optional mirror
+        for (int q = 0; q < s % 4; ++q) {       // Quarter turns clockwise
+          int t = rr;
+          rr = cc;
+          cc = 2 - t;
+        }
+        for (int side = 0; side < 2; ++side)
+          g_symZobrist[s][r * 3 + c][side] = g_zobrist[rr * 3 + cc][side];
+      }
+    }
+  }
+  g_keysReady = 1;
+}
+
+/**
+ * AIKey_fromBoard - Hash a packed position under all symmetries
+ * @b: Position
+ */
+static AIKey AIKey_fromBoard(Board b) {
+  AIKey k;
+  for (int s = 0; s < AI_SYMMETRIES; ++s) {
+    k.h[s] = 0;
+    for (int cell = 0; cell < 9; ++cell) {
+      if (b.x & (1u << cell))
+        k.h[s] ^= g_symZobrist[s][cell][0];
+      if (b.o & (1u << cell))
+        k.h[s] ^= g_symZobrist[s][cell][1];
+    }
+  }
+  return k;
+}
+
+/**
+ * AIKey_play - Derive the child key after a move
+ * @k: Parent key
+ * @cell: Cell index played (row * 3 + col)
+ * @side: 0 for X, 1 for O
+ */
+static inline AIKey AIKey_play(const AIKey *k, int cell, int side) {
+  AIKey child;
+  for (int s = 0; s < AI_SYMMETRIES; ++s)
+    child.h[s] = k->h[s] ^ g_symZobrist[s][cell][side];
+  return child;
+}
+
+/**
+ * AIKey_canonical - Smallest hash over all symmetries
+ * @k: Position key
+ * @oToMove: 1 if O moves next
+ *
+ * The same stones can be reached with either side to move (AI_explain
+ * scores O replies even on X's turn), so the mover is part of the key
+ */
+static inline uint64_t AIKey_canonical(const AIKey *k, int oToMove) {
+  uint64_t best = k->h[0];
+  for (int s = 1; s < AI_SYMMETRIES; ++s)
+    if (k->h[s] < best)
+      best = k->h[s];
+  return oToMove ? best ^ g_sideToMoveKey : best;
+}
+
+/**
+ * AITable_create - Allocate an empty transposition table
+ * @sizeLog2: Table holds 2^sizeLog2 entries (clamped to 8..24)
+ *
+ * Returns: New table, or NULL if allocation fails
+ */
+AITable *AITable_create(int sizeLog2) {
+  if (sizeLog2 < 8)
+    sizeLog2 = 8;
+  if (sizeLog2 > 24)
+    sizeLog2 = 24;
+
+  AI_initKeys();
+
+  AITable *t = malloc(sizeof(*t));
+  if (t == NULL)
+    return NULL;
+  t->entries = calloc((size_t)1 << sizeLog2, sizeof(AITableEntry));
+  if (t->entries == NULL) {
+    free(t);
+    return NULL;
+  }
+  t->mask = ((uint64_t)1 << sizeLog2) - 1;
+  return t;
+}
+
+/**
+ * AITable_clear - Drop all entries from a transposition table
+ * @table: Table to clear (NULL is ignored)
+ */
+void AITable_clear(AITable *table) {
+  if (table)
+    memset(table->entries, 0, (size_t)(table->mask + 1) * sizeof(AITableEntry));
+}
+
+/**
+ * AITable_destroy - Free a transposition table
+ * @table: Table to free (NULL is ignored)
+ */
+void AITable_destroy(AITable *table) {
+  if (table == NULL)
+    return;
+  free(table->entries);
+  free(table);
+}
+
+/*
+ * Depth-biased scores (10 - depth for a win) depend on how deep the node
+ * sits in the current search, so the table stores them relative to the
+ * node itself by removing the node depth and re-adding it on lookup
+ */
+static inline int AI_scoreToTable(int score, int depth) {
+  return score > 0 ? score + depth : score < 0 ? score - depth : 0;
+}
+
+static inline int AI_scoreFromTable(int score, int depth) {
+  return score > 0 ? score - depth : score < 0 ? score + depth : 0;
+}
+
+/**
+ * AITable_probe - Look up a position for the current search window
+ * @t: Table to search
+ * @key: Canonical position hash
+ * @depth: Depth of the node in the current search
+ * @alpha: Lower bound of the search window
+ * @beta: Upper bound of the search window
+ * @horizon: AI_horizon of the node
+ * @score: Output for the depth-adjusted score on hit
+ * @hits: Counter bumped when the entry settles the node
+ * @misses: Counter bumped otherwise
+ *
+ * Returns: 1 if the entry settles the node, 0 otherwise
+ * Bound entries only count when they already fall outside the window,
+ * and only entries searched with the same horizon count at all
+ */
+static int AITable_probe(AITable *t, uint64_t key, int depth, int alpha,
+                         int beta, int horizon, int *score, int *hits,
+                         int *misses) {
+  AITableEntry *e = &t->entries[key & t->mask];
+  uint64_t data = atomic_load_explicit(&e->data, memory_order_relaxed);
+  uint64_t check = atomic_load_explicit(&e->check, memory_order_relaxed);
+  int flag = (int)((data >> 8) & 0xFF);
+  if (flag != AI_TT_EMPTY && (check ^ data) == key &&
+      (int)((data >> 16) & 0xFF) == horizon) {
+    int v = AI_scoreFromTable((signed char)(data & 0xFF), depth);
+    if (flag == AI_TT_EXACT || (flag == AI_TT_LOWER && v >= beta) ||
+        (flag == AI_TT_UPPER && v <= alpha)) {
+      *score = v;
+      (*hits)++;
+      return 1;
+    }
+  }
+  (*misses)++;
+  return 0;
+}
+
+/**
+ * AITable_store - Record a searched position (always replaces)
+ * @t: Table to write
+ * @key: Canonical position hash
+ * @score: Node-relative score
+ * @flag: AI_TT_EXACT, AI_TT_LOWER or AI_TT_UPPER
+ * @horizon: AI_horizon of the node
+ */
+static void AITable_store(AITable *t, uint64_t key, int score, int flag,
+                          int horizon) {
+  AITableEntry *e = &t->entries[key & t->mask];
+  uint64_t data = (uint64_t)(unsigned char)score | (uint64_t)flag << 8 |
+                  (uint64_t)horizon << 16;
+  atomic_store_explicit(&e->data, data, memory_order_relaxed);
+  atomic_store_explicit(&e->check, key ^ data, memory_order_relaxed);
+}
+
+/* ==================== ALPHA-BETA SEARCH ==================== */
+
+#define AI_MAX_PLY 64        // Deepest node tracked by the killer table
+#define AI_EXACT -1          // Root window: score every candidate exactly
+#define AI_MEDIUM_PLIES 6    // 3x3 plies Medium sees past its own move
+#define AI_MEDIUM_SLACK 2    // Medium plays anything this close to the best (3x3)
+#define AI_CLOCK_MASK 255    // Read the clock every 256 nodes of a timed search
+
+/**
+ * AI_maskMoves - List the cells of a move mask in priority order
+ * @mask: Cells that may be played (bit = cell index)
+ * @classes: Priority classes, highest first; each is a cell mask
+ * @classCount: Number of classes
+ * @moves: Output array, one entry per set bit of mask
+ *
+ * Returns: Number of moves written
+ *
+ * Cells of one class come out in ascending order. Only set bits are
+ * visited (count-trailing-zeros, clearing the lowest bit each step), so
+ * empty cells are never tested one by one
+ */
+static inline int AI_maskMoves(unsigned mask, const unsigned *classes,
+                               int classCount, int *moves) {
+  int n = 0;
+  for (int k = 0; k < classCount; ++k)
+    for (unsigned m = mask & classes[k]; m; m &= m - 1)
+      moves[n++] = __builtin_ctz(m);
+  return n;
+}
+
+/*
+ * N x N cell sets: bit row * AI_MASK_STRIDE + col, so the row above or
+ * below a cell is a fixed shift away. The stride leaves column 15 off
+ * the board, which stops a one-column shift from wrapping into the next
+ * row once the result is masked with the board
+ */
+#define AI_MASK_STRIDE 16
+#define AI_MASK_WORDS ((GAME_MAX_SIZE * AI_MASK_STRIDE + 63) / 64)
+
+/**
+ * AIMask structure (internal)
+ * Set of N x N cells in the AI_MASK_STRIDE layout
+ */
+typedef struct {
+  uint64_t w[AI_MASK_WORDS];
+} AIMask;
+
+/**
+ * AIMask_shift - Move every cell of a set by a number of bits
+ * @m: Set to shift
+ * @bits: Positive towards higher cells, negative towards lower (|bits| < 64)
+ */
+static inline AIMask AIMask_shift(const AIMask *m, int bits) {
+  AIMask out;
+  if (bits >= 0) {
+    for (int i = AI_MASK_WORDS - 1; i >= 0; --i)
+      out.w[i] = (m->w[i] << bits) |
+                 (i > 0 && bits ? m->w[i - 1] >> (64 - bits) : 0);
+  } else {
+    bits = -bits;
+    for (int i = 0; i < AI_MASK_WORDS; ++i)
+      out.w[i] = (m->w[i] >> bits) |
+                 (i + 1 < AI_MASK_WORDS ? m->w[i + 1] << (64 - bits) : 0);
+  }
+  return out;
+}
+
+/**
+ * AIMask_assign - Add or remove one cell
+ * @m: Set to update
+ * @r: Row
+ * @c: Column
+ * @on: 1 to add, 0 to remove
+ */
+static inline void AIMask_assign(AIMask *m, int r, int c, int on) {
+  int bit = r * AI_MASK_STRIDE + c;
+  uint64_t b = 1ull << (bit & 63);
+  if (on)
+    m->w[bit >> 6] |= b;
+  else
+    m->w[bit >> 6] &= ~b;
+}
+
+/**
+ * AI_clockMs - Monotonic clock in milliseconds
+ */
+static double AI_clockMs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * AISearch structure (internal)
+ * Everything one search mutates, so searches are reentrant: each thread
+ * searching a position owns its context and shares only the table
+ */
+typedef struct {
+  AITable *tt;           // Transposition table (NULL = none)
+  int moveOrder;         // AI_ORDER_* mode used to sort children
+  Board root;            // Root position, copied from the game (3x3)
+  int classic;           // 1 for the exact 3x3 bitboard search
+  int size;              // Board side
+  int winLength;         // Stones in a row needed to win
+  int depthLimit;        // Plies searched, root move included (N x N only)
+  int stones;            // Stones on cells
+  long long eval;        // Heuristic value of cells, kept up to date per move
+  char cells[GAME_MAX_CELLS];  // Private row-major board copy (N x N only)
+  AIMask occupied;       // Cells holding a stone (N x N only)
+  AIMask onBoard;        // Every cell of the board (N x N only)
+  uint64_t gridKey;      // Zobrist key of cells, kept up to date (N x N with a table)
+  int nodes;             // Nodes explored
+  int maxDepth;          // Deepest node reached
+  int tableHits;         // Table probes that settled a node
+  int tableMisses;       // Table probes that did not
+  int cutoffs;           // Beta cutoffs
+  int depthNodes[AI_STATS_DEPTHS];  // Nodes per depth (last bucket: deeper)
+  int horizon;           // Leaves scored heuristically at the depth limit
+  int plyLimit;          // 3x3: depth scored as a draw unsearched (Medium)
+  double deadline;       // AI_clockMs time to give up at (0 = never)
+  int aborted;           // Set once the deadline has passed
+  int history[2][9];     // Cutoff credit per side and cell (AI_ORDER_HISTORY)
+  int killer[AI_MAX_PLY];  // Last cutoff move per depth (-1 = none)
+} AISearch;
+
+/* Move priority classes (see AI_maskMoves): cell order, or the static
+ * center, corners, edges order (4, 0 2 6 8, 1 3 5 7) */
+static const unsigned AI_ROW_MAJOR_CLASSES[1] = {BOARD_FULL_MASK};
+static const unsigned AI_STATIC_CLASSES[3] = {0x010, 0x145, 0x0AA};
+
+static long long AI_gridEvaluateFull(const AISearch *s);
+static uint64_t AI_gridKey(const AISearch *s);
+
+/**
+ * AI_beginSearch - Set up a fresh search context for an AI
+ * @s: Context to initialize
+ * @ai: AI whose settings and game position are copied in
+ *
+ * Counters and ordering heuristics start from zero
+ */
+static void AI_beginSearch(AISearch *s, const AI *ai) {
+  const Game *g = ai->game;
+  memset(s, 0, sizeof(*s));
+  s->classic = Game_isClassic(g);
+  s->tt = ai->table;
+  s->moveOrder = ai->moveOrder;
+  s->root = g->bits;
+  s->size = g->size;
+  s->winLength = g->winLength;
+  s->depthLimit = ai->depthLimit;
+  s->plyLimit = AI_MAX_PLY;
+  s->stones = g->moveCount;
+  if (!s->classic) {
+    for (int r = 0; r < g->size; ++r) {
+      memcpy(&s->cells[r * g->size], g->board[r], (size_t)g->size);
+      for (int c = 0; c < g->size; ++c) {
+        AIMask_assign(&s->onBoard, r, c, 1);
+        AIMask_assign(&s->occupied, r, c, g->board[r][c] != ' ');
+      }
+    }
+    s->eval = AI_gridEvaluateFull(s);
+    if (s->tt)
+      s->gridKey = AI_gridKey(s);
+  }
+  for (int d = 0; d < AI_MAX_PLY; ++d)
+    s->killer[d] = -1;
+}
+
+/**
+ * AI_countNode - Record a visit in a context's node counters
+ * @s: Search context
+ * @depth: Depth of the node (0 right after the root move)
+ */
+static inline void AI_countNode(AISearch *s, int depth) {
+  if (depth > s->maxDepth)
+    s->maxDepth = depth;
+  s->nodes++;
+  s->depthNodes[depth < AI_STATS_DEPTHS ? depth : AI_STATS_DEPTHS - 1]++;
+}
+
+/**
+ * AI_publishStats - Add finished searches to an AI's last-search counters
+ * @stats: Counters to add to (the AI's lastSearch)
+ * @ctx: Contexts that took part in one root search
+ * @count: Number of contexts
+ */
+static void AI_publishStats(AIStats *stats, const AISearch *ctx, int count) {
+  for (int i = 0; i < count; ++i) {
+    stats->nodes += ctx[i].nodes;
+    if (ctx[i].maxDepth > stats->maxDepth)
+      stats->maxDepth = ctx[i].maxDepth;
+    stats->tableHits += ctx[i].tableHits;
+    stats->tableMisses += ctx[i].tableMisses;
+    stats->cutoffs += ctx[i].cutoffs;
+    for (int d = 0; d < AI_STATS_DEPTHS; ++d)
+      stats->depthNodes[d] += ctx[i].depthNodes[d];
+  }
+}
 
 /**
- * AI_minimax - Minimax algorithm with depth-biased scoring
- * @g: Pointer to Game structure
+ * AIStats_add - Add one set of counters to a running total
+ * @total: Totals to update
+ * @s: Counters to add
+ */
+static void AIStats_add(AIStats *total, const AIStats *s) {
+  total->searches += s->searches;
+  total->nodes += s->nodes;
+  if (s->maxDepth > total->maxDepth)
+    total->maxDepth = s->maxDepth;
+  total->tableHits += s->tableHits;
+  total->tableMisses += s->tableMisses;
+  total->cutoffs += s->cutoffs;
+  total->seconds += s->seconds;
+  for (int d = 0; d < AI_STATS_DEPTHS; ++d)
+    total->depthNodes[d] += s->depthNodes[d];
+  total->nodesPerSecond = total->seconds > 0 ? total->nodes / total->seconds : 0;
+}
+
+/**
+ * AI_orderMoves - List the empty cells in search order
+ * @s: Search context (ordering mode and heuristic tables)
+ * @empty: Bitmask of empty cells
+ * @side: Side to move (0=X, 1=O), used by the history heuristic
+ * @depth: Node depth, used to look up the killer move
+ * @moves: Output array of at least 9 cell indices
+ *
+ * Returns: Number of moves written
+ *
+ * Modes:
+ * - AI_ORDER_ROW_MAJOR: cell 0..8 (the original scan order)
+ * - AI_ORDER_STATIC: center, corners, edges
+ * - AI_ORDER_HISTORY: killer move first, then by history score,
+ *   ties broken by the static order
+ */
+static int AI_orderMoves(const AISearch *s, unsigned empty, int side,
+                         int depth, int *moves) {
+  if (s->moveOrder == AI_ORDER_ROW_MAJOR)
+    return AI_maskMoves(empty, AI_ROW_MAJOR_CLASSES, 1, moves);
+
+  int n = AI_maskMoves(empty, AI_STATIC_CLASSES, 3, moves);
+  if (s->moveOrder != AI_ORDER_HISTORY)
+    return n;
+
+  // Stable insertion sort by history score keeps static order on ties
+  const int *hist = s->history[side];
+  for (int i = 1; i < n; ++i) {
+    int m = moves[i], j = i - 1;
+    while (j >= 0 && hist[moves[j]] < hist[m]) {
+      moves[j + 1] = moves[j];
+      --j;
+    }
+    moves[j + 1] = m;
+  }
+
+  // Promote the killer move for this depth to the front
+  int killer = depth < AI_MAX_PLY ? s->killer[depth] : -1;
+  for (int i = 1; i < n; ++i) {
+    if (moves[i] == killer) {
+      for (int j = i; j > 0; --j)
+        moves[j] = moves[j - 1];
+      moves[0] = killer;
+      break;
+    }
+  }
+  return n;
+}
+
+/**
+ * AI_horizon - How far Medium's ply cut sits below a 3x3 node
+ * @s: Search context
+ * @depth: Depth of the node
+ * @empty: Empty cells of the node
+ *
+ * Returns: 0 if the cut cannot be reached before the board fills (the
+ *          score is then the full-search value), otherwise the plies
+ *          left to it plus one
+ *
+ * A score under the cut depends on how many plies were left, so table
+ * entries carry this and only match nodes with the same horizon;
+ * full searches and Medium still share every entry the cut never reaches
+ */
+static inline int AI_horizon(const AISearch *s, int depth, unsigned empty) {
+  int left = s->plyLimit - depth;
+  return left >= __builtin_popcount(empty) ? 0 : left + 1;
+}
+
+/**
+ * AI_minimax - Minimax algorithm with alpha-beta pruning and depth-biased scoring
+ * @s: Search context (table, move ordering and counters)
+ * @b: Position to score
  * @depth: Current search depth (0 at root)
  * @isMax: 1 if maximizing player (AI/O), 0 if minimizing player (X)
- * 
- * Returns: Best score achievable from current position
- * 
+ * @alpha: Best score the maximizer is already assured of
+ * @beta: Best score the minimizer is already assured of
+ * @key: Zobrist key of the position (ignored when s->tt is NULL)
+ *
+ * Returns: Best score achievable from current position when it lies
+ *          inside (alpha, beta); otherwise a bound on the wrong side of
+ *          the window (fail-soft). A window of (-INT_MAX, INT_MAX) never
+ *          cuts, so the result is always exact
+ *
+ * Works on a Board passed by value, so each child is Board_play of the
+ * parent and nothing is undone; every board operation is inline and no
+ * Game method is called through a function pointer
+ *
  * Algorithm:
  * 1. Check if game is over (win/loss/draw) - return score
- * 2. If maximizing (AI turn): try all moves, pick maximum score
- * 3. If minimizing (opponent turn): try all moves, pick minimum score
+ * 2. If maximizing (AI turn): try moves, raise alpha, stop once alpha >= beta
+ * 3. If minimizing (opponent turn): try moves, lower beta, stop once alpha >= beta
  * 4. Use depth bias to prefer quicker wins and delay losses
- * 
+ *
  * Depth bias: Winning sooner is better (score - depth)
  *             Losing later is better (score + depth)
  */
-static int AI_minimax(Game *g, int depth, int isMax) {
+static int AI_minimax(AISearch *s, Board b, int depth, int isMax, int alpha,
+                      int beta, const AIKey *key) {
   // Track instrumentation
-  if (depth > g_maxDepthReached)
-    g_maxDepthReached = depth;
-  g_nodesSearched++;
+  AI_countNode(s, depth);
 
   // Check for terminal state
-  int score = AI_evaluate(g);
+  int score = AI_evaluate(b);
 
   if (score == 10)  // AI wins - prefer quicker wins
     return score - depth;
   if (score == -10) // Player wins - prefer delaying loss
     return score + depth;
-  if (!g->isMovesLeft(g))  // Draw
+  unsigned empty = Board_emptyMask(b);
+  if (!empty)  // Draw
     return 0;
+  if (depth >= s->plyLimit) {  // Medium's horizon: assume a draw
+    s->horizon++;
+    return 0;
+  }
 
-  // Maximizing player (AI playing as 'O')
-  if (isMax) {
-    int best = -INT_MAX;
-    // Try all possible moves
-    for (int i = 0; i < 3; ++i) {
-      for (int j = 0; j < 3; ++j) {
-        if (g->board[i][j] == ' ') {
-          // Make move and recurse
-          g->makeMove(g, i, j, 'O');
-          int val = AI_minimax(g, depth + 1, 0);
-          // Undo move
-          g->makeMove(g, i, j, ' ');
-          // Update best score
-          if (val > best)
-            best = val;
+  // Reuse the value of this position (or any symmetric twin) if known
+  uint64_t canon = 0;
+  int horizon = 0;
+  if (s->tt) {
+    int cached;
+    canon = AIKey_canonical(key, isMax);
+    horizon = AI_horizon(s, depth, empty);
+    if (AITable_probe(s->tt, canon, depth, alpha, beta, horizon, &cached,
+                      &s->tableHits, &s->tableMisses))
+      return cached;
+  }
+
+  int alphaOrig = alpha, betaOrig = beta;
+  int moves[9];
+  int n = AI_orderMoves(s, empty, isMax, depth, moves);
+  int best = isMax ? -INT_MAX : INT_MAX;
+
+  for (int k = 0; k < n; ++k) {
+    int cell = moves[k];
+    AIKey child;
+    const AIKey *childKey = NULL;  // Only read when there is a table
+    if (s->tt) {
+      child = AIKey_play(key, cell, isMax);
+      childKey = &child;
+    }
+
+    int val;
+    if (isMax) {
+      // Maximizing player (AI playing as 'O')
+      val = AI_minimax(s, Board_play(b, cell, 1), depth + 1, 0, alpha, beta,
+                       childKey);
+      if (val > best)
+        best = val;
+      if (best > alpha)
+        alpha = best;
+    } else {
+      // Minimizing player (opponent playing as 'X')
+      val = AI_minimax(s, Board_play(b, cell, 0), depth + 1, 1, alpha, beta,
+                       childKey);
+      if (val < best)
+        best = val;
+      if (best < beta)
+        beta = best;
+    }
+
+    // Remaining siblings cannot change the result
+    if (alpha >= beta) {
+      s->cutoffs++;
+      s->history[isMax][cell] += (9 - depth) * (9 - depth);
+      if (depth < AI_MAX_PLY)
+        s->killer[depth] = cell;
+      break;
+    }
+  }
+
+  if (s->tt) {
+    int flag = best <= alphaOrig ? AI_TT_UPPER
+             : best >= betaOrig  ? AI_TT_LOWER
+                                 : AI_TT_EXACT;
+    AITable_store(s->tt, canon, AI_scoreToTable(best, depth), flag, horizon);
+  }
+  return best;
+}
+
+/* ==================== N x N SEARCH ==================== */
+
+/*
+ * Boards other than 3x3 cannot be solved, so they are searched to
+ * AISearch.depthLimit plies and unfinished leaves get a heuristic score
+ * Scores keep the O-positive convention with their own scale: a win is
+ * AI_GRID_WIN minus its depth, heuristics stay within +-AI_GRID_WIN / 2
+ */
+#define AI_GRID_WIN 1000000000    // Score of a win found at depth 0
+#define AI_GRID_RADIUS 2          // Moves considered: cells this close to a stone...
+#define AI_GRID_WIDE 7            // ...or only adjacent ones on boards wider than this
+#define AI_GRID_MEDIUM_MARGIN 64  // Medium's slack, about one open three-stone window
+
+static const int AI_GRID_DIRS[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+
+/**
+ * AI_gridWindow - Heuristic value of one window of K cells
+ * @s: Search context holding the board
+ * @r: Row of the window's first cell
+ * @c: Column of the window's first cell
+ * @d: Direction index into AI_GRID_DIRS
+ *
+ * Returns: O-positive value, 0 if the window leaves the board
+ *
+ * A window holding stones of only one side is worth 8^(stones-1) to
+ * that side; one holding both sides can never be completed
+ */
+static long long AI_gridWindow(const AISearch *s, int r, int c, int d) {
+  int n = s->size, k = s->winLength;
+  int dr = AI_GRID_DIRS[d][0], dc = AI_GRID_DIRS[d][1];
+  int rEnd = r + dr * (k - 1), cEnd = c + dc * (k - 1);
+  if (r < 0 || c < 0 || c >= n || rEnd >= n || cEnd < 0 || cEnd >= n)
+    return 0;
+
+  int x = 0, o = 0;
+  for (int i = 0; i < k; ++i) {
+    char v = s->cells[(r + dr * i) * n + c + dc * i];
+    x += (v == 'X');
+    o += (v == 'O');
+  }
+  if (o && !x)
+    return 1ll << (3 * (o - 1));
+  if (x && !o)
+    return -(1ll << (3 * (x - 1)));
+  return 0;
+}
+
+/**
+ * AI_gridWindowsThrough - Sum of the windows containing one cell
+ * @s: Search context holding the board
+ * @cell: Cell index
+ *
+ * Placing or removing a stone only changes these windows, so the
+ * evaluation is updated by the difference before and after the move
+ */
+static long long AI_gridWindowsThrough(const AISearch *s, int cell) {
+  int r0 = cell / s->size, c0 = cell % s->size;
+  long long sum = 0;
+  for (int d = 0; d < 4; ++d)
+    for (int i = 0; i < s->winLength; ++i)
+      sum += AI_gridWindow(s, r0 - AI_GRID_DIRS[d][0] * i,
+                           c0 - AI_GRID_DIRS[d][1] * i, d);
+  return sum;
+}
+
+/**
+ * AI_gridEvaluateFull - Heuristic value of the whole board
+ * @s: Search context holding the board
+ *
+ * Returns: Sum of every window on the board (seeds AISearch.eval)
+ */
+static long long AI_gridEvaluateFull(const AISearch *s) {
+  long long sum = 0;
+  for (int d = 0; d < 4; ++d)
+    for (int r = 0; r < s->size; ++r)
+      for (int c = 0; c < s->size; ++c)
+        sum += AI_gridWindow(s, r, c, d);
+  return sum;
+}
+
+/**
+ * AI_gridKey - Zobrist key of the whole board
+ * @s: Search context holding the board
+ *
+ * Returns: Hash of the stones and the board shape (seeds
+ *          AISearch.gridKey; AI_gridPlace keeps it up to date)
+ */
+static uint64_t AI_gridKey(const AISearch *s) {
+  uint64_t key = g_gridShapeKey[s->size][s->winLength];
+  for (int cell = 0; cell < s->size * s->size; ++cell)
+    if (s->cells[cell] != ' ')
+      key ^= g_gridZobrist[cell][s->cells[cell] == 'O'];
+  return key;
+}
+
+/*
+ * As on 3x3 (see AI_scoreToTable), win scores are stored relative to
+ * the node; heuristic scores do not depend on depth and are kept as is
+ */
+static inline int AI_gridScoreToTable(int score, int depth) {
+  return score > AI_GRID_WIN / 2    ? score + depth
+         : score < -AI_GRID_WIN / 2 ? score - depth
+                                    : score;
+}
+
+static inline int AI_gridScoreFromTable(int score, int depth) {
+  return score > AI_GRID_WIN / 2    ? score - depth
+         : score < -AI_GRID_WIN / 2 ? score + depth
+                                    : score;
+}
+
+/**
+ * AITable_probeGrid - Look up an N x N position
+ * @t: Table to search
+ * @key: Position hash, side to move included
+ * @plies: Plies the search still has to look below the node
+ * @depth: Depth of the node in the current search
+ * @alpha: Lower bound of the search window
+ * @beta: Upper bound of the search window
+ * @score: Output for the depth-adjusted score on hit
+ * @move: Output for the best move stored with the position (-1 = none)
+ * @hits: Counter bumped when the entry settles the node
+ * @misses: Counter bumped otherwise
+ *
+ * Returns: 1 if the entry settles the node, 0 otherwise
+ * Only an entry searched to exactly @plies settles a node, so a score
+ * is the same whether it was searched or looked up, and searches stay
+ * repeatable whatever the table holds. Entries from other depths (an
+ * earlier turn or iteration) still supply their move, for ordering
+ */
+static int AITable_probeGrid(AITable *t, uint64_t key, int plies, int depth,
+                             int alpha, int beta, int *score, int *move,
+                             int *hits, int *misses) {
+  AITableEntry *e = &t->entries[key & t->mask];
+  uint64_t data = atomic_load_explicit(&e->data, memory_order_relaxed);
+  uint64_t check = atomic_load_explicit(&e->check, memory_order_relaxed);
+  int flag = (int)((data >> 32) & 0xFF);
+  *move = -1;
+  if (flag != AI_TT_EMPTY && (check ^ data) == key) {
+    *move = (int)((data >> 48) & 0xFF) - 1;
+    int v = AI_gridScoreFromTable((int32_t)(uint32_t)data, depth);
+    if ((int)((data >> 40) & 0xFF) == plies &&
+        (flag == AI_TT_EXACT || (flag == AI_TT_LOWER && v >= beta) ||
+         (flag == AI_TT_UPPER && v <= alpha))) {
+      *score = v;
+      (*hits)++;
+      return 1;
+    }
+  }
+  (*misses)++;
+  return 0;
+}
+
+/**
+ * AITable_storeGrid - Record a searched N x N position (always replaces)
+ * @t: Table to write
+ * @key: Position hash, side to move included
+ * @score: Node-relative score
+ * @flag: AI_TT_EXACT, AI_TT_LOWER or AI_TT_UPPER
+ * @plies: Plies searched below the node
+ * @move: Cell of the best move found
+ *
+ * The data word holds the score in bits 0-31, the flag in bits 32-39,
+ * the plies in bits 40-47 and the move plus one in bits 48-55
+ */
+static void AITable_storeGrid(AITable *t, uint64_t key, int score, int flag,
+                              int plies, int move) {
+  AITableEntry *e = &t->entries[key & t->mask];
+  uint64_t data = (uint64_t)(uint32_t)score | (uint64_t)flag << 32 |
+                  (uint64_t)plies << 40 | (uint64_t)(move + 1) << 48;
+  atomic_store_explicit(&e->data, data, memory_order_relaxed);
+  atomic_store_explicit(&e->check, key ^ data, memory_order_relaxed);
+}
+
+/**
+ * AI_gridPlace - Put a stone on (or clear) a cell of the private board
+ * @s: Search context
+ * @cell: Cell index
+ * @symbol: 'X', 'O', or ' ' to take the stone back
+ *
+ * Keeps the stone count, the incremental evaluation and (with a table)
+ * the Zobrist key in step
+ */
+static void AI_gridPlace(AISearch *s, int cell, char symbol) {
+  long long before = AI_gridWindowsThrough(s, cell);
+  if (s->tt) {
+    if (s->cells[cell] != ' ')
+      s->gridKey ^= g_gridZobrist[cell][s->cells[cell] == 'O'];
+    if (symbol != ' ')
+      s->gridKey ^= g_gridZobrist[cell][symbol == 'O'];
+  }
+  s->stones += (symbol != ' ') - (s->cells[cell] != ' ');
+  s->cells[cell] = symbol;
+  AIMask_assign(&s->occupied, cell / s->size, cell % s->size, symbol != ' ');
+  s->eval += AI_gridWindowsThrough(s, cell) - before;
+}
+
+/**
+ * AI_gridEvaluate - Heuristic score of an unfinished N x N position
+ * @s: Search context holding the board
+ *
+ * Returns: O-positive score, clamped so it never reaches a win score
+ */
+static int AI_gridEvaluate(const AISearch *s) {
+  if (s->eval > AI_GRID_WIN / 2)
+    return AI_GRID_WIN / 2;
+  if (s->eval < -AI_GRID_WIN / 2)
+    return -AI_GRID_WIN / 2;
+  return (int)s->eval;
+}
+
+/**
+ * AI_promoteMove - Move one cell to the front of a move list
+ * @moves: Move list, reordered in place
+ * @count: Number of moves
+ * @cell: Cell to promote (ignored if absent, e.g. -1)
+ */
+static void AI_promoteMove(int *moves, int count, int cell) {
+  for (int i = 1; i < count; ++i) {
+    if (moves[i] == cell) {
+      for (int j = i; j > 0; --j)
+        moves[j] = moves[j - 1];
+      moves[0] = cell;
+      return;
+    }
+  }
+}
+
+/**
+ * AI_gridMoves - List the N x N moves worth searching, best first
+ * @s: Search context holding the board
+ * @depth: Node depth, used to look up the killer move
+ * @hashMove: Best move the table holds for this position (-1 = none)
+ * @moves: Output array of at least GAME_MAX_CELLS cell indices
+ *
+ * Returns: Number of moves written
+ *
+ * Only empty cells within AI_GRID_RADIUS of a stone (1 on boards wider
+ * than AI_GRID_WIDE) are considered, or the center on an empty board. They are ordered by the length of the runs
+ * they would extend or block, then by closeness to the center, with the
+ * table's move and then the killer move for this depth promoted to the
+ * front
+ *
+ * The candidate set is the stone mask grown by the radius with word
+ * shifts (columns, then rows), minus the stones; only its set bits are
+ * visited, in cell order
+ */
+static int AI_gridMoves(const AISearch *s, int depth, int hashMove,
+                        int *moves) {
+  const int (*dirs)[2] = AI_GRID_DIRS;
+  int n = s->size, count = 0;
+  int radius = n > AI_GRID_WIDE ? 1 : AI_GRID_RADIUS;
+  int key[GAME_MAX_CELLS];
+
+  if (s->stones == 0) {
+    moves[0] = (n / 2) * n + n / 2;
+    return 1;
+  }
+
+  // Empty cells close to a stone: widen the stones by whole columns, then rows
+  AIMask near = s->occupied;
+  for (int i = 0; i < radius; ++i) {
+    AIMask left = AIMask_shift(&near, -1), right = AIMask_shift(&near, 1);
+    for (int w = 0; w < AI_MASK_WORDS; ++w)
+      near.w[w] |= (left.w[w] | right.w[w]) & s->onBoard.w[w];
+  }
+  for (int i = 0; i < radius; ++i) {
+    AIMask up = AIMask_shift(&near, -AI_MASK_STRIDE);
+    AIMask down = AIMask_shift(&near, AI_MASK_STRIDE);
+    for (int w = 0; w < AI_MASK_WORDS; ++w)
+      near.w[w] |= up.w[w] | down.w[w];
+  }
+
+  for (int w = 0; w < AI_MASK_WORDS; ++w) {
+    uint64_t bits = near.w[w] & s->onBoard.w[w] & ~s->occupied.w[w];
+    for (; bits; bits &= bits - 1) {
+      int bit = w * 64 + __builtin_ctzll(bits);
+      int r0 = bit / AI_MASK_STRIDE, c0 = bit % AI_MASK_STRIDE, weight = 0;
+      int cell = r0 * n + c0;
+      for (int d = 0; d < 4; ++d) {
+        for (int side = 0; side < 2; ++side) {
+          char symbol = side ? 'O' : 'X';
+          int run = 0;
+          for (int sign = -1; sign <= 1; sign += 2) {
+            int r = r0 + sign * dirs[d][0], c = c0 + sign * dirs[d][1];
+            while (r >= 0 && r < n && c >= 0 && c < n &&
+                   s->cells[r * n + c] == symbol) {
+              ++run;
+              r += sign * dirs[d][0];
+              c += sign * dirs[d][1];
+            }
+          }
+          weight += run * run;
         }
       }
+      int dr = r0 - n / 2, dc = c0 - n / 2;
+      int centerDistance = (dr < 0 ? -dr : dr) + (dc < 0 ? -dc : dc);
+
+      // Insertion sort on (weight, -centerDistance), descending
+      int k = weight * 64 - centerDistance, j = count - 1;
+      while (j >= 0 && key[j] < k) {
+        key[j + 1] = key[j];
+        moves[j + 1] = moves[j];
+        --j;
+      }
+      key[j + 1] = k;
+      moves[j + 1] = cell;
+      ++count;
     }
-    return best;
-  } 
-  // Minimizing player (opponent playing as 'X')
-  else {
-    int best = INT_MAX;
-    // Try all possible moves
-    for (int i = 0; i < 3; ++i) {
-      for (int j = 0; j < 3; ++j) {
-        if (g->board[i][j] == ' ') {
-          // Make move and recurse
-          g->makeMove(g, i, j, 'X');
-          int val = AI_minimax(g, depth + 1, 1);
-          // Undo move
-          g->makeMove(g, i, j, ' ');
-          // Update best score (minimize)
-          if (val < best)
-            best = val;
-        }
+  }
+
+  int killer = depth < AI_MAX_PLY ? s->killer[depth] : -1;
+  AI_promoteMove(moves, count, killer);
+  AI_promoteMove(moves, count, hashMove);
+  return count;
+}
+
+/**
+ * AI_minimaxGrid - Depth-limited alpha-beta search of an N x N board
+ * @s: Search context; its private board is modified and restored
+ * @depth: Current search depth (0 right after the root move)
+ * @isMax: 1 if O (maximizing) moves next, 0 if X does
+ * @alpha: Best score the maximizer is already assured of
+ * @beta: Best score the minimizer is already assured of
+ * @last: Cell of the move that led here
+ *
+ * Returns: Fail-soft minimax score (see AI_minimax), with wins scored
+ *          AI_GRID_WIN - depth and unfinished leaves by AI_gridEvaluate;
+ *          meaningless once s->aborted is set by the deadline
+ *
+ * Only the lines through the last move can have just been completed,
+ * so terminal detection is O(K) per node
+ * With a table attached, interior nodes are looked up and stored by
+ * position (see AITable_probeGrid). The table outlives the search, so a
+ * later turn's search, a subtree of this one, starts from the best
+ * moves found here
+ */
+static int AI_minimaxGrid(AISearch *s, int depth, int isMax, int alpha,
+                          int beta, int last) {
+  AI_countNode(s, depth);
+  if (s->deadline > 0 && (s->nodes & AI_CLOCK_MASK) == 0 &&
+      AI_clockMs() >= s->deadline)
+    s->aborted = 1;
+  if (s->aborted)  // Out of time: the caller discards this iteration
+    return 0;
+
+  int n = s->size;
+  if (Game_winsThrough(s->cells, n, n, s->winLength, last / n, last % n))
+    return isMax ? -(AI_GRID_WIN - depth) : AI_GRID_WIN - depth;
+  if (s->stones == n * n)  // Draw
+    return 0;
+  if (depth + 1 >= s->depthLimit) {
+    s->horizon++;
+    return AI_gridEvaluate(s);
+  }
+
+  uint64_t key = 0;
+  int plies = s->depthLimit - 1 - depth, hashMove = -1;
+  if (s->tt) {
+    int cached;
+    key = isMax ? s->gridKey ^ g_sideToMoveKey : s->gridKey;
+    if (AITable_probeGrid(s->tt, key, plies, depth, alpha, beta, &cached,
+                          &hashMove, &s->tableHits, &s->tableMisses))
+      return cached;
+  }
+
+  int alphaOrig = alpha, betaOrig = beta;
+  int moves[GAME_MAX_CELLS];
+  int count = AI_gridMoves(s, depth, hashMove, moves);
+  int best = isMax ? -INT_MAX : INT_MAX, bestCell = moves[0];
+  char symbol = isMax ? 'O' : 'X';
+
+  for (int k = 0; k < count; ++k) {
+    int cell = moves[k];
+    AI_gridPlace(s, cell, symbol);
+    int val = AI_minimaxGrid(s, depth + 1, !isMax, alpha, beta, cell);
+    AI_gridPlace(s, cell, ' ');
+
+    if (isMax ? val > best : val < best) {
+      best = val;
+      bestCell = cell;
+    }
+    if (isMax && best > alpha)
+      alpha = best;
+    if (!isMax && best < beta)
+      beta = best;
+
+    if (alpha >= beta) {
+      s->cutoffs++;
+      if (depth < AI_MAX_PLY)
+        s->killer[depth] = cell;
+      break;
+    }
+  }
+
+  if (s->tt && !s->aborted) {
+    int flag = best <= alphaOrig ? AI_TT_UPPER
+             : best >= betaOrig  ? AI_TT_LOWER
+                                 : AI_TT_EXACT;
+    AITable_storeGrid(s->tt, key, AI_gridScoreToTable(best, depth), flag,
+                      plies, bestCell);
+  }
+  return best;
+}
+
+/**
+ * AI_book - The solved table, if it answers the AI's current search
+ * @ai: Pointer to AI structure
+ *
+ * Returns: ai->book when the AI is the side to move on a 3x3 board,
+ *          NULL otherwise
+ *
+ * The table only stores the mover the stone counts imply, so scoring
+ * the AI's moves on the opponent's turn (the analysis panel does) falls
+ * back to the live search
+ */
+static const SolvedTable *AI_book(const AI *ai) {
+  const Game *g = ai->game;
+  if (ai->book == NULL || !Game_isClassic(g))
+    return NULL;
+  return SolvedTable_covers(ai->book, g->bits.x, g->bits.o, ai->symbol == 'O')
+             ? ai->book
+             : NULL;
+}
+
+/**
+ * AI_searchMove - Score one root candidate for the AI
+ * @ai: Pointer to AI structure (supplies side and solved table)
+ * @s: Search context holding the root position, table and counters
+ * @cell: Empty cell index (row * size + col) to place the AI's symbol on
+ * @alpha: Score already secured by an earlier candidate (-INT_MAX for exact)
+ *
+ * Returns: Minimax score of the position after the move, from the AI's
+ *          point of view; exact when it is above alpha, otherwise only
+ *          an upper bound
+ *
+ * The search always scores from O's side, so for an AI playing X the
+ * window is mirrored going in and the result negated coming out
+ * Reads the solved table instead of searching when it covers the
+ * position (see AI_book; always exact, no nodes counted); boards other
+ * than 3x3 use the
+ * depth-limited N x N search
+ */
+static int AI_searchMove(const AI *ai, AISearch *s, int cell, int alpha) {
+  int asO = (ai->symbol == 'O');
+  if (!s->classic) {
+    int v;
+    AI_gridPlace(s, cell, ai->symbol);
+    if (asO)
+      v = AI_minimaxGrid(s, 0, 0, alpha, INT_MAX, cell);
+    else
+      v = -AI_minimaxGrid(s, 0, 1, -INT_MAX, -alpha, cell);
+    AI_gridPlace(s, cell, ' ');
+    return v;
+  }
+
+  Board b = Board_play(s->root, cell, asO);
+
+  const SolvedTable *book = AI_book(ai);
+  if (book) {
+    int v = SolvedTable_lookup(book, b.x, b.o, !asO, NULL);
+    return asO ? v : -v;
+  }
+  AIKey key;
+  if (s->tt)
+    key = AIKey_fromBoard(b);
+  if (asO)
+    return AI_minimax(s, b, 0, 0, alpha, INT_MAX, &key);
+  return -AI_minimax(s, b, 0, 1, -INT_MAX, -alpha, &key);
+}
+
+/**
+ * AI_rootMoves - List the legal root moves in the AI's search order
+ * @ai: Pointer to AI structure
+ * @moves: Output array of at least GAME_MAX_CELLS cell indices
+ *
+ * Returns: Number of legal moves (on N x N boards, only the cells the
+ *          search considers; see AI_gridMoves)
+ */
+static int AI_rootMoves(AI *ai, int *moves) {
+  AISearch s;
+  AI_beginSearch(&s, ai);
+  if (!s.classic)
+    return AI_gridMoves(&s, 0, -1, moves);
+  return AI_orderMoves(&s, Board_emptyMask(s.root),
+                       ai->symbol == 'O', 0, moves);
+}
+
+/**
+ * AIRootJob structure (internal)
+ * One root search: the candidates to score and where the results go
+ */
+typedef struct {
+  const AI *ai;
+  const int *moves;       // Root cells in search order
+  int window;             // Alpha is the best score so far minus this (AI_EXACT: none)
+  int plyLimit;           // AISearch.plyLimit for every context
+  int depth;              // Plies of the deepest search that finished (N x N)
+  int score[GAME_MAX_CELLS];      // Score per candidate, parallel to moves
+  int alphaUsed[GAME_MAX_CELLS];  // Alpha each candidate was searched with
+  _Atomic int best;       // Best exact score so far (parallel pruned search)
+  AISearch ctx[THREADPOOL_MAX_THREADS];  // One context per worker
+} AIRootJob;
+
+/**
+ * AI_rootTask - Score one root candidate on a pool worker
+ * @arg: AIRootJob being run
+ * @index: Candidate index into job->moves
+ * @worker: Pool worker index, selects the search context
+ *
+ * Earlier candidates may still be running elsewhere, so a windowed
+ * search opens one below the usual alpha: a candidate that ties the
+ * best is then scored exactly and Hard still picks the first best move
+ * in order, whatever order the workers finish in
+ */
+static void AI_rootTask(void *arg, int index, int worker) {
+  AIRootJob *job = arg;
+  int alpha = -INT_MAX;
+  if (job->window != AI_EXACT) {
+    alpha = atomic_load(&job->best);
+    if (alpha != -INT_MAX)
+      alpha -= job->window + 1;
+  }
+
+  TRACE_START(t);
+  TRACE_ONLY(int before = job->ctx[worker].nodes;)
+  int v = AI_searchMove(job->ai, &job->ctx[worker], job->moves[index], alpha);
+  TRACE_END_ARGS(t, "ai", "candidate", "\"cell\":%d,\"score\":%d,\"nodes\":%d",
+                 job->moves[index], v, job->ctx[worker].nodes - before);
+  job->score[index] = v;
+  job->alphaUsed[index] = alpha;
+
+  if (job->window != AI_EXACT && v > alpha) {
+    int best = atomic_load(&job->best);
+    while (v > best && !atomic_compare_exchange_weak(&job->best, &best, v))
+      ;
+  }
+}
+
+/**
+ * AI_outcome - Classify a root score
+ * @ai: Pointer to AI structure (selects the score scale)
+ * @score: Score from the AI's point of view
+ *
+ * Returns: 1 if it proves a win for the AI, -1 a loss, 0 otherwise
+ *          (a draw on 3x3; no forced result within the depth limit
+ *          on N x N boards)
+ */
+static int AI_outcome(const AI *ai, int score) {
+  int proven = Game_isClassic(ai->game) ? 1 : AI_GRID_WIN - AI_MAX_PLY;
+  if (score >= proven)
+    return 1;
+  if (score <= -proven)
+    return -1;
+  return 0;
+}
+
+/**
+ * AI_scoreDepth - Score a list of root candidates to one depth
+ * @ai: Pointer to AI structure
+ * @moves: Candidate cells in search order
+ * @n: Number of candidates
+ * @window: AI_EXACT for exact scores everywhere, otherwise search each
+ *          candidate with alpha = best score so far - window (scores at
+ *          or below job->alphaUsed are then upper bounds): 0 when only
+ *          the best move matters, more to keep near-best scores exact
+ * @depth: Plies to search on N x N boards (ignored on 3x3)
+ * @deadline: AI_clockMs time to abandon the search at (0 = never)
+ * @job: Filled with scores and per-worker counters
+ *
+ * Returns: Number of leaves scored heuristically (0 means the N x N tree
+ *          was searched to the end), or -1 if the deadline passed and
+ *          the scores are unusable
+ *
+ * With a thread pool attached the candidates are split across its
+ * workers, each with its own search context and all sharing the table;
+ * otherwise they are searched in order on the calling thread
+ * Adds the combined counters to ai->lastSearch
+ */
+static int AI_scoreDepth(AI *ai, const int *moves, int n, int window,
+                         int depth, double deadline, AIRootJob *job) {
+  int workers = ThreadPool_size(ai->pool);
+  job->ai = ai;
+  job->moves = moves;
+  job->window = window;
+  job->depth = depth;
+  for (int w = 0; w < workers; ++w) {
+    AI_beginSearch(&job->ctx[w], ai);
+    job->ctx[w].depthLimit = depth;
+    job->ctx[w].deadline = deadline;
+    job->ctx[w].plyLimit = job->plyLimit;
+  }
+
+  if (workers > 1 && !AI_book(ai) && n > 1) {
+    atomic_init(&job->best, -INT_MAX);
+    ThreadPool_run(ai->pool, AI_rootTask, job, n);
+  } else {
+    int best = -INT_MAX;
+    for (int k = 0; k < n; ++k) {
+      int alpha = window != AI_EXACT && best != -INT_MAX ? best - window
+                                                          : -INT_MAX;
+      TRACE_START(t);
+      TRACE_ONLY(int before = job->ctx[0].nodes;)
+      job->score[k] = AI_searchMove(ai, &job->ctx[0], moves[k], alpha);
+      TRACE_END_ARGS(t, "ai", "candidate",
+                     "\"cell\":%d,\"score\":%d,\"nodes\":%d", moves[k],
+                     job->score[k], job->ctx[0].nodes - before);
+      job->alphaUsed[k] = alpha;
+      if (job->score[k] > best)
+        best = job->score[k];
+    }
+  }
+  AI_publishStats(&ai->lastSearch, job->ctx, workers);
+
+  int horizon = 0;
+  for (int w = 0; w < workers; ++w) {
+    if (job->ctx[w].aborted)
+      return -1;
+    horizon += job->ctx[w].horizon;
+  }
+  return horizon;
+}
+
+/**
+ * AI_deepen - Iterative-deepening driver for a timed N x N search
+ * @ai: Pointer to AI structure (timeBudget > 0)
+ * @moves: Candidate cells, left sorted by the returned scores, best first
+ * @n: Number of candidates (n >= 1)
+ * @window: As for AI_scoreDepth
+ * @start: AI_clockMs time the budget started at
+ * @job: Filled with the scores of the deepest finished ply
+ *
+ * The search is deepened a ply at a time. After each finished ply the
+ * candidates are stably re-sorted by score, so the next ply searches the
+ * previous best move first and ties still resolve to the same move.
+ * Deepening stops when the budget runs out, when half of it is gone (the
+ * next ply would not finish), when the tree is exhausted or when a
+ * windowed search has found a forced win
+ */
+static void AI_deepen(AI *ai, int *moves, int n, int window, double start,
+                      AIRootJob *job) {
+  int score[GAME_MAX_CELLS], alphaUsed[GAME_MAX_CELLS], completed = 0;
+  for (int depth = 1; depth <= AI_MAX_PLY; ++depth) {
+    // The 1-ply pass has no deadline, so there is always a move
+    double deadline = depth > 1 ? start + ai->timeBudget : 0;
+    int horizon = AI_scoreDepth(ai, moves, n, window, depth, deadline, job);
+    if (horizon < 0)
+      break;
+    completed = depth;
+
+    // Stable insertion sort, best score first
+    for (int i = 0; i < n; ++i) {
+      int m = moves[i], v = job->score[i], a = job->alphaUsed[i], j = i - 1;
+      for (; j >= 0 && score[j] < v; --j) {
+        moves[j + 1] = moves[j];
+        score[j + 1] = score[j];
+        alphaUsed[j + 1] = alphaUsed[j];
       }
+      moves[j + 1] = m;
+      score[j + 1] = v;
+      alphaUsed[j + 1] = a;
     }
-    return best;
+
+    if (horizon == 0 || (window != AI_EXACT && AI_outcome(ai, score[0]) > 0) ||
+        (AI_clockMs() - start) * 2 > ai->timeBudget)
+      break;
   }
+
+  // Report the deepest finished ply, in the (re-sorted) move order
+  memcpy(job->score, score, sizeof(int) * (size_t)n);
+  memcpy(job->alphaUsed, alphaUsed, sizeof(int) * (size_t)n);
+  job->depth = completed;
+}
+
+/**
+ * AI_scoreRoot - Score a list of root candidates
+ * @ai: Pointer to AI structure
+ * @moves: Candidate cells in search order; under a time budget they are
+ *         left sorted by the scores returned, best first
+ * @n: Number of candidates
+ * @window: As for AI_scoreDepth
+ * @plyLimit: Depth past the root move at which the 3x3 search stops and
+ *            counts the position as a draw (AI_MAX_PLY: never)
+ * @job: Filled with scores, the depth they come from and the counters
+ *
+ * Without a time budget (and always on 3x3) this is a single search to
+ * the depth limit; with one, AI_deepen drives the N x N search
+ * ai->lastSearch covers every ply searched and is added to ai->totals
+ */
+static void AI_scoreRoot(AI *ai, int *moves, int n, int window, int plyLimit,
+                         AIRootJob *job) {
+  TRACE_START(t);
+  double start = AI_clockMs();
+  memset(&ai->lastSearch, 0, sizeof(ai->lastSearch));
+  job->plyLimit = plyLimit;
+  if (ai->timeBudget <= 0 || Game_isClassic(ai->game) || n == 0)
+    AI_scoreDepth(ai, moves, n, window, ai->depthLimit, 0, job);
+  else
+    AI_deepen(ai, moves, n, window, start, job);
+
+  AIStats *last = &ai->lastSearch;
+  last->searches = 1;
+  last->seconds = (AI_clockMs() - start) / 1e3;
+  last->nodesPerSecond = last->seconds > 0 ? last->nodes / last->seconds : 0;
+  AIStats_add(&ai->totals, last);
+  TRACE_END_ARGS(t, "ai", "search",
+                 "\"size\":%d,\"candidates\":%d,\"nodes\":%lld,\"depth\":%d",
+                 ai->game->size, n, last->nodes, job->depth);
 }
 
 /**
@@ -123,110 +1424,180 @@ typedef struct {
 } Candidate;
 
 /**
- * AI_findBestMove_impl - Internal implementation of move finding
- * @self: Pointer to AI structure
- * 
- * Returns: Best move for current position
- * 
- * Process:
- * 1. Reset performance counters
- * 2. Evaluate all empty positions using minimax
- * 3. Apply difficulty-based move selection:
- *    - Hard: Choose optimal move (highest score)
- *    - Medium: Choose randomly among good moves (score >= threshold)
- *    - Easy: Choose randomly among all legal moves
- * 4. Display prediction if verbose mode enabled
+ * AI_rotl - Rotate a 64-bit word left
  */
-static Move AI_findBestMove_impl(AI *self) {
-  /* Reset instrumentation counters for this search */
-  g_nodesSearched = 0;
-  g_maxDepthReached = 0;
+static inline uint64_t AI_rotl(uint64_t v, int k) {
+  return (v << k) | (v >> (64 - k));
+}
 
-  Game *g = self->game;
-  int bestVal = -INT_MAX;
-  Move bestMove = {-1, -1};
-  Candidate cand[9];  // Max 9 possible moves
-  int n = 0;          // Number of legal moves found
-  
-  // Evaluate all empty positions
-  for (int i = 0; i < 3; ++i) {
-    for (int j = 0; j < 3; ++j) {
-      if (g->board[i][j] == ' ') {
-        // Try this move
-        g->makeMove(g, i, j, 'O');
-        int moveVal = AI_minimax(g, 0, 0);
-        g->makeMove(g, i, j, ' ');
-
-        // Store candidate
-        cand[n].r = i;
-        cand[n].c = j;
-        cand[n].score = moveVal;
-        n++;
-        
-        // Display score in verbose mode
-        if (self->verbose >= 2)
-          printf("AI score for move (%d,%d) = %d\n", i, j, moveVal);
-        
-        // Track best move
-        if (moveVal > bestVal) {
-          bestVal = moveVal;
-          bestMove.row = i;
-          bestMove.col = j;
-        }
-      }
-    }
-  }
+/**
+ * AI_random - Draw a uniform integer from the AI's own generator
+ * @ai: AI whose generator advances (xoshiro256**)
+ * @n: Bound, > 0
+ *
+ * Returns: Value in 0..n-1 (multiply-shift; the bias is below 2^-24
+ *          for any board's worth of moves)
+ */
+static int AI_random(AI *ai, int n) {
+  uint64_t *s = ai->random.s;
+  uint64_t result = AI_rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = AI_rotl(s[3], 45);
+  return (int)(((result >> 32) * (uint64_t)n) >> 32);
+}
+
+/**
+ * AI_selectMove - Apply the difficulty policy to scored root candidates
+ * @self: Pointer to AI structure
+ * @cand: Candidates in the AI's move order (n >= 1)
+ * @n: Number of candidates
+ *
+ * Returns: Index of the chosen candidate
+ *
+ * - Hard: First candidate with the highest score (optimal play)
+ * - Medium: Random pick among moves with score >= best - AI_MEDIUM_SLACK
+ *   (best - AI_GRID_MEDIUM_MARGIN on N x N boards)
+ * - Easy: Random pick among all legal moves
+ */
+static int AI_selectMove(AI *self, const Candidate *cand, int n) {
+  int best = 0;
+  for (int k = 1; k < n; ++k)
+    if (cand[k].score > cand[best].score)
+      best = k;
 
-  /* Select move based on difficulty level */
-  if (n == 0)  // No legal moves (shouldn't happen)
-    return bestMove;
-    
   if (self->difficulty == 2) {
-    /* Hard: Use pure best move (already set in bestMove) */
+    /* Hard: Use pure best move */
     /* No randomness - always optimal play */
+    return best;
   } 
   else if (self->difficulty == 1) {
     /* Medium: Choose randomly among moves with score >= bestVal - 2 */
     /* Allows some suboptimal play for competitive but beatable AI */
-    int threshold = bestVal - 2;
-    if (threshold < -10)
-      threshold = -10;
+    int classic = Game_isClassic(self->game);
+    int threshold =
+        cand[best].score - (classic ? AI_MEDIUM_SLACK : AI_GRID_MEDIUM_MARGIN);
+    int floor = classic ? -10 : -AI_GRID_WIN;
+    if (threshold < floor)
+      threshold = floor;
     
     // Build pool of acceptable moves
-    int pool[9], pn = 0;
+    int pool[GAME_MAX_CELLS], pn = 0;
     for (int k = 0; k < n; ++k)
       if (cand[k].score >= threshold)
         pool[pn++] = k;
     
     // Pick randomly from pool
-    if (pn > 0) {
-      int pick = pool[rand() % pn];
-      bestMove.row = cand[pick].r;
-      bestMove.col = cand[pick].c;
-      bestVal = cand[pick].score;
-    }
+    return pn > 0 ? pool[AI_random(self, pn)] : best;
   } 
   else {
     /* Easy: Pick randomly among all legal moves */
     /* No strategy - purely random play */
-    int pool[9], pn = 0;
-    for (int k = 0; k < n; ++k)
-      pool[pn++] = k;
+    return AI_random(self, n);
+  }
+}
+
+/**
+ * AI_findBestMove_impl - Internal implementation of move finding
+ * @self: Pointer to AI structure
+ *
+ * Returns: Best move for current position
+ *
+ * Process:
+ * 1. Reset performance counters
+ * 2. Easy picks a legal move at random and stops: it needs no scores
+ * 3. Evaluate all empty positions using minimax (across the thread
+ *    pool's workers when one is attached)
+ *    - Hard only needs the best move, so each candidate is searched
+ *      with alpha set to the best score so far (pruned fast path)
+ *    - Medium only needs the scores within its slack of the best, so
+ *      alpha trails the best score by that much; on 3x3 it also stops
+ *      AI_MEDIUM_PLIES past its move and counts what is left as a draw
+ *    - With a solved table every score is a direct lookup
+ * 4. Apply difficulty-based move selection (see AI_selectMove)
+ * 5. Display prediction if verbose mode enabled
+ */
+static Move AI_findBestMove_impl(AI *self) {
+  int bestVal;
+  Move bestMove = {-1, -1};
+  Candidate cand[GAME_MAX_CELLS];
+  int moves[GAME_MAX_CELLS];
+  int n = AI_rootMoves(self, moves);  // Number of legal moves found
+  int size = self->game->size;
+  int classic = Game_isClassic(self->game);
+  AIRootJob job;
+
+  if (self->difficulty == 0 && n > 0) {
+    int cell = moves[AI_random(self, n)];
+    memset(&self->lastSearch, 0, sizeof(self->lastSearch));
+    self->lastSearch.searches = 1;
+    AIStats_add(&self->totals, &self->lastSearch);
+    bestMove.row = cell / size;
+    bestMove.col = cell % size;
+    if (self->verbose >= 1)
+      printf("AI plays (%d,%d) at random\n", bestMove.row, bestMove.col);
+    return bestMove;
+  }
+
+  // Solved-table scores are exact lookups, so only live searches narrow
+  int live = !AI_book(self);
+  int window = AI_EXACT, plyLimit = AI_MAX_PLY;
+  if (live && self->difficulty == 2) {
+    window = 0;
+  } else if (live && self->difficulty == 1) {
+    window = (classic ? AI_MEDIUM_SLACK : AI_GRID_MEDIUM_MARGIN) + 1;
+    plyLimit = classic ? AI_MEDIUM_PLIES : AI_MAX_PLY;
+  }
+  int pruned = window != AI_EXACT;
+
+  // Evaluate all empty positions (counters are reset for this search)
+  AI_scoreRoot(self, moves, n, window, plyLimit, &job);
+
+  for (int k = 0; k < n; ++k) {
+    int i = moves[k] / size, j = moves[k] % size;
+    int moveVal = job.score[k];
+
+    // Store candidate
+    cand[k].r = i;
+    cand[k].c = j;
+    cand[k].score = moveVal;
     
-    int pick = pool[rand() % pn];
-    bestMove.row = cand[pick].r;
-    bestMove.col = cand[pick].c;
-    bestVal = cand[pick].score;
+    // Display score in verbose mode (pruned scores at or below alpha are bounds)
+    if (self->verbose >= 2) {
+      if (pruned && moveVal <= job.alphaUsed[k])
+        printf("AI score for move (%d,%d) <= %d\n", i, j, moveVal);
+      else
+        printf("AI score for move (%d,%d) = %d\n", i, j, moveVal);
+    }
   }
 
+  /* Select move based on difficulty level */
+  if (n == 0)  // No legal moves (shouldn't happen)
+    return bestMove;
+  int pick = AI_selectMove(self, cand, n);
+  bestMove.row = cand[pick].r;
+  bestMove.col = cand[pick].c;
+  bestVal = cand[pick].score;
+
   // Display prediction in verbose mode
   if (self->verbose >= 1) {
-    if (bestVal > 0)
-      printf("AI prediction: AI (O) will win (score=%d)\n", bestVal);
-    else if (bestVal < 0)
-      printf("AI prediction: Player (X) will win (score=%d)\n", bestVal);
-    else
+    char opponent = (self->symbol == 'O') ? 'X' : 'O';
+    int outcome = AI_outcome(self, bestVal);
+    if (outcome > 0)
+      printf("AI prediction: AI (%c) will win (score=%d)\n", self->symbol,
+             bestVal);
+    else if (outcome < 0)
+      printf("AI prediction: Player (%c) will win (score=%d)\n", opponent,
+             bestVal);
+    else if (Game_isClassic(self->game))
       printf("AI prediction: Game will be a draw (score=0)\n");
+    else
+      printf("AI prediction: No forced result within %d plies (score=%d)\n",
+             job.depth, bestVal);
   }
 
   return bestMove;
@@ -236,36 +1607,114 @@ static Move AI_findBestMove_impl(AI *self) {
  * AI_init - Initialize AI structure
  * @ai: Pointer to AI structure to initialize
  * @game: Pointer to game state for AI to analyze
- * 
+ *
  * Sets default values:
  * - Difficulty: Hard (2)
  * - Verbosity: Silent (0)
- * Seeds random number generator for difficulty modes using randomness
+ * - Move ordering: center, corners, edges
+ * Seeds the AI's own random generator from the clock and a process-wide
+ * counter, so AIs created in the same instant still differ
  */
 void AI_init(AI *ai, Game *game) {
   ai->game = game;
   ai->verbose = 0;
   ai->findBestMove = AI_findBestMove_impl;
   ai->difficulty = 2; /* Default: hard */
-  /* Seed RNG for difficulty modes that use randomness */
-  srand((unsigned)time(NULL));
+  ai->table = NULL;   /* Memoization is opt-in via AI_setTable */
+  ai->moveOrder = AI_ORDER_STATIC;
+  ai->book = NULL;    /* Solved table is opt-in via AI_setSolvedTable */
+  ai->symbol = 'O';   /* Default: AI answers a human X */
+  ai->pool = NULL;    /* Single-threaded unless AI_setThreadPool is called */
+  ai->depthLimit = AI_DEFAULT_DEPTH_LIMIT;  /* N x N boards only */
+  ai->timeBudget = 0; /* Fixed-depth search unless AI_setTimeBudget is called */
+  AI_resetStats(ai);
+  /* Fresh stream for the difficulty modes that use randomness */
+  static atomic_uint_fast64_t instances = 0;
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  AI_setSeed(ai, ((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec) ^
+                     (atomic_fetch_add(&instances, 1) * 0xD1B54A32D192ED03ull));
 }
 
 /**
  * AI_findBestMove - Public wrapper for move finding
  * @ai: Pointer to AI structure
- * 
+ *
  * Returns: Best move for current position based on difficulty level
  */
 Move AI_findBestMove(AI *ai) { 
   return ai->findBestMove(ai); 
 }
 
+/**
+ * AI_setTable - Attach a transposition table to an AI
+ * @ai: Pointer to AI structure
+ * @table: Table to share across searches (NULL disables memoization)
+ */
+void AI_setTable(AI *ai, AITable *table) { ai->table = table; }
+
+/**
+ * AI_setSolvedTable - Answer from a precomputed solved table
+ * @ai: Pointer to AI structure
+ * @book: Solved table (NULL falls back to live search)
+ */
+void AI_setSolvedTable(AI *ai, const SolvedTable *book) {
+  // Only the classic 3x3 search reads the table
+  ai->book = (book && SolvedTable_matches(book, 3, 3)) ? book : NULL;
+}
+
+/**
+ * AI_setThreadPool - Search root candidates in parallel
+ * @ai: Pointer to AI structure
+ * @pool: Pool whose workers share the root moves (NULL = single-threaded)
+ */
+void AI_setThreadPool(AI *ai, ThreadPool *pool) { ai->pool = pool; }
+
+/**
+ * AI_setSymbol - Choose which side the AI plays
+ * @ai: Pointer to AI structure
+ * @symbol: 'X' or 'O' (anything else means 'O')
+ */
+void AI_setSymbol(AI *ai, char symbol) { ai->symbol = (symbol == 'X') ? 'X' : 'O'; }
+
+/**
+ * AI_setMoveOrder - Choose how the search orders child moves
+ * @ai: Pointer to AI structure
+ * @mode: AI_ORDER_ROW_MAJOR, AI_ORDER_STATIC or AI_ORDER_HISTORY
+ *
+ * Unknown modes fall back to AI_ORDER_STATIC
+ */
+void AI_setMoveOrder(AI *ai, int mode) {
+  if (mode < AI_ORDER_ROW_MAJOR || mode > AI_ORDER_HISTORY)
+    mode = AI_ORDER_STATIC;
+  ai->moveOrder = mode;
+}
+
+/**
+ * AI_setDepthLimit - Set how far the N x N search looks ahead
+ * @ai: Pointer to AI structure
+ * @plies: Plies searched, the AI's own move included (clamped to 1..AI_MAX_PLY)
+ */
+void AI_setDepthLimit(AI *ai, int plies) {
+  if (plies < 1)
+    plies = 1;
+  if (plies > AI_MAX_PLY)
+    plies = AI_MAX_PLY;
+  ai->depthLimit = plies;
+}
+
+/**
+ * AI_setTimeBudget - Bound how long each N x N search may take
+ * @ai: Pointer to AI structure
+ * @ms: Milliseconds per search (0 or less searches to the depth limit)
+ */
+void AI_setTimeBudget(AI *ai, int ms) { ai->timeBudget = ms > 0 ? ms : 0; }
+
 /**
  * AI_setVerbose - Set AI verbosity level
  * @ai: Pointer to AI structure
  * @v: Verbosity level (0=silent, 1=brief, 2=detailed)
- * 
+ *
  * Clamps value to valid range [0, 2]
  */
 void AI_setVerbose(AI *ai, int v) {
@@ -280,7 +1729,7 @@ void AI_setVerbose(AI *ai, int v) {
  * AI_setDifficulty - Set AI difficulty level
  * @ai: Pointer to AI structure
  * @level: Difficulty (0=Easy, 1=Medium, 2=Hard)
- * 
+ *
  * Clamps value to valid range [0, 2]
  */
 void AI_setDifficulty(AI *ai, int level) {
@@ -291,39 +1740,56 @@ void AI_setDifficulty(AI *ai, int level) {
   ai->difficulty = level;
 }
 
+/**
+ * AI_setSeed - Restart the AI's random generator from a seed
+ * @ai: Pointer to AI structure
+ * @seed: Any value
+ */
+void AI_setSeed(AI *ai, uint64_t seed) {
+  for (int i = 0; i < 4; ++i)
+    ai->random.s[i] = AI_splitMix(&seed);
+}
+
+/**
+ * AI_getRandomState - Copy the AI's random generator state
+ * @ai: Pointer to AI structure
+ * @state: Filled with the current state
+ */
+void AI_getRandomState(const AI *ai, AIRandom *state) { *state = ai->random; }
+
+/**
+ * AI_setRandomState - Continue from a saved random generator state
+ * @ai: Pointer to AI structure
+ * @state: State to copy in
+ */
+void AI_setRandomState(AI *ai, const AIRandom *state) { ai->random = *state; }
+
 /**
  * AI_getPrediction - Get AI's evaluation of current position
  * @ai: Pointer to AI structure
- * 
+ *
  * Returns:
  *  -1 - AI will win with optimal play
  *   1 - Player will win with optimal play
  *   0 - Game will be a draw with optimal play
- * 
+ *
  * Note: Computes without displaying verbose output
  */
 int AI_getPrediction(AI *ai) {
-  /* Compute bestVal without printing */
-  Game *g = ai->game;
+  /* Compute bestVal without printing; only the maximum matters, so prune */
   int bestVal = -INT_MAX;
+  int moves[GAME_MAX_CELLS];
+  int n = AI_rootMoves(ai, moves);
+  AIRootJob job;
   
   // Evaluate all possible moves
-  for (int i = 0; i < 3; ++i)
-    for (int j = 0; j < 3; ++j)
-      if (g->board[i][j] == ' ') {
-        g->makeMove(g, i, j, 'O');
-        int mv = AI_minimax(g, 0, 0);
-        g->makeMove(g, i, j, ' ');
-        if (mv > bestVal)
-          bestVal = mv;
-      }
+  AI_scoreRoot(ai, moves, n, 0, AI_MAX_PLY, &job);
+  for (int k = 0; k < n; ++k)
+    if (job.score[k] > bestVal)
+      bestVal = job.score[k];
   
-  // Interpret score
-  if (bestVal > 0)
-    return -1; /* AI will win */
-  if (bestVal < 0)
-    return 1;  /* Player will win */
-  return 0;    /* Draw */
+  // Interpret score: -1 = AI will win, 1 = player will win, 0 = draw
+  return -AI_outcome(ai, bestVal);
 }
 
 /**
@@ -331,65 +1797,234 @@ int AI_getPrediction(AI *ai) {
  * @ai: Pointer to AI structure
  * @out: Output array for candidate moves
  * @maxOut: Maximum number of candidates to return
- * 
+ *
  * Returns: Number of candidates found
- * 
- * Fills output array with all legal moves and their minimax scores
+ *
+ * Fills output array with all legal moves and their exact minimax scores
+ * (searched without pruning, in row-major order)
  * Resets performance counters before analysis
  */
 int AI_explain(AI *ai, AICandidate *out, int maxOut) {
-  /* Reset counters before explain run */
-  g_nodesSearched = 0;
-  g_maxDepthReached = 0;
-  
-  Game *g = ai->game;
-  int n = 0;
-  
-  // Evaluate all empty positions
-  for (int i = 0; i < 3; ++i) {
-    for (int j = 0; j < 3; ++j) {
-      if (g->board[i][j] == ' ') {
-        g->makeMove(g, i, j, 'O');
-        int mv = AI_minimax(g, 0, 0);
-        g->makeMove(g, i, j, ' ');
-        
-        // Store in output array if space available
-        if (n < maxOut) {
-          out[n].row = i;
-          out[n].col = j;
-          out[n].score = mv;
-        }
-        n++;
-      }
+  int size = ai->game->size;
+  int moves[GAME_MAX_CELLS];
+  int n = AI_rootMoves(ai, moves);
+  AIRootJob job;
+
+  // Full window: every candidate needs its exact score (resets counters)
+  AI_scoreRoot(ai, moves, n, AI_EXACT, AI_MAX_PLY, &job);
+
+  // Put the candidates in row-major order
+  for (int i = 1; i < n; ++i) {
+    int m = moves[i], v = job.score[i], j = i - 1;
+    for (; j >= 0 && moves[j] > m; --j) {
+      moves[j + 1] = moves[j];
+      job.score[j + 1] = job.score[j];
     }
+    moves[j + 1] = m;
+    job.score[j + 1] = v;
+  }
+
+  // Store in output array if space available
+  for (int k = 0; k < n && k < maxOut; ++k) {
+    out[k].row = moves[k] / size;
+    out[k].col = moves[k] % size;
+    out[k].score = job.score[k];
   }
   return n;
 }
 
+/**
+ * AI_analyze - Score every candidate and pick a move in one root search
+ * @ai: Pointer to AI structure
+ * @out: Output array for candidate moves (may be NULL if maxOut is 0)
+ * @maxOut: Maximum number of candidates to return
+ * @chosen: Output for the move the AI would play at its difficulty (may be NULL)
+ *
+ * Returns: Number of legal moves found
+ *
+ * Combines AI_explain and AI_findBestMove: every candidate is searched
+ * once with a full window, the exact scores fill the output array (in
+ * row-major order, like AI_explain) and the difficulty policy picks the
+ * move from the same scores. Prints nothing regardless of verbosity
+ */
+int AI_analyze(AI *ai, AICandidate *out, int maxOut, Move *chosen) {
+  int size = ai->game->size;
+  Candidate cand[GAME_MAX_CELLS];
+  int moves[GAME_MAX_CELLS];
+  int n = AI_rootMoves(ai, moves);
+  int order[GAME_MAX_CELLS];
+  AIRootJob job;
+
+  // Search in move order so Hard breaks ties the same way as findBestMove
+  AI_scoreRoot(ai, moves, n, AI_EXACT, AI_MAX_PLY, &job);
+  for (int k = 0; k < n; ++k) {
+    cand[k].r = moves[k] / size;
+    cand[k].c = moves[k] % size;
+    cand[k].score = job.score[k];
+  }
+
+  // Report in row-major order
+  for (int i = 0; i < n; ++i) {
+    int j = i - 1;
+    for (; j >= 0 && moves[order[j]] > moves[i]; --j)
+      order[j + 1] = order[j];
+    order[j + 1] = i;
+  }
+  for (int k = 0; k < n && k < maxOut; ++k) {
+    out[k].row = cand[order[k]].r;
+    out[k].col = cand[order[k]].c;
+    out[k].score = cand[order[k]].score;
+  }
+
+  if (chosen) {
+    chosen->row = chosen->col = -1;
+    if (n > 0) {
+      int pick = AI_selectMove(ai, cand, n);
+      chosen->row = cand[pick].r;
+      chosen->col = cand[pick].c;
+    }
+  }
+  return n;
+}
+
+/**
+ * AIBatch structure (internal)
+ * Shared arguments of one AI_evaluateBatch call
+ */
+typedef struct {
+  const AI *ai;
+  const Game *positions;
+  AIEvaluation *out;
+} AIBatch;
+
+/**
+ * AI_evaluateOne - Score one position for the side to move
+ * @settings: AI whose settings the search copies
+ * @position: Position to evaluate
+ * @pool: Pool for a root-parallel search (NULL inside a pool task)
+ * @out: Filled with the evaluation
+ *
+ * Searches a private copy of the position with a private copy of the AI,
+ * so concurrent calls only share the tables
+ */
+static void AI_evaluateOne(const AI *settings, const Game *position,
+                           ThreadPool *pool, AIEvaluation *out) {
+  Game game = *position;
+  AI ai = *settings;
+  ai.game = &game;
+  ai.pool = pool;
+  ai.verbose = 0;
+  ai.symbol = (game.moveCount & 1) ? 'O' : 'X';
+
+  out->score = 0;
+  out->best.row = out->best.col = -1;
+  out->nodes = 0;
+  int moves[GAME_MAX_CELLS];
+  int n = Game_state(&game) == 2 ? AI_rootMoves(&ai, moves) : 0;
+  if (n == 0)
+    return;
+
+  // Only the best score matters, as for Hard (window 0)
+  AIRootJob job;
+  AI_scoreRoot(&ai, moves, n, 0, AI_MAX_PLY, &job);
+  int best = 0;
+  for (int k = 1; k < n; ++k)
+    if (job.score[k] > job.score[best])
+      best = k;
+  out->score = job.score[best];
+  out->best.row = moves[best] / game.size;
+  out->best.col = moves[best] % game.size;
+  out->nodes = ai.lastSearch.nodes;
+}
+
+/**
+ * AI_evaluateTask - Evaluate one position of a batch (pool task)
+ * @arg: AIBatch being run
+ * @index: Position in the batch
+ * @worker: Pool worker index (unused)
+ */
+static void AI_evaluateTask(void *arg, int index, int worker) {
+  const AIBatch *batch = arg;
+  (void)worker;
+  AI_evaluateOne(batch->ai, &batch->positions[index], NULL,
+                 &batch->out[index]);
+}
+
+/**
+ * AI_evaluateBatch - Score many positions in one call
+ * @ai: AI supplying the search settings (not modified)
+ * @positions: Positions to evaluate
+ * @count: Number of positions
+ * @out: Filled with one evaluation per position
+ *
+ * Parallel across positions when there are several and a pool, so each
+ * worker runs whole serial searches; a lone position uses the pool at
+ * the root like AI_findBestMove
+ */
+void AI_evaluateBatch(const AI *ai, const Game *positions, int count,
+                      AIEvaluation *out) {
+  if (count == 1 || ThreadPool_size(ai->pool) == 1) {
+    for (int i = 0; i < count; ++i)
+      AI_evaluateOne(ai, &positions[i], ai->pool, &out[i]);
+    return;
+  }
+  AIBatch batch = {ai, positions, out};
+  ThreadPool_run(ai->pool, AI_evaluateTask, &batch, count);
+}
+
 /**
  * AI_getStats - Retrieve performance metrics from last search
- * @ai: Pointer to AI structure (unused, counters are global)
+ * @ai: Pointer to AI structure
  * @nodes: Output pointer for nodes explored count
  * @maxDepth: Output pointer for maximum depth reached
- * 
- * Provides statistics about computational effort of last minimax search
+ * @tableHits: Output pointer for transposition table hits
+ * @tableMisses: Output pointer for transposition table misses
+ *
+ * Provides statistics about computational effort of this AI's last
+ * minimax search, summed over all pool workers
  */
-void AI_getStats(AI *ai, int *nodes, int *maxDepth) {
-  (void)ai;  // Unused parameter
+void AI_getStats(AI *ai, int *nodes, int *maxDepth, int *tableHits,
+                 int *tableMisses) {
   if (nodes)
-    *nodes = g_nodesSearched;
+    *nodes = (int)ai->lastSearch.nodes;
   if (maxDepth)
-    *maxDepth = g_maxDepthReached;
+    *maxDepth = ai->lastSearch.maxDepth;
+  if (tableHits)
+    *tableHits = (int)ai->lastSearch.tableHits;
+  if (tableMisses)
+    *tableMisses = (int)ai->lastSearch.tableMisses;
+}
+
+/**
+ * AI_getSearchStats - Retrieve the full search counters
+ * @ai: Pointer to AI structure
+ * @last: Output for the most recent search (may be NULL)
+ * @total: Output for every search since AI_init or AI_resetStats (may be NULL)
+ */
+void AI_getSearchStats(const AI *ai, AIStats *last, AIStats *total) {
+  if (last)
+    *last = ai->lastSearch;
+  if (total)
+    *total = ai->totals;
+}
+
+/**
+ * AI_addSearch - Count a search run by a copy of this AI as its own
+ * @ai: Pointer to AI structure
+ * @search: Counters of that search
+ */
+void AI_addSearch(AI *ai, const AIStats *search) {
+  ai->lastSearch = *search;
+  AIStats_add(&ai->totals, search);
 }
 
 /**
  * AI_resetStats - Reset performance counters
- * @ai: Pointer to AI structure (unused, counters are global)
- * 
- * Clears nodes explored and max depth for fresh analysis
+ * @ai: Pointer to AI structure
+ *
+ * Clears the last-search counters and the running totals
  */
 void AI_resetStats(AI *ai) {
-  (void)ai;  // Unused parameter
-  g_nodesSearched = 0;
-  g_maxDepthReached = 0;
+  memset(&ai->lastSearch, 0, sizeof(ai->lastSearch));
+  memset(&ai->totals, 0, sizeof(ai->totals));
 }
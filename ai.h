@@ -9,10 +9,58 @@
 #define AI_H
 
 #include "game.h"
+#include "solver.h"
+#include "threadpool.h"
+
+#include <stdint.h>
+
+/* Move ordering modes for the alpha-beta search (see AI_setMoveOrder) */
+#define AI_ORDER_ROW_MAJOR 0  // Cells 0..8 in reading order
+#define AI_ORDER_STATIC 1     // Center, then corners, then edges (default)
+#define AI_ORDER_HISTORY 2    // Killer move and history heuristic, static order on ties
+
+/* Plies the N x N search looks ahead by default (3x3 is always solved exactly) */
+#define AI_DEFAULT_DEPTH_LIMIT 4
+
+/* Depth buckets in AIStats.depthNodes (deeper nodes share the last one) */
+#define AI_STATS_DEPTHS 16
 
 /* Forward declaration for self-referential function pointers */
 typedef struct AI AI;
 
+/**
+ * AIStats structure
+ * Search counters of one AI instance, either for its last search or
+ * summed over every search since AI_resetStats (see AI_getSearchStats)
+ */
+typedef struct {
+  int searches;                 // Root searches counted
+  long long nodes;              // Nodes explored
+  int maxDepth;                 // Deepest node reached
+  long long tableHits;          // Transposition table probes that settled a node
+  long long tableMisses;        // Transposition table probes that did not
+  long long cutoffs;            // Beta cutoffs
+  double seconds;               // Wall time spent searching
+  double nodesPerSecond;        // nodes / seconds (0 if too fast to time)
+  long long depthNodes[AI_STATS_DEPTHS];  // Nodes per depth (0 = after the AI's move)
+} AIStats;
+
+/**
+ * AIRandom structure
+ * State of an AI's private random number generator (xoshiro256**),
+ * which drives the Easy and Medium picks; copy it to replay a stream
+ */
+typedef struct {
+  uint64_t s[4];
+} AIRandom;
+
+/**
+ * AITable - Transposition table shared by AI searches (opaque)
+ * Memoizes minimax values keyed on a symmetry-canonical position hash,
+ * so all 8 rotations/reflections of a board share one entry
+ */
+typedef struct AITable AITable;
+
 /**
  * AI structure
  * Encapsulates the AI player's state and strategy
@@ -23,6 +71,16 @@ struct AI {
   Move (*findBestMove)(AI *self);  // Function pointer for move selection strategy
   int difficulty;                  // Difficulty level: 0=Easy (random), 1=Medium (limited), 2=Hard (optimal)
   int verbose;                     // Verbosity level: 0=silent, 1=brief, 2=detailed explanations
+  AITable *table;                  // Optional transposition table (NULL = no memoization)
+  int moveOrder;                   // AI_ORDER_* mode for child move ordering
+  const SolvedTable *book;         // Optional solved table (NULL = search live)
+  char symbol;                     // Side the AI plays: 'O' (default) or 'X'
+  ThreadPool *pool;                // Optional workers for root-parallel search (NULL = serial)
+  int depthLimit;                  // Plies searched on N x N boards (AI's move included)
+  int timeBudget;                  // Milliseconds per search on N x N boards (0 = fixed depth)
+  AIStats lastSearch;              // Counters of the most recent search
+  AIStats totals;                  // Counters summed since AI_init or AI_resetStats
+  AIRandom random;                 // Generator for Easy/Medium picks (see AI_setSeed)
 };
 
 /**
@@ -31,18 +89,82 @@ struct AI {
  * @game: Pointer to game state for AI to analyze
  * 
  * Sets up the AI with default difficulty (Hard) and verbosity (detailed)
+ * No transposition table is attached; see AI_setTable
+ * The random generator gets a seed no other AI in the process has had
+ * (clock and a counter); use AI_setSeed for a repeatable game
  */
 void AI_init(AI *ai, Game *game);
 
+/**
+ * AITable_create - Allocate an empty transposition table
+ * @sizeLog2: Table holds 2^sizeLog2 entries (clamped to 8..24)
+ * 
+ * Returns: New table, or NULL if allocation fails
+ * A table may be shared by any number of AI instances and lives until
+ * AITable_destroy, so entries persist across moves and games
+ */
+AITable *AITable_create(int sizeLog2);
+
+/**
+ * AITable_clear - Drop all entries from a transposition table
+ * @table: Table to clear (NULL is ignored)
+ */
+void AITable_clear(AITable *table);
+
+/**
+ * AITable_destroy - Free a transposition table
+ * @table: Table to free (NULL is ignored)
+ * 
+ * Detach it from every AI using it before calling this
+ */
+void AITable_destroy(AITable *table);
+
+/**
+ * AI_setTable - Attach a transposition table to an AI
+ * @ai: Pointer to AI structure
+ * @table: Table to use for findBestMove, explain and getPrediction (NULL disables)
+ *
+ * Used on every board size; on N x N boards a hit needs the same search
+ * depth, and other entries only order moves (results never change)
+ */
+void AI_setTable(AI *ai, AITable *table);
+
 /**
  * AI_findBestMove - Calculate the best move for current board state
  * @ai: Pointer to AI structure
  * 
  * Returns: Move structure with row/col of recommended move
- * Algorithm varies by difficulty level
+ * Algorithm varies by difficulty level; Hard uses the pruned alpha-beta
+ * search since it only needs the best move, Medium keeps only the
+ * near-best scores exact (and on 3x3 looks 6 plies past its move), and
+ * Easy picks a legal move without searching
  */
 Move AI_findBestMove(AI *ai);
 
+/**
+ * AI_setDepthLimit - Set how far the N x N search looks ahead
+ * @ai: Pointer to AI structure
+ * @plies: Plies searched, the AI's own move included (default AI_DEFAULT_DEPTH_LIMIT)
+ * 
+ * Boards other than 3x3 are too large to solve, so the search stops at
+ * this depth and scores the leaves heuristically. 3x3 games ignore it
+ */
+void AI_setDepthLimit(AI *ai, int plies);
+
+/**
+ * AI_setTimeBudget - Bound how long each N x N search may take
+ * @ai: Pointer to AI structure
+ * @ms: Wall-clock milliseconds per search (0, the default, searches to
+ *      the depth limit however long it takes)
+ * 
+ * With a budget the search deepens one ply at a time, trying the best
+ * move of the previous ply first, and answers from the deepest ply that
+ * finished in time; the depth limit is not used. The 1-ply pass always
+ * runs to completion, so a move is returned even on a tiny budget.
+ * 3x3 games are solved exactly and ignore it
+ */
+void AI_setTimeBudget(AI *ai, int ms);
+
 /**
  * AI_setVerbose - Set AI verbosity level
  * @ai: Pointer to AI structure
@@ -50,6 +172,50 @@ Move AI_findBestMove(AI *ai);
  */
 void AI_setVerbose(AI *ai, int v);
 
+/**
+ * AI_setSolvedTable - Answer from a precomputed solved table
+ * @ai: Pointer to AI structure
+ * @book: Table from SolvedTable_open/generate/load (NULL = search live)
+ * 
+ * With a table, findBestMove, explain and getPrediction read every
+ * candidate score in O(1) instead of calling minimax; without one
+ * they fall back to the alpha-beta search. Tables of other boards
+ * (SolvedTable_solveGrid) are ignored, and so is the table when the AI
+ * is not the side to move (it stores only the mover of each position)
+ */
+void AI_setSolvedTable(AI *ai, const SolvedTable *book);
+
+/**
+ * AI_setThreadPool - Search root candidates in parallel
+ * @ai: Pointer to AI structure
+ * @pool: Pool to spread root moves over (NULL = search on the calling thread)
+ * 
+ * Each worker searches its share of the root moves with a private
+ * context; all of them share the AI's transposition table. Results and
+ * the move chosen are the same as a serial search. An AI driven from
+ * inside a task of the same pool must not have it attached
+ */
+void AI_setThreadPool(AI *ai, ThreadPool *pool);
+
+/**
+ * AI_setSymbol - Choose which side the AI plays
+ * @ai: Pointer to AI structure
+ * @symbol: 'X' or 'O' (default 'O')
+ * 
+ * Candidate scores, predictions and move choices are all from this
+ * side's point of view
+ */
+void AI_setSymbol(AI *ai, char symbol);
+
+/**
+ * AI_setMoveOrder - Choose how the alpha-beta search orders moves
+ * @ai: Pointer to AI structure
+ * @mode: AI_ORDER_ROW_MAJOR, AI_ORDER_STATIC or AI_ORDER_HISTORY
+ * 
+ * Ordering never changes scores, only how many nodes get pruned
+ */
+void AI_setMoveOrder(AI *ai, int mode);
+
 /**
  * AI_setDifficulty - Set AI difficulty level
  * @ai: Pointer to AI structure
@@ -57,6 +223,33 @@ void AI_setVerbose(AI *ai, int v);
  */
 void AI_setDifficulty(AI *ai, int level);
 
+/**
+ * AI_setSeed - Restart the AI's random generator from a seed
+ * @ai: Pointer to AI structure
+ * @seed: Any value; equal seeds give equal Easy/Medium choices
+ * 
+ * Each AI draws from its own generator, so AIs on different threads
+ * never contend and a match is replayed exactly by reusing its seeds
+ */
+void AI_setSeed(AI *ai, uint64_t seed);
+
+/**
+ * AI_getRandomState - Copy the AI's random generator state
+ * @ai: Pointer to AI structure
+ * @state: Filled with the current state
+ */
+void AI_getRandomState(const AI *ai, AIRandom *state);
+
+/**
+ * AI_setRandomState - Continue from a saved random generator state
+ * @ai: Pointer to AI structure
+ * @state: State from AI_getRandomState (of this or another AI)
+ * 
+ * Lets a copy of the AI that searched ahead hand its stream back, so
+ * later picks are the ones the AI would have made on its own
+ */
+void AI_setRandomState(AI *ai, const AIRandom *state);
+
 /**
  * AI_getPrediction - Get AI's evaluation of current position
  * @ai: Pointer to AI structure
@@ -83,25 +276,100 @@ typedef struct {
  * @maxOut: Maximum number of candidates to return
  * 
  * Returns: Number of candidates found (up to maxOut)
- * Fills output array with top candidate moves sorted by score
+ * Fills output array with every legal move and its exact score
+ * (full-window search, no pruning), in row-major order. On N x N boards
+ * only moves near existing stones are candidates and scores are exact
+ * only up to the depth limit
  */
 int AI_explain(AI *ai, AICandidate *out, int maxOut);
 
+/**
+ * AI_analyze - Score every candidate and pick a move in one root search
+ * @ai: Pointer to AI structure
+ * @out: Output array for candidate moves
+ * @maxOut: Maximum number of candidates to return
+ * @chosen: Output for the move AI_findBestMove would make (may be NULL)
+ * 
+ * Returns: Number of legal moves found
+ * Fills the same candidate list as AI_explain and applies the difficulty
+ * policy to those scores, so a turn needs only one search. Silent
+ * On 3x3 Medium's shallower findBestMove search accepts the same moves,
+ * so with equal random states both pick the same one
+ */
+int AI_analyze(AI *ai, AICandidate *out, int maxOut, Move *chosen);
+
+/**
+ * AIEvaluation structure
+ * Result of evaluating one position for the side to move
+ */
+typedef struct {
+  int score;        // Best minimax score, from the side to move's point of view
+  Move best;        // Move reaching it (-1, -1 if the game is already over)
+  long long nodes;  // Nodes searched for this position
+} AIEvaluation;
+
+/**
+ * AI_evaluateBatch - Score many positions in one call
+ * @ai: AI supplying the search settings: tables, thread pool, depth
+ *      limit, time budget and move order (not modified; its game,
+ *      symbol, difficulty and counters are ignored)
+ * @positions: Positions to evaluate (not modified); X moves first, so
+ *             the side to move follows from each position's stone count
+ * @count: Number of positions
+ * @out: Filled with one evaluation per position, in the same order
+ *
+ * Each position gets the Hard search's best score and first best move.
+ * With a thread pool attached, a batch of several positions is split
+ * across its workers one position per task; a single position is
+ * searched root-parallel instead. Every search shares @ai's
+ * transposition and solved tables, and nothing is allocated. A finished
+ * game scores 0 with no move
+ */
+void AI_evaluateBatch(const AI *ai, const Game *positions, int count,
+                      AIEvaluation *out);
+
 /**
  * AI_getStats - Retrieve performance metrics from last search
  * @ai: Pointer to AI structure
  * @nodes: Output pointer for number of nodes explored
  * @maxDepth: Output pointer for maximum search depth reached
+ * @tableHits: Output pointer for transposition table hits
+ * @tableMisses: Output pointer for transposition table misses
+ * 
+ * Provides statistics about this AI's last minimax search (summed over
+ * every pool worker that took part); other AI instances never affect them
+ * Any output pointer may be NULL
+ */
+void AI_getStats(AI *ai, int *nodes, int *maxDepth, int *tableHits,
+                 int *tableMisses);
+
+/**
+ * AI_getSearchStats - Retrieve the full search counters
+ * @ai: Pointer to AI structure
+ * @last: Output for the most recent search (may be NULL)
+ * @total: Output for every search since AI_init or AI_resetStats (may be NULL)
+ * 
+ * Adds wall time, nodes per second, cutoffs and a per-depth node
+ * histogram to what AI_getStats reports. The counters live in the AI,
+ * so each instance may be read from the thread that drives it
+ */
+void AI_getSearchStats(const AI *ai, AIStats *last, AIStats *total);
+
+/**
+ * AI_addSearch - Count a search run by a copy of this AI as its own
+ * @ai: Pointer to AI structure
+ * @search: Counters of that search (the copy's last search)
  * 
- * Provides statistics about the AI's last minimax search
+ * Becomes the last search and is added to the totals, as if the AI had
+ * run it; used when a background copy analysed the position in advance
  */
-void AI_getStats(AI *ai, int *nodes, int *maxDepth);
+void AI_addSearch(AI *ai, const AIStats *search);
 
 /**
  * AI_resetStats - Reset performance counters
  * @ai: Pointer to AI structure
  * 
- * Clears nodes explored and max depth counters for fresh analysis
+ * Clears both the last-search counters and the running totals
  */
 void AI_resetStats(AI *ai);
 
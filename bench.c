@@ -0,0 +1,487 @@
+/*
+ * bench.c
+ *
+ * Micro-benchmark harness for Tic-Tac-Toe (built by make bench)
+ * Times the engine's hot paths and the per-game I/O, one JSON object per
+ * line on stdout so results can be diffed and tracked over time
+ */
+
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, mkdtemp
+
+#include "ai.h"
+#include "game.h"
+#include "history.h"
+#include "utils.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ==================== ALLOCATION COUNTING ==================== */
+
+/*
+ * The harness replaces malloc and friends with counting wrappers around
+ * glibc's own allocator, so every allocation in the process is seen,
+ * including those libc makes for stdio
+ */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static long long g_allocs = 0;      // Allocation calls so far
+static long long g_allocBytes = 0;  // Bytes requested by those calls
+
+/**
+ * Bench_countAlloc - Record one allocation
+ * @bytes: Size requested
+ */
+static void Bench_countAlloc(size_t bytes) {
+  __atomic_fetch_add(&g_allocs, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&g_allocBytes, (long long)bytes, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size) {
+  Bench_countAlloc(size);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  Bench_countAlloc(count * size);
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  Bench_countAlloc(size);
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) { __libc_free(ptr); }
+
+/* ==================== HARNESS ==================== */
+
+/* How long each benchmark's measured batch must run (see --time) */
+static double g_minSeconds = 0.25;
+
+/* Only benchmarks whose name contains this run (NULL = all, see --filter) */
+static const char *g_filter = NULL;
+
+/* Sink for results the compiler must not optimize away */
+static volatile long long g_sink = 0;
+
+/**
+ * BenchFn - One call of a benchmark
+ * @arg: Benchmark-specific state
+ *
+ * Returns: Search nodes visited by the call (0 if it does not search)
+ */
+typedef long long (*BenchFn)(void *arg);
+
+/**
+ * Bench_now - Monotonic time in seconds
+ */
+static double Bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Bench_run - Time a benchmark and print its result line
+ * @name: Benchmark name ("group/variant")
+ * @fn: Function to call
+ * @arg: Passed to @fn
+ * @opsPerCall: Operations one call performs (positions, moves, records)
+ *
+ * Runs batches of 1, 2, 4... calls until one batch takes at least
+ * g_minSeconds, then reports that batch. Per-op figures divide by
+ * calls * @opsPerCall
+ */
+static void Bench_run(const char *name, BenchFn fn, void *arg,
+                      int opsPerCall) {
+  if (g_filter && !strstr(name, g_filter))
+    return;
+
+  long long calls = 1, nodes = 0, allocs = 0, bytes = 0;
+  double seconds = 0;
+  for (;;) {
+    long long allocs0 = g_allocs, bytes0 = g_allocBytes;
+    nodes = 0;
+    double start = Bench_now();
+    for (long long i = 0; i < calls; ++i)
+      nodes += fn(arg);
+    seconds = Bench_now() - start;
+    allocs = g_allocs - allocs0;
+    bytes = g_allocBytes - bytes0;
+    if (seconds >= g_minSeconds || calls >= (1ll << 40))
+      break;
+    calls *= 2;
+  }
+
+  double ops = (double)calls * opsPerCall;
+  printf("{\"bench\":\"%s\",\"ops\":%.0f,\"seconds\":%.6f,"
+         "\"ns_per_op\":%.1f,\"nodes_per_op\":%.1f,\"nodes_per_sec\":%.0f,"
+         "\"allocs_per_op\":%.3f,\"bytes_per_op\":%.1f}\n",
+         name, ops, seconds, seconds * 1e9 / ops, nodes / ops,
+         seconds > 0 ? nodes / seconds : 0.0, allocs / ops, bytes / ops);
+  fflush(stdout);
+}
+
+/* ==================== POSITIONS ==================== */
+
+/* 3x3 positions searched by the minimax and findBestMove benchmarks,
+ * as cells (row * 3 + col) played alternately from X; -1 ends a line */
+static const int BENCH_POSITIONS[][10] = {
+    {-1},                      // Empty board
+    {4, -1},                   // Center opening, O to move
+    {4, 0, -1},                // Corner reply, X to move
+    {0, 4, 8, -1},             // Opposite corners, O to move
+    {4, 0, 8, 2, -1},          // X must block, X to move
+    {0, 4, 1, 2, 6, -1},       // O must block, O to move
+};
+#define BENCH_POSITION_COUNT \
+  ((int)(sizeof(BENCH_POSITIONS) / sizeof(BENCH_POSITIONS[0])))
+
+/* 9x9 five-in-a-row middlegame, X to move */
+static const int BENCH_GRID_POSITION[] = {40, 41, 30, 50, 31, 49, -1};
+
+/**
+ * Bench_setup - Play a move list onto a fresh board
+ * @g: Game to initialize
+ * @size: Board side
+ * @winLength: Stones in a row to win
+ * @cells: Cells (row * size + col) played alternately from X, -1 ends
+ *
+ * Returns: Symbol to move next
+ */
+static char Bench_setup(Game *g, int size, int winLength, const int *cells) {
+  Game_initSized(g, size, winLength);
+  char symbol = 'X';
+  for (int i = 0; cells[i] >= 0; ++i) {
+    g->makeMove(g, cells[i] / size, cells[i] % size, symbol);
+    symbol = symbol == 'X' ? 'O' : 'X';
+  }
+  return symbol;
+}
+
+/* ==================== BENCHMARKS ==================== */
+
+/**
+ * BenchSearch structure
+ * Boards and AIs for one search benchmark, each AI playing the side to
+ * move on its board
+ */
+typedef struct {
+  Game games[BENCH_POSITION_COUNT];
+  AI ais[BENCH_POSITION_COUNT];
+  int count;          // Positions in use
+  int mode;           // BENCH_EXPLAIN, BENCH_PREDICT, BENCH_FIND or BENCH_BATCH
+} BenchSearch;
+
+#define BENCH_EXPLAIN 0  // AI_explain: full-window minimax of every move
+#define BENCH_PREDICT 1  // AI_getPrediction: alpha-beta best score
+#define BENCH_FIND 2     // AI_findBestMove at the AI's difficulty
+#define BENCH_BATCH 3    // AI_evaluateBatch of every board with the first AI
+
+/**
+ * BenchSearch_init - Set up boards and silent AIs without tables
+ * @b: Benchmark state to fill
+ * @mode: What each call runs
+ * @difficulty: AI difficulty level
+ * @first: First of BENCH_POSITIONS to use
+ * @count: Number of positions
+ */
+static void BenchSearch_init(BenchSearch *b, int mode, int difficulty,
+                             int first, int count) {
+  b->count = count;
+  b->mode = mode;
+  for (int i = 0; i < count; ++i) {
+    char toMove = Bench_setup(&b->games[i], 3, 3, BENCH_POSITIONS[first + i]);
+    AI_init(&b->ais[i], &b->games[i]);
+    AI_setVerbose(&b->ais[i], 0);
+    AI_setDifficulty(&b->ais[i], difficulty);
+    AI_setSymbol(&b->ais[i], toMove);
+    AI_setSeed(&b->ais[i], (uint64_t)i);  // Repeatable Easy/Medium picks
+  }
+}
+
+/**
+ * BenchSearch_call - Search every position once
+ * @arg: BenchSearch
+ *
+ * Returns: Nodes visited
+ */
+static long long BenchSearch_call(void *arg) {
+  BenchSearch *b = arg;
+  long long nodes = 0;
+  if (b->mode == BENCH_BATCH) {
+    AIEvaluation out[BENCH_POSITION_COUNT];
+    AI_evaluateBatch(&b->ais[0], b->games, b->count, out);
+    for (int i = 0; i < b->count; ++i)
+      nodes += out[i].nodes;
+    return nodes;
+  }
+  for (int i = 0; i < b->count; ++i) {
+    AI *ai = &b->ais[i];
+    AIStats last;
+    if (b->mode == BENCH_EXPLAIN) {
+      AICandidate out[GAME_MAX_CELLS];
+      g_sink += AI_explain(ai, out, GAME_MAX_CELLS);
+    } else if (b->mode == BENCH_PREDICT) {
+      g_sink += AI_getPrediction(ai);
+    } else {
+      Move m = AI_findBestMove(ai);
+      g_sink += m.row * 3 + m.col;
+    }
+    AI_getSearchStats(ai, &last, NULL);
+    nodes += last.nodes;
+  }
+  return nodes;
+}
+
+/**
+ * Bench_checkWin - Read the result of a finished 3x3 game
+ * @arg: Game
+ */
+static long long Bench_checkWin(void *arg) {
+  Game *g = arg;
+  g_sink += g->checkWin(g);
+  return 0;
+}
+
+/**
+ * BenchReplay structure
+ * Board and a full game to replay on it
+ */
+typedef struct {
+  Game game;
+  int size;
+  int winLength;
+  int cells[GAME_MAX_CELLS];  // Moves alternately from X
+  int count;                  // Moves in cells
+} BenchReplay;
+
+/**
+ * BenchReplay_call - Replay a game, checking for a result after each move
+ * @arg: BenchReplay
+ *
+ * One call is count operations of makeMove + checkWin
+ */
+static long long BenchReplay_call(void *arg) {
+  BenchReplay *r = arg;
+  Game *g = &r->game;
+  Game_initSized(g, r->size, r->winLength);
+  char symbol = 'X';
+  for (int i = 0; i < r->count; ++i) {
+    g->makeMove(g, r->cells[i] / r->size, r->cells[i] % r->size, symbol);
+    g_sink += g->checkWin(g);
+    symbol = symbol == 'X' ? 'O' : 'X';
+  }
+  return 0;
+}
+
+/**
+ * Bench_gridFind - Hard move on the 9x9 middlegame
+ * @arg: AI attached to the position
+ */
+static long long Bench_gridFind(void *arg) {
+  AI *ai = arg;
+  AIStats last;
+  Move m = AI_findBestMove(ai);
+  g_sink += m.row * 9 + m.col;
+  AI_getSearchStats(ai, &last, NULL);
+  return last.nodes;
+}
+
+/**
+ * Bench_saveGameStats - Log one finished match to the history file
+ * @arg: GameStats to log
+ */
+static long long Bench_saveGameStats(void *arg) {
+  saveGameStats(arg);
+  return 0;
+}
+
+/* Distinct players updateLeaderboard cycles through */
+#define BENCH_PLAYERS 1000
+
+/**
+ * Bench_updateLeaderboard - Record one result for the next player
+ * @arg: Counter of calls so far
+ */
+static long long Bench_updateLeaderboard(void *arg) {
+  long long *n = arg;
+  char username[MAX_USERNAME];
+  snprintf(username, sizeof(username), "bench%04lld", *n % BENCH_PLAYERS);
+  updateLeaderboard(username, "XOD"[*n % 3]);
+  ++*n;
+  return 0;
+}
+
+/* ==================== SCRATCH DIRECTORY ==================== */
+
+/**
+ * Bench_enterScratch - Move into a fresh temporary directory
+ * @path: Buffer of at least 64 bytes for the directory name
+ *
+ * Returns: 1 on success, 0 on failure (an error is printed)
+ *
+ * The history and leaderboard benchmarks write their usual files in the
+ * current directory, so they run where they cannot touch real data
+ */
+static int Bench_enterScratch(char *path) {
+  const char *tmp = getenv("TMPDIR");
+  snprintf(path, 64, "%s/tictactoe-bench-XXXXXX",
+           tmp && strlen(tmp) < 32 ? tmp : "/tmp");
+  if (!mkdtemp(path) || chdir(path) != 0) {
+    printf("Error: Could not create scratch directory %s.\n", path);
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Bench_removeScratch - Delete the scratch directory and its files
+ * @path: Directory from Bench_enterScratch (the current directory)
+ * @home: Directory to return to first
+ */
+static void Bench_removeScratch(const char *path, const char *home) {
+  DIR *dir = opendir(".");
+  if (dir) {
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+      if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+        unlink(entry->d_name);
+    closedir(dir);
+  }
+  if (chdir(home) != 0 || rmdir(path) != 0)
+    printf("Warning: Could not remove scratch directory %s.\n", path);
+}
+
+/* ==================== MAIN ==================== */
+
+/**
+ * Bench_usage - Print command-line help
+ * @prog: Program name
+ */
+static void Bench_usage(const char *prog) {
+  printf("Usage: %s [--time SECONDS] [--filter TEXT]\n", prog);
+  printf("  --time SECONDS  Minimum measured time per benchmark (default "
+         "0.25)\n");
+  printf("  --filter TEXT   Only run benchmarks whose name contains TEXT\n");
+}
+
+/**
+ * main - Run every benchmark and print one JSON line per result
+ *
+ * Fields: bench, ops, seconds, ns_per_op, nodes_per_op, nodes_per_sec,
+ * allocs_per_op and bytes_per_op. Searches run single-threaded without
+ * the solved table; only findBestMove/hard/table uses a (warm)
+ * transposition table
+ *
+ * Returns: 0 on success, 1 on a usage or setup error
+ */
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+      g_minSeconds = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      g_filter = argv[++i];
+    } else {
+      Bench_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Win detection
+  static BenchReplay replay3, replay15;
+  static const int drawn[] = {4, 0, 8, 2, 1, 7, 6, 3, 5};
+  replay3.size = 3;
+  replay3.winLength = 3;
+  replay3.count = 9;
+  memcpy(replay3.cells, drawn, sizeof(drawn));
+  // 15x15 five-in-a-row: X builds a diagonal from the center, O answers beside it
+  replay15.size = 15;
+  replay15.winLength = 5;
+  for (int i = 0; i < 5; ++i) {
+    replay15.cells[replay15.count++] = (5 + i) * 15 + 5 + i;
+    if (i < 4)
+      replay15.cells[replay15.count++] = (5 + i) * 15 + 6 + i;
+  }
+  Bench_setup(&replay3.game, 3, 3, drawn);
+  Bench_run("checkWin/3x3", Bench_checkWin, &replay3.game, 1);
+  Bench_run("makeMove+checkWin/3x3", BenchReplay_call, &replay3, replay3.count);
+  Bench_run("makeMove+checkWin/15x15", BenchReplay_call, &replay15,
+            replay15.count);
+
+  // Minimax from the empty board and from the middlegame positions
+  static BenchSearch search;
+  BenchSearch_init(&search, BENCH_EXPLAIN, 2, 0, 1);
+  Bench_run("minimax/explain/empty", BenchSearch_call, &search, 1);
+  BenchSearch_init(&search, BENCH_PREDICT, 2, 0, 1);
+  Bench_run("minimax/predict/empty", BenchSearch_call, &search, 1);
+  BenchSearch_init(&search, BENCH_EXPLAIN, 2, 1, BENCH_POSITION_COUNT - 1);
+  Bench_run("minimax/explain/midgame", BenchSearch_call, &search,
+            search.count);
+  BenchSearch_init(&search, BENCH_PREDICT, 2, 1, BENCH_POSITION_COUNT - 1);
+  Bench_run("minimax/predict/midgame", BenchSearch_call, &search,
+            search.count);
+
+  // Full move choice at each difficulty, over every position
+  static const char *findNames[] = {"findBestMove/easy", "findBestMove/medium",
+                                    "findBestMove/hard"};
+  for (int level = 0; level < 3; ++level) {
+    BenchSearch_init(&search, BENCH_FIND, level, 0, BENCH_POSITION_COUNT);
+    Bench_run(findNames[level], BenchSearch_call, &search, search.count);
+  }
+  AITable *table = AITable_create(16);
+  BenchSearch_init(&search, BENCH_FIND, 2, 0, BENCH_POSITION_COUNT);
+  for (int i = 0; i < search.count; ++i)
+    AI_setTable(&search.ais[i], table);
+  Bench_run("findBestMove/hard/table", BenchSearch_call, &search,
+            search.count);
+  search.mode = BENCH_BATCH;
+  Bench_run("evaluateBatch/table", BenchSearch_call, &search, search.count);
+  AITable_destroy(table);
+
+  static Game grid;
+  static AI gridAI;
+  char toMove = Bench_setup(&grid, 9, 5, BENCH_GRID_POSITION);
+  AI_init(&gridAI, &grid);
+  AI_setVerbose(&gridAI, 0);
+  AI_setSymbol(&gridAI, toMove);
+  Bench_run("findBestMove/hard/9x9", Bench_gridFind, &gridAI, 1);
+
+  // Per-game bookkeeping, in a scratch directory
+  char home[4096], scratch[64];
+  if (!getcwd(home, sizeof(home)) || !Bench_enterScratch(scratch))
+    return 1;
+
+  GameStats stats;
+  memset(&stats, 0, sizeof(stats));
+  strcpy(stats.player1, "bench");
+  strcpy(stats.player2, getAIName(2));
+  stats.totalMoves = 9;
+  stats.player1Moves = 5;
+  stats.player2Moves = 4;
+  stats.aiNodesExplored = 59704;
+  stats.maxDepth = 8;
+  stats.player2AI.searches = 4;
+  stats.player2AI.nodes = 59704;
+  stats.winner = 'D';
+  setGameStatsFormat(HISTORY_FORMAT_TEXT);
+  Bench_run("saveGameStats/text", Bench_saveGameStats, &stats, 1);
+  setGameStatsFormat(HISTORY_FORMAT_BINARY);
+  Bench_run("saveGameStats/binary", Bench_saveGameStats, &stats, 1);
+  closeGameStats();
+
+  long long results = 0;
+  Bench_run("updateLeaderboard", Bench_updateLeaderboard, &results, 1);
+  closeLeaderboard();
+
+  Bench_removeScratch(scratch, home);
+  return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * board.h
+ *
+ * Packed 3x3 position header for Tic-Tac-Toe
+ * A plain value type and inline operations on it, with no function
+ * pointers and no other dependencies, for the search and for embedders
+ */
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdint.h>
+
+/* Packed bitboard layout: one bit per cell, bit index = row * 3 + col */
+#define BOARD_CELLS 9
+#define BOARD_CELL_BIT(row, col) (1u << ((row) * 3 + (col)))
+#define BOARD_FULL_MASK 0x1FFu  // All 9 cells occupied
+
+/* Board_winner results (same encoding as Game checkWin) */
+#define BOARD_X_WINS 1
+#define BOARD_O_WINS -1
+#define BOARD_DRAW 0
+#define BOARD_ONGOING 2
+
+/**
+ * BOARD_WIN_LINES - The 8 winning line masks (3 rows, 3 columns, 2 diagonals)
+ * A side has won when (bits & line) == line for any entry
+ */
+static const uint16_t BOARD_WIN_LINES[8] = {
+    0x007, 0x038, 0x1C0,  // Rows 0, 1, 2
+    0x049, 0x092, 0x124,  // Columns 0, 1, 2
+    0x111, 0x054          // Diagonals: top-left to bottom-right, top-right to bottom-left
+};
+
+/**
+ * Board structure
+ * A 3x3 position as two 9-bit stone masks; 4 bytes, copied by value
+ * Sides are numbered 0 for X and 1 for O, like the AI's tables
+ */
+typedef struct {
+  uint16_t x;  // Bitboard of X stones
+  uint16_t o;  // Bitboard of O stones
+} Board;
+
+/**
+ * Board_fromBits - Build a position from two stone masks
+ * @xBits: Bitboard of X stones
+ * @oBits: Bitboard of O stones
+ */
+static inline Board Board_fromBits(unsigned xBits, unsigned oBits) {
+  return (Board){(uint16_t)(xBits & BOARD_FULL_MASK),
+                 (uint16_t)(oBits & BOARD_FULL_MASK)};
+}
+
+/**
+ * Board_play - Position after a move
+ * @b: Position before the move
+ * @cell: Cell to fill (row * 3 + col), assumed empty
+ * @side: 0 for X, 1 for O
+ *
+ * Returns: The new position; @b itself is unchanged
+ */
+static inline Board Board_play(Board b, int cell, int side) {
+  uint16_t bit = (uint16_t)(1u << cell);
+  if (side)
+    b.o |= bit;
+  else
+    b.x |= bit;
+  return b;
+}
+
+/**
+ * Board_cell - Read one cell
+ * @b: Position
+ * @cell: Cell index (row * 3 + col)
+ *
+ * Returns: 'X', 'O' or ' '
+ */
+static inline char Board_cell(Board b, int cell) {
+  if (b.x & (1u << cell))
+    return 'X';
+  return (b.o & (1u << cell)) ? 'O' : ' ';
+}
+
+/**
+ * Board_emptyMask - Cells with no stone
+ * @b: Position
+ */
+static inline unsigned Board_emptyMask(Board b) {
+  return ~(unsigned)(b.x | b.o) & BOARD_FULL_MASK;
+}
+
+/**
+ * Board_sideToMove - Side whose turn it is, X having moved first
+ * @b: Position
+ *
+ * Returns: 0 for X, 1 for O
+ */
+static inline int Board_sideToMove(Board b) {
+  return __builtin_popcount(b.x) > __builtin_popcount(b.o);
+}
+
+/**
+ * Board_winner - Evaluate a position
+ * @b: Position
+ *
+ * Returns: BOARD_X_WINS, BOARD_O_WINS, BOARD_DRAW (full, no line) or
+ *          BOARD_ONGOING. Lines are checked in BOARD_WIN_LINES order, so
+ *          a board where both sides have one reports the first found
+ */
+static inline int Board_winner(Board b) {
+  for (int i = 0; i < 8; ++i) {
+    unsigned line = BOARD_WIN_LINES[i];
+    if ((b.x & line) == line)
+      return BOARD_X_WINS;
+    if ((b.o & line) == line)
+      return BOARD_O_WINS;
+  }
+  return Board_emptyMask(b) ? BOARD_ONGOING : BOARD_DRAW;
+}
+
+/**
+ * Board_legalMask - Cells the side to move may play
+ * @b: Position
+ *
+ * Returns: The empty cells while the game is on, 0 once it is over
+ */
+static inline unsigned Board_legalMask(Board b) {
+  return Board_winner(b) == BOARD_ONGOING ? Board_emptyMask(b) : 0;
+}
+
+#endif // BOARD_H
@@ -0,0 +1,248 @@
+/*
+ * engine.c
+ *
+ * Engine protocol implementation for Tic-Tac-Toe
+ * A command loop around one Game and one AI, replying in plain lines
+ */
+
+#include "engine.h"
+#include "game.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Engine structure (internal)
+ * Position and settings of one Engine_run call
+ */
+typedef struct {
+  FILE *out;
+  Game game;
+  AI ai;
+  int ready;       // 1 once a position has been set
+  int difficulty;  // Defaults changed by set
+  int depthLimit;
+  int timeBudget;
+} Engine;
+
+/**
+ * Engine_defaultK - Stones in a row to win when position gives no k
+ * @size: Board side
+ *
+ * Returns: 3 below 5x5, 4 below 9x9, 5 (Gomoku) above, as --size does
+ */
+static int Engine_defaultK(int size) {
+  if (size >= 9)
+    return 5;
+  return size >= 5 ? 4 : 3;
+}
+
+/**
+ * Engine_option - Parse one option value
+ * @name: Option name (difficulty, depth, time or seed)
+ * @value: Value text (may be NULL)
+ * @difficulty: Updated for difficulty
+ * @depth: Updated for depth
+ * @time: Updated for time
+ * @seed: Updated for seed (may be NULL where seed is not allowed)
+ *
+ * Returns: 1 if the option was valid, 0 otherwise
+ */
+static int Engine_option(const char *name, const char *value, int *difficulty,
+                         int *depth, int *time, unsigned long long *seed) {
+  if (!value)
+    return 0;
+  char *end;
+  if (seed && strcmp(name, "seed") == 0) {
+    *seed = strtoull(value, &end, 0);
+    return *end == '\0';
+  }
+  long v = strtol(value, &end, 10);
+  if (*end != '\0')
+    return 0;
+  if (strcmp(name, "difficulty") == 0 && v >= 0 && v <= 2)
+    *difficulty = (int)v;
+  else if (strcmp(name, "depth") == 0 && v >= 1)
+    *depth = (int)v;
+  else if (strcmp(name, "time") == 0 && v >= 0)
+    *time = (int)v;
+  else
+    return 0;
+  return 1;
+}
+
+/**
+ * Engine_position - Handle position: set up the board
+ * @e: Engine (its cells and k follow in the strtok state)
+ *
+ * A rejected position leaves no position set, so a following go
+ * reports an error instead of answering for the previous board
+ */
+static void Engine_position(Engine *e) {
+  e->ready = 0;
+  const char *cells = strtok(NULL, " \t");
+  const char *kWord = strtok(NULL, " \t");
+  const char *kValue = strtok(NULL, " \t");
+  int count = cells ? (int)strlen(cells) : 0;
+  int size = 3;
+  while (size < GAME_MAX_SIZE && size * size < count)
+    size++;
+  if (size * size != count) {
+    fprintf(e->out, "error position needs NxN cells (3-%d)\n", GAME_MAX_SIZE);
+    return;
+  }
+  int k = Engine_defaultK(size);
+  if (kWord) {
+    k = (strcmp(kWord, "k") == 0 && kValue) ? atoi(kValue) : 0;
+    if (k < 3 || k > size || k > GAME_MAX_WIN_LENGTH) {
+      fprintf(e->out, "error k must be 3-%d\n",
+              size < GAME_MAX_WIN_LENGTH ? size : GAME_MAX_WIN_LENGTH);
+      return;
+    }
+  }
+
+  int stones[2] = {0, 0};
+  for (int i = 0; i < count; ++i) {
+    if (cells[i] == 'X' || cells[i] == 'x')
+      stones[0]++;
+    else if (cells[i] == 'O' || cells[i] == 'o')
+      stones[1]++;
+    else if (cells[i] != '.') {
+      fprintf(e->out, "error bad cell '%c'\n", cells[i]);
+      return;
+    }
+  }
+  if (stones[0] != stones[1] && stones[0] != stones[1] + 1) {
+    fprintf(e->out, "error X moves first: counts must be equal or X one ahead\n");
+    return;
+  }
+
+  Game_initSized(&e->game, size, k);
+  for (int i = 0; i < count; ++i)
+    if (cells[i] != '.')
+      Game_play(&e->game, i / size, i % size,
+                (cells[i] == 'X' || cells[i] == 'x') ? 'X' : 'O');
+  e->ready = 1;
+  fprintf(e->out, "ok\n");
+}
+
+/**
+ * Engine_go - Handle go: search the position and report the result
+ * @e: Engine (options follow in the strtok state)
+ */
+static void Engine_go(Engine *e) {
+  int difficulty = e->difficulty, depth = e->depthLimit, time = e->timeBudget;
+  const char *name;
+  while ((name = strtok(NULL, " \t")) != NULL) {
+    if (!Engine_option(name, strtok(NULL, " \t"), &difficulty, &depth, &time,
+                       NULL)) {
+      fprintf(e->out, "error bad go option '%s'\n", name);
+      return;
+    }
+  }
+  if (!e->ready) {
+    fprintf(e->out, "error no position\n");
+    return;
+  }
+  if (Game_state(&e->game) != 2) {
+    fprintf(e->out, "error game over\n");
+    return;
+  }
+
+  AI *ai = &e->ai;
+  AI_setDifficulty(ai, difficulty);
+  AI_setDepthLimit(ai, depth);
+  AI_setTimeBudget(ai, time);
+  // X moves first, so O is to move when the counts are odd
+  AI_setSymbol(ai, (e->game.moveCount & 1) ? 'O' : 'X');
+
+  AICandidate candidates[GAME_MAX_CELLS];
+  Move chosen;
+  int n = AI_analyze(ai, candidates, GAME_MAX_CELLS, &chosen);
+  int score = 0;
+  for (int i = 0; i < n; ++i) {
+    fprintf(e->out, "candidate %d %d %d\n", candidates[i].row,
+            candidates[i].col, candidates[i].score);
+    if (candidates[i].row == chosen.row && candidates[i].col == chosen.col)
+      score = candidates[i].score;
+  }
+  AIStats last;
+  AI_getSearchStats(ai, &last, NULL);
+  fprintf(e->out, "bestmove %d %d score %d nodes %lld ms %.1f\n", chosen.row,
+          chosen.col, score, last.nodes, last.seconds * 1000.0);
+}
+
+/**
+ * Engine_set - Handle set: change a default
+ * @e: Engine (name and value follow in the strtok state)
+ */
+static void Engine_set(Engine *e) {
+  const char *name = strtok(NULL, " \t");
+  unsigned long long seed = 0;
+  if (!name || !Engine_option(name, strtok(NULL, " \t"), &e->difficulty,
+                              &e->depthLimit, &e->timeBudget, &seed)) {
+    fprintf(e->out, "error usage: set difficulty|depth|time|seed <value>\n");
+    return;
+  }
+  if (strcmp(name, "seed") == 0)
+    AI_setSeed(&e->ai, seed);
+  fprintf(e->out, "ok\n");
+}
+
+/**
+ * Engine_run - Answer engine commands until quit or end of input
+ * @config: Search defaults and shared resources
+ * @in: Command stream
+ * @out: Reply stream
+ *
+ * Returns: 0 (exit status)
+ */
+int Engine_run(const EngineConfig *config, FILE *in, FILE *out) {
+  Engine e;
+  e.out = out;
+  e.ready = 0;
+  e.difficulty = config->difficulty;
+  e.depthLimit = config->depthLimit;
+  e.timeBudget = config->timeBudget;
+  Game_init(&e.game);
+  AI_init(&e.ai, &e.game);
+  AI_setVerbose(&e.ai, 0);
+  AI_setTable(&e.ai, config->table);
+  AI_setSolvedTable(&e.ai, config->book);
+  AI_setThreadPool(&e.ai, config->pool);
+  if (config->seeded)
+    AI_setSeed(&e.ai, config->seed);
+
+  char line[ENGINE_LINE_MAX];
+  while (fgets(line, sizeof(line), in) != NULL) {
+    size_t len = strlen(line);
+    if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+      int c;
+      while ((c = fgetc(in)) != EOF && c != '\n')
+        ;  // Drop the rest of the line
+      fprintf(out, "error line too long\n");
+      fflush(out);
+      continue;
+    }
+
+    line[strcspn(line, "\r\n")] = '\0';
+    const char *command = strtok(line, " \t");  // Handlers take the rest
+    if (command == NULL)
+      continue;
+    if (strcmp(command, "quit") == 0)
+      break;
+    if (strcmp(command, "position") == 0)
+      Engine_position(&e);
+    else if (strcmp(command, "go") == 0)
+      Engine_go(&e);
+    else if (strcmp(command, "set") == 0)
+      Engine_set(&e);
+    else if (strcmp(command, "isready") == 0)
+      fprintf(out, "readyok\n");
+    else
+      fprintf(out, "error unknown command '%s'\n", command);
+    fflush(out);
+  }
+  fflush(out);
+  return 0;
+}
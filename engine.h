@@ -0,0 +1,65 @@
+/*
+ * engine.h
+ *
+ * Engine protocol header for Tic-Tac-Toe
+ * Line commands on a stream in, best move and candidate scores out, for
+ * tournament harnesses and other programs driving the AI
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdio.h>
+
+#include "ai.h"
+#include "threadpool.h"
+
+#define ENGINE_LINE_MAX 512  // Longest command line (a 15x15 position fits)
+
+/**
+ * EngineConfig structure
+ * Search defaults and the resources every search shares
+ */
+typedef struct {
+  int difficulty;           // Default AI difficulty (0-2)
+  int depthLimit;           // Default search depth on boards larger than 3x3
+  int timeBudget;           // Default milliseconds per move there (0 = depth)
+  AITable *table;           // Transposition table (NULL for none)
+  const SolvedTable *book;  // Solved table (NULL for live search)
+  ThreadPool *pool;         // Workers for root-parallel search (NULL = serial)
+  int seeded;               // 1 to seed the AI's random generator with seed
+  unsigned long long seed;  // Seed when seeded
+} EngineConfig;
+
+/**
+ * Engine_run - Answer engine commands until quit or end of input
+ * @config: Search defaults and shared resources
+ * @in: Command stream
+ * @out: Reply stream (flushed after every reply)
+ *
+ * Returns: 0 (exit status)
+ *
+ * Commands, one per line:
+ *   position <cells> [k K]   Board to search, row-major with 'X', 'O' and
+ *                            '.' for empty; N is the square root of the
+ *                            cell count (3-15) and K defaults as for
+ *                            --size. X moves first, so the side to move
+ *                            follows from the stone counts; a
+ *                            rejected position clears the previous one
+ *   set <name> <value>       Change a default: difficulty, depth, time
+ *                            or seed
+ *   go [difficulty D] [depth D] [time MS]
+ *                            Search the position, options for this
+ *                            search only
+ *   isready                  Replies readyok (all earlier replies are out)
+ *   quit                     End the session
+ *
+ * go replies with one "candidate <row> <col> <score>" line per scored
+ * move (AI_analyze's list, row-major), then
+ * "bestmove <row> <col> score <score> nodes <n> ms <ms>". Scores are from
+ * the side to move's point of view. Other replies are "ok" and
+ * "error <reason>". Nothing is drawn and nothing waits but the search
+ */
+int Engine_run(const EngineConfig *config, FILE *in, FILE *out);
+
+#endif // ENGINE_H
@@ -13,17 +13,22 @@
  * Game_display - Display the current game board
  * @self: Pointer to Game structure
  * 
- * Renders the 3x3 board with separators
+ * Renders the N x N board with separators
  * Shows X, O, or space for each cell
  */
 static void Game_display(Game *self) {
-  printf("-------------\n");
-  for (int i = 0; i < 3; ++i) {
+  char rule[4 * GAME_MAX_SIZE + 2];
+  int n = self->size;
+  memset(rule, '-', (size_t)(4 * n + 1));
+  rule[4 * n + 1] = '\0';
+
+  printf("%s\n", rule);
+  for (int i = 0; i < n; ++i) {
     printf("| ");
-    for (int j = 0; j < 3; ++j) {
+    for (int j = 0; j < n; ++j) {
       printf("%c | ", self->board[i][j]);
     }
-    printf("\n-------------\n");
+    printf("\n%s\n", rule);
   }
 }
 
@@ -32,90 +37,166 @@ static void Game_display(Game *self) {
  * @self: Pointer to Game structure
  * 
  * Returns: 1 if at least one empty cell exists, 0 if board is full
- * Scans entire board for space characters
  */
 static int Game_isMovesLeft(Game *self) {
-  for (int i = 0; i < 3; ++i)
-    for (int j = 0; j < 3; ++j)
-      if (self->board[i][j] == ' ')
-        return 1;
+  return self->moveCount < self->size * self->size;
+}
+
+/**
+ * Game_winsThrough - Check for K in a row through one cell
+ * @cells: Row-major board cells (' ', 'X' or 'O')
+ * @stride: Distance between rows in cells (GAME_MAX_SIZE for Game.board)
+ * @size: Board side
+ * @winLength: Stones in a row needed to win
+ * @row: Row of the stone just placed
+ * @col: Column of the stone just placed
+ * 
+ * Returns: 1 if that stone completes a line of its own symbol
+ * Counts matching stones outwards in both directions along each of the
+ * 4 lines (row, column, both diagonals) through the cell
+ */
+int Game_winsThrough(const char *cells, int stride, int size, int winLength,
+                     int row, int col) {
+  static const int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+  char symbol = cells[row * stride + col];
+  if (symbol == ' ')
+    return 0;
+
+  for (int d = 0; d < 4; ++d) {
+    int run = 1;
+    for (int sign = -1; sign <= 1; sign += 2) {
+      int r = row + sign * dirs[d][0], c = col + sign * dirs[d][1];
+      while (r >= 0 && r < size && c >= 0 && c < size &&
+             cells[r * stride + c] == symbol) {
+        ++run;
+        r += sign * dirs[d][0];
+        c += sign * dirs[d][1];
+      }
+    }
+    if (run >= winLength)
+      return 1;
+  }
   return 0;
 }
 
+/**
+ * Game_rescan - Recompute the cached result from the whole board
+ * @self: Pointer to Game structure
+ * 
+ * Only needed when a stone is removed or overwritten; placing a stone
+ * on an empty cell updates the result incrementally in makeMove
+ */
+static void Game_rescan(Game *self) {
+  if (Game_isClassic(self)) {
+    self->state = Board_winner(self->bits);
+    return;
+  }
+
+  for (int i = 0; i < self->size; ++i) {
+    for (int j = 0; j < self->size; ++j) {
+      if (Game_winsThrough(&self->board[0][0], GAME_MAX_SIZE, self->size,
+                           self->winLength, i, j)) {
+        self->state = self->board[i][j] == 'X' ? 1 : -1;
+        return;
+      }
+    }
+  }
+  self->state = Game_isMovesLeft(self) ? 2 : 0;
+}
+
 /**
  * Game_checkWin - Determine game state and winner
  * @self: Pointer to Game structure
  * 
  * Returns:
- *   1  - X wins (three X's in a row/column/diagonal)
- *  -1  - O wins (three O's in a row/column/diagonal)
+ *   1  - X wins (K X's in a row/column/diagonal)
+ *  -1  - O wins (K O's in a row/column/diagonal)
  *   0  - Draw (board full, no winner)
  *   2  - Game ongoing (moves available, no winner yet)
  * 
- * Checks all possible winning combinations:
- * - All 3 rows
- * - All 3 columns
- * - Both diagonals (top-left to bottom-right, top-right to bottom-left)
+ * The result is kept up to date by makeMove, so this is O(1)
  */
 static int Game_checkWin(Game *self) {
-  char (*board)[3] = self->board;
-  
-  // Check all rows for three-in-a-row
-  for (int i = 0; i < 3; ++i) {
-    if (board[i][0] != ' ' && board[i][0] == board[i][1] &&
-        board[i][1] == board[i][2]) {
-      return (board[i][0] == 'X') ? 1 : -1;
-    }
-  }
-  
-  // Check all columns for three-in-a-column
-  for (int j = 0; j < 3; ++j) {
-    if (board[0][j] != ' ' && board[0][j] == board[1][j] &&
-        board[1][j] == board[2][j]) {
-      return (board[0][j] == 'X') ? 1 : -1;
-    }
-  }
-  
-  // Check diagonal: top-left to bottom-right
-  if (board[0][0] != ' ' && board[0][0] == board[1][1] &&
-      board[1][1] == board[2][2])
-    return (board[0][0] == 'X') ? 1 : -1;
-  
-  // Check diagonal: top-right to bottom-left
-  if (board[0][2] != ' ' && board[0][2] == board[1][1] &&
-      board[1][1] == board[2][0])
-    return (board[0][2] == 'X') ? 1 : -1;
-
-  // No winner found - check if game is draw or ongoing
-  if (!Game_isMovesLeft(self))
-    return 0; // Draw: board full, no winner
-  return 2;   // Ongoing: moves still available
+  return self->state;
 }
 
 /**
- * Game_makeMove - Place a symbol on the board
+ * Game_play - Place a symbol on the board
  * @self: Pointer to Game structure
- * @row: Row index (0-2)
- * @col: Column index (0-2)
- * @symbol: Symbol to place ('X' or 'O')
+ * @row: Row index (0 to size-1)
+ * @col: Column index (0 to size-1)
+ * @symbol: Symbol to place ('X' or 'O'), or ' ' to clear the cell
  * 
+ * Updates the board array, the packed Board (3x3) and the cached
+ * result. On 3x3 the result is read from the Board; on larger boards
+ * placing a stone on an empty cell of an ongoing game only checks the
+ * lines through that cell, and clearing or overwriting a cell rescans
+ * the board
  * Note: Does not validate if cell is empty - caller must validate
  */
-static void Game_makeMove(Game *self, int row, int col, char symbol) {
+void Game_play(Game *self, int row, int col, char symbol) {
+  char previous = self->board[row][col];
   self->board[row][col] = symbol;
+  self->moveCount += (symbol != ' ') - (previous != ' ');
+
+  if (Game_isClassic(self)) {
+    int cell = row * 3 + col;
+    uint16_t keep = (uint16_t)~(1u << cell);
+    self->bits.x &= keep;
+    self->bits.o &= keep;
+    if (symbol != ' ')
+      self->bits = Board_play(self->bits, cell, symbol == 'O');
+    self->state = Board_winner(self->bits);
+    return;
+  }
+
+  if (previous != ' ' || symbol == ' ' || self->state != 2) {
+    Game_rescan(self);
+  } else if (Game_winsThrough(&self->board[0][0], GAME_MAX_SIZE, self->size,
+                              self->winLength, row, col)) {
+    self->state = symbol == 'X' ? 1 : -1;
+  } else if (!Game_isMovesLeft(self)) {
+    self->state = 0;
+  }
 }
 
 /**
  * Game_init - Initialize Game structure
  * @g: Pointer to Game structure to initialize
  * 
- * Clears the board (sets all cells to space) and assigns
+ * Sets up the classic 3x3 board (see Game_initSized)
+ */
+void Game_init(Game *g) { Game_initSized(g, GAME_DEFAULT_SIZE, 3); }
+
+/**
+ * Game_initSized - Initialize a Game with an N x N board won by K in a row
+ * @g: Pointer to Game structure to initialize
+ * @size: Board side (clamped to 3..GAME_MAX_SIZE)
+ * @winLength: Stones in a row to win (clamped to 3..min(size, GAME_MAX_WIN_LENGTH))
+ * 
+ * Clears the board (sets all cells to space), clears the bitboards, and assigns
  * function pointers for all game operations
  */
-void Game_init(Game *g) {
+void Game_initSized(Game *g, int size, int winLength) {
+  if (size < 3)
+    size = 3;
+  if (size > GAME_MAX_SIZE)
+    size = GAME_MAX_SIZE;
+  if (winLength > size)
+    winLength = size;
+  if (winLength > GAME_MAX_WIN_LENGTH)
+    winLength = GAME_MAX_WIN_LENGTH;
+  if (winLength < 3)
+    winLength = 3;
+
   memset(g->board, ' ', sizeof(g->board));  // Clear board with spaces
+  g->size = size;
+  g->winLength = winLength;
+  g->moveCount = 0;
+  g->state = 2;                             // Ongoing
+  g->bits = Board_fromBits(0, 0);           // Clear packed bitboards
   g->display = Game_display;                // Assign display function
-  g->makeMove = Game_makeMove;              // Assign move function
+  g->makeMove = Game_play;                  // Assign move function
   g->checkWin = Game_checkWin;              // Assign win check function
   g->isMovesLeft = Game_isMovesLeft;        // Assign moves left check function
 }
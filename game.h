@@ -10,15 +10,23 @@
 
 /* Pure C header — no C++ guards */
 
+#include "board.h"
+
 /**
  * Move structure
  * Represents a single move on the board with row and column coordinates
  */
 typedef struct {
-  int row;  // Row index (0-2): 0=top, 1=middle, 2=bottom
-  int col;  // Column index (0-2): 0=left, 1=center, 2=right
+  int row;  // Row index (0 to size-1): 0=top
+  int col;  // Column index (0 to size-1): 0=left
 } Move;
 
+/* Board dimensions: an N x N board won by K in a row */
+#define GAME_DEFAULT_SIZE 3       // Classic Tic-Tac-Toe
+#define GAME_MAX_SIZE 15          // Largest supported side (gomoku board)
+#define GAME_MAX_CELLS (GAME_MAX_SIZE * GAME_MAX_SIZE)
+#define GAME_MAX_WIN_LENGTH 8     // Longest supported K
+
 /* Forward declaration for self-referential function pointers */
 typedef struct Game Game;
 
@@ -26,9 +34,19 @@ typedef struct Game Game;
  * Game structure
  * Encapsulates the Tic-Tac-Toe game state and operations
  * Uses function pointers to simulate object-oriented method calls
+ * Only the top-left size x size corner of the board array is used. On
+ * the classic 3x3 board the packed Board describes the same position;
+ * always go through makeMove (or Game_play) so board, bits and cached
+ * result stay in sync. Code that only needs the 3x3 position should
+ * copy bits and use the Board functions (board.h)
  */
 struct Game {
-  char board[3][3];  // 3x3 game board: ' '=empty, 'X'=player X, 'O'=player O
+  char board[GAME_MAX_SIZE][GAME_MAX_SIZE];  // ' '=empty, 'X'=player X, 'O'=player O
+  int size;              // Board side N
+  int winLength;         // Stones in a row needed to win (K)
+  int moveCount;         // Stones on the board
+  int state;             // Cached checkWin result, updated by makeMove
+  Board bits;            // Packed position (3x3 only, kept in sync by makeMove)
   
   /* Method pointers for OOP-like style */
   void (*display)(Game *self);                                    // Display the board
@@ -42,7 +60,61 @@ struct Game {
  * @g: Pointer to Game structure to initialize
  * 
  * Clears the board and assigns function pointers for all game operations
+ * Sets up a classic 3x3 board won by 3 in a row
  */
 void Game_init(Game *g);
 
+/**
+ * Game_initSized - Initialize a Game with an N x N board won by K in a row
+ * @g: Pointer to Game structure to initialize
+ * @size: Board side (clamped to 3..GAME_MAX_SIZE)
+ * @winLength: Stones in a row to win (clamped to 3..min(size, GAME_MAX_WIN_LENGTH))
+ */
+void Game_initSized(Game *g, int size, int winLength);
+
+/**
+ * Game_play - Place a symbol on the board (what makeMove points to)
+ * @g: Pointer to Game structure
+ * @row: Row index (0 to size-1)
+ * @col: Column index (0 to size-1)
+ * @symbol: Symbol to place ('X' or 'O'), or ' ' to clear the cell
+ * 
+ * A direct call for loops that play many moves; caller validates the cell
+ */
+void Game_play(Game *g, int row, int col, char symbol);
+
+/**
+ * Game_state - Current result (what checkWin returns)
+ * @g: Pointer to Game structure
+ * 
+ * Returns: 1=X wins, -1=O wins, 0=draw, 2=ongoing. O(1), kept by makeMove
+ */
+static inline int Game_state(const Game *g) { return g->state; }
+
+/**
+ * Game_isClassic - Check for the 3x3, 3-in-a-row board
+ * @g: Pointer to Game structure
+ * 
+ * Returns: 1 if the bitboards, solved table and exact search apply
+ */
+static inline int Game_isClassic(const Game *g) {
+  return g->size == 3 && g->winLength == 3;
+}
+
+/**
+ * Game_winsThrough - Check for K in a row through one cell
+ * @cells: Row-major board cells (' ', 'X' or 'O')
+ * @stride: Distance between rows in cells (GAME_MAX_SIZE for Game.board)
+ * @size: Board side
+ * @winLength: Stones in a row needed to win
+ * @row: Row of the stone just placed
+ * @col: Column of the stone just placed
+ * 
+ * Returns: 1 if that stone completes a line of its own symbol
+ * Only the 4 lines through the cell are scanned, so a move is checked in
+ * O(K) instead of rescanning the whole board
+ */
+int Game_winsThrough(const char *cells, int stride, int size, int winLength,
+                     int row, int col);
+
 #endif // GAME_H
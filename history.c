@@ -0,0 +1,1269 @@
+/*
+ * history.c
+ *
+ * Game-history sink implementation for Tic-Tac-Toe
+ * Session-long file handle, in-memory batch buffer and a timer thread
+ * that bounds how long a logged game can sit unwritten
+ */
+
+#define _POSIX_C_SOURCE 200809L  // localtime_r, clock_gettime
+
+#include "history.h"
+#include "trace.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define HISTORY_MAGIC "TTTHIST1"         // Binary file signature (8 bytes, includes version)
+#define HISTORY_REPLAY_MAGIC "TTTRPLY1"  // Replay file signature (8 bytes, includes version)
+#define HISTORY_BUFFER_SIZE (64 * 1024)  // Bytes buffered before a forced write
+
+/* Encoded sizes of the binary record fields (see GameHistory_encode) */
+#define HISTORY_AI_BYTES (4 + 8 + 4 + 8 + 8 + 8 + 8 + 8 * AI_STATS_DEPTHS)
+#define HISTORY_RECORD_BYTES \
+  (8 + 2 * MAX_USERNAME + 5 * 4 + 1 + 2 * HISTORY_AI_BYTES)
+#define HISTORY_LINKED_BYTES (HISTORY_RECORD_BYTES + 2 * 8)  // With player links
+#define HISTORY_RECORD_MAX (1 << 16)     // Larger length prefixes mean corruption
+#define HISTORY_REPLAY_HEADER_BYTES (8 + 2 + 3 + 2 + 8 + 1 + 1)  // Without the names
+#define HISTORY_REPLAY_MAX \
+  (HISTORY_REPLAY_HEADER_BYTES + 2 * MAX_USERNAME + 6 * GAME_MAX_CELLS)
+
+struct GameHistory {
+  FILE *file;              // History file, unbuffered (we buffer ourselves)
+  int format;              // HISTORY_FORMAT_*
+  int batchSize;           // Games per write
+  int flushMs;             // Timer interval (0 = no timer thread)
+  unsigned char *buf;      // Records not written yet
+  size_t len;              // Bytes used in buf
+  int pending;             // Games in buf
+  HistoryIndex *index;     // Player index kept current (binary format only)
+  int64_t fileBytes;       // Size of the file without buf (binary format only)
+
+  pthread_mutex_t lock;    // Guards everything above once the timer runs
+  pthread_cond_t wake;     // Signalled on the first pending game and on stop
+  pthread_t flusher;       // Timer thread
+  int hasFlusher;          // 1 if the timer thread was started
+  int stop;                // Set by GameHistory_close
+};
+
+/* ==================== RECORD ENCODING ==================== */
+
+static unsigned char *put32(unsigned char *p, uint32_t v) {
+  for (int i = 0; i < 4; ++i)
+    p[i] = (unsigned char)(v >> (8 * i));
+  return p + 4;
+}
+
+static unsigned char *put64(unsigned char *p, uint64_t v) {
+  for (int i = 0; i < 8; ++i)
+    p[i] = (unsigned char)(v >> (8 * i));
+  return p + 8;
+}
+
+static const unsigned char *get32(const unsigned char *p, uint32_t *v) {
+  *v = 0;
+  for (int i = 0; i < 4; ++i)
+    *v |= (uint32_t)p[i] << (8 * i);
+  return p + 4;
+}
+
+static const unsigned char *get64(const unsigned char *p, uint64_t *v) {
+  *v = 0;
+  for (int i = 0; i < 8; ++i)
+    *v |= (uint64_t)p[i] << (8 * i);
+  return p + 8;
+}
+
+/**
+ * GameHistory_encodeAI - Write one side's search totals
+ * @p: Output position
+ * @s: Totals to write
+ *
+ * Returns: Position after the HISTORY_AI_BYTES written
+ */
+static unsigned char *GameHistory_encodeAI(unsigned char *p, const AIStats *s) {
+  uint64_t seconds;
+  memcpy(&seconds, &s->seconds, sizeof(seconds));
+  p = put32(p, (uint32_t)s->searches);
+  p = put64(p, (uint64_t)s->nodes);
+  p = put32(p, (uint32_t)s->maxDepth);
+  p = put64(p, (uint64_t)s->tableHits);
+  p = put64(p, (uint64_t)s->tableMisses);
+  p = put64(p, (uint64_t)s->cutoffs);
+  p = put64(p, seconds);
+  for (int d = 0; d < AI_STATS_DEPTHS; ++d)
+    p = put64(p, (uint64_t)s->depthNodes[d]);
+  return p;
+}
+
+/**
+ * GameHistory_decodeAI - Read one side's search totals
+ * @p: Input position
+ * @s: Filled with the totals (nodesPerSecond is recomputed)
+ *
+ * Returns: Position after the HISTORY_AI_BYTES read
+ */
+static const unsigned char *GameHistory_decodeAI(const unsigned char *p,
+                                                 AIStats *s) {
+  uint32_t v32;
+  uint64_t v64;
+  p = get32(p, &v32);
+  s->searches = (int)v32;
+  p = get64(p, &v64);
+  s->nodes = (long long)v64;
+  p = get32(p, &v32);
+  s->maxDepth = (int)v32;
+  p = get64(p, &v64);
+  s->tableHits = (long long)v64;
+  p = get64(p, &v64);
+  s->tableMisses = (long long)v64;
+  p = get64(p, &v64);
+  s->cutoffs = (long long)v64;
+  p = get64(p, &v64);
+  memcpy(&s->seconds, &v64, sizeof(s->seconds));
+  for (int d = 0; d < AI_STATS_DEPTHS; ++d) {
+    p = get64(p, &v64);
+    s->depthNodes[d] = (long long)v64;
+  }
+  s->nodesPerSecond = s->seconds > 0 ? s->nodes / s->seconds : 0;
+  return p;
+}
+
+/**
+ * GameHistory_encode - Frame a game as a binary history record
+ * @out: Output, at least 4 + HISTORY_LINKED_BYTES bytes
+ * @stats: Game to encode
+ * @when: Time the game was logged
+ * @links: Offsets of each player's previous record (-1 for none), or
+ *         NULL to leave the links out
+ *
+ * Returns: Bytes written
+ *
+ * Frame: u32 payload length, then the payload: i64 timestamp, both
+ * names (MAX_USERNAME bytes, zero-padded), i32 totalMoves, player1Moves,
+ * player2Moves, aiNodesExplored, maxDepth, u8 winner, then each side's
+ * AIStats, then optionally i64 offsets of player1's and player2's
+ * previous records (see HistoryIndex). All integers little-endian.
+ * Readers skip payload bytes past the fields they know, so fields can be
+ * appended later
+ */
+static size_t GameHistory_encode(unsigned char *out, const GameStats *stats,
+                                 time_t when, const int64_t *links) {
+  unsigned char *p =
+      put32(out, links ? HISTORY_LINKED_BYTES : HISTORY_RECORD_BYTES);
+  p = put64(p, (uint64_t)(int64_t)when);
+  memset(p, 0, 2 * MAX_USERNAME);
+  memcpy(p, stats->player1, strnlen(stats->player1, MAX_USERNAME - 1));
+  memcpy(p + MAX_USERNAME, stats->player2,
+         strnlen(stats->player2, MAX_USERNAME - 1));
+  p += 2 * MAX_USERNAME;
+  p = put32(p, (uint32_t)stats->totalMoves);
+  p = put32(p, (uint32_t)stats->player1Moves);
+  p = put32(p, (uint32_t)stats->player2Moves);
+  p = put32(p, (uint32_t)stats->aiNodesExplored);
+  p = put32(p, (uint32_t)stats->maxDepth);
+  *p++ = (unsigned char)stats->winner;
+  p = GameHistory_encodeAI(p, &stats->player1AI);
+  p = GameHistory_encodeAI(p, &stats->player2AI);
+  if (links) {
+    p = put64(p, (uint64_t)links[0]);
+    p = put64(p, (uint64_t)links[1]);
+  }
+  return (size_t)(p - out);
+}
+
+/**
+ * GameHistory_decode - Read the payload of a binary history record
+ * @p: Payload (at least HISTORY_RECORD_BYTES bytes)
+ * @length: Payload length
+ * @stats: Filled with the game
+ * @when: Filled with its timestamp
+ * @links: Filled with the previous-record offsets, if present (may be NULL)
+ *
+ * Returns: 1 if the record carries player links, 0 if not
+ */
+static int GameHistory_decode(const unsigned char *p, uint32_t length,
+                              GameStats *stats, time_t *when,
+                              int64_t links[2]) {
+  uint32_t v32;
+  uint64_t v64;
+  p = get64(p, &v64);
+  *when = (time_t)(int64_t)v64;
+  memcpy(stats->player1, p, MAX_USERNAME);
+  memcpy(stats->player2, p + MAX_USERNAME, MAX_USERNAME);
+  stats->player1[MAX_USERNAME - 1] = stats->player2[MAX_USERNAME - 1] = '\0';
+  p += 2 * MAX_USERNAME;
+  p = get32(p, &v32);
+  stats->totalMoves = (int)v32;
+  p = get32(p, &v32);
+  stats->player1Moves = (int)v32;
+  p = get32(p, &v32);
+  stats->player2Moves = (int)v32;
+  p = get32(p, &v32);
+  stats->aiNodesExplored = (int)v32;
+  p = get32(p, &v32);
+  stats->maxDepth = (int)v32;
+  stats->winner = (char)*p++;
+  p = GameHistory_decodeAI(p, &stats->player1AI);
+  p = GameHistory_decodeAI(p, &stats->player2AI);
+  if (length < HISTORY_LINKED_BYTES)
+    return 0;
+  if (links) {
+    p = get64(p, &v64);
+    links[0] = (int64_t)v64;
+    get64(p, &v64);
+    links[1] = (int64_t)v64;
+  }
+  return 1;
+}
+
+/**
+ * appendf - printf to the end of a partly filled buffer
+ * @buf: Buffer
+ * @size: Buffer size
+ * @len: Bytes already used (clamped so the result always fits)
+ *
+ * Returns: New length
+ */
+static int appendf(char *buf, size_t size, int len, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf + len, size - (size_t)len, fmt, ap);
+  va_end(ap);
+  if (n < 0)
+    return len;
+  return len + n < (int)size ? len + n : (int)size - 1;
+}
+
+/**
+ * GameHistory_formatAI - Append one AI's search totals to a history line
+ * @buf: Line buffer
+ * @size: Buffer size
+ * @len: Bytes already used
+ * @name: Player the AI played as
+ * @ai: Search totals (nothing is written if no search was counted)
+ *
+ * Returns: New length
+ *
+ * Format: " | Name AI: S searches, N nodes, T ms, R nodes/s, C cutoffs,
+ * H table hits, depth nodes a/b/c..." with the histogram cut after its
+ * deepest non-empty bucket
+ */
+static int GameHistory_formatAI(char *buf, size_t size, int len,
+                                const char *name, const AIStats *ai) {
+  if (ai->searches == 0)
+    return len;
+  len = appendf(buf, size, len,
+                " | %s AI: %d searches, %lld nodes, %.1f ms, %.0f nodes/s, "
+                "%lld cutoffs, %lld table hits, depth nodes ",
+                name, ai->searches, ai->nodes, ai->seconds * 1e3,
+                ai->nodesPerSecond, ai->cutoffs, ai->tableHits);
+  int last = AI_STATS_DEPTHS - 1;
+  while (last > 0 && ai->depthNodes[last] == 0)
+    --last;
+  for (int d = 0; d <= last; ++d)
+    len = appendf(buf, size, len, d ? "/%lld" : "%lld", ai->depthNodes[d]);
+  return len;
+}
+
+/**
+ * GameHistory_formatLine - Render a game as a text history line
+ * @buf: Output buffer
+ * @size: Buffer size (at least 2)
+ * @stats: Game to render
+ * @when: Time the game was logged
+ *
+ * Returns: Length of the line, newline included
+ *
+ * Format:
+ * "Timestamp | Match: P1 vs P2 | Moves: N (P1: X, P2: Y) | AI Nodes: N | Depth: D
+ *  [| P1 AI: ...] [| P2 AI: ...] | Winner: W"
+ */
+int GameHistory_formatLine(char *buf, size_t size, const GameStats *stats,
+                           time_t when) {
+  struct tm tm;
+  char timeStr[32];
+  localtime_r(&when, &tm);
+  strftime(timeStr, sizeof(timeStr), "%a %b %e %H:%M:%S %Y", &tm);  // ctime() layout
+
+  int len = appendf(buf, size - 1, 0,
+                    "%s | Match: %s vs %s | Moves: %d (%s: %d, %s: %d) | "
+                    "AI Nodes: %d | Depth: %d",
+                    timeStr, stats->player1, stats->player2, stats->totalMoves,
+                    stats->player1, stats->player1Moves, stats->player2,
+                    stats->player2Moves, stats->aiNodesExplored,
+                    stats->maxDepth);
+  len = GameHistory_formatAI(buf, size - 1, len, stats->player1,
+                             &stats->player1AI);
+  len = GameHistory_formatAI(buf, size - 1, len, stats->player2,
+                             &stats->player2AI);
+  len = appendf(buf, size - 1, len, " | Winner: %c", stats->winner);
+  buf[len++] = '\n';  // Room was kept back by passing size - 1 above
+  buf[len] = '\0';
+  return len;
+}
+
+/* ==================== READER ==================== */
+
+/**
+ * GameHistory_openReader - Open a binary history file for reading
+ * @path: History file
+ *
+ * Returns: File positioned after the signature, or NULL if it is missing
+ *          or not a history file
+ */
+static FILE *GameHistory_openReader(const char *path) {
+  FILE *file = fopen(path, "rb");
+  char magic[8];
+  if (file != NULL &&
+      (fread(magic, 1, 8, file) != 8 || memcmp(magic, HISTORY_MAGIC, 8) != 0)) {
+    fclose(file);
+    file = NULL;
+  }
+  return file;
+}
+
+/**
+ * GameHistory_readRecord - Read the record at the current file position
+ * @file: History file
+ * @payload: Scratch buffer of HISTORY_RECORD_MAX bytes
+ * @stats: Filled with the game
+ * @when: Filled with its timestamp
+ * @links: Filled with the player links, if present (may be NULL)
+ * @linked: Set to 1 if the record carries player links (may be NULL)
+ *
+ * Returns: Bytes the record takes in the file, or 0 at the end of the
+ *          file or at a corrupt or cut-short record
+ */
+static int64_t GameHistory_readRecord(FILE *file, unsigned char *payload,
+                                      GameStats *stats, time_t *when,
+                                      int64_t links[2], int *linked) {
+  unsigned char prefix[4];
+  uint32_t length;
+  if (fread(prefix, 1, 4, file) != 4)
+    return 0;
+  get32(prefix, &length);
+  if (length < HISTORY_RECORD_BYTES || length > HISTORY_RECORD_MAX ||
+      fread(payload, 1, length, file) != length)
+    return 0;  // Corrupt or cut short by an interrupted write
+
+  int hasLinks = GameHistory_decode(payload, length, stats, when, links);
+  if (linked)
+    *linked = hasLinks;
+  return 4 + (int64_t)length;
+}
+
+/**
+ * GameHistory_forEach - Read every game in a binary history file
+ * @path: File written with HISTORY_FORMAT_BINARY
+ * @fn: Called with each game and its timestamp, in file order
+ * @arg: Passed to fn
+ *
+ * Returns: Number of games read, or -1 if the file is missing or not a
+ *          history file
+ */
+int GameHistory_forEach(const char *path, GameHistoryFn fn, void *arg) {
+  FILE *file = GameHistory_openReader(path);
+  if (file == NULL)
+    return -1;
+
+  unsigned char *payload = malloc(HISTORY_RECORD_MAX);
+  GameStats stats;
+  time_t when;
+  int count = 0;
+  while (payload != NULL &&
+         GameHistory_readRecord(file, payload, &stats, &when, NULL, NULL) > 0) {
+    fn(&stats, when, arg);
+    count++;
+  }
+  free(payload);
+  fclose(file);
+  return count;
+}
+
+/* ==================== REPLAY RECORDS ==================== */
+
+/**
+ * GameHistory_encodeReplay - Frame a game as a replay record
+ * @out: Output, at least 4 + HISTORY_REPLAY_MAX bytes
+ * @replay: Game to encode
+ * @when: Time the game was logged
+ *
+ * Returns: Bytes written
+ *
+ * Frame: u32 payload length, then the payload: i64 timestamp, u8 length
+ * and bytes of each name, u8 boardSize, winLength, depthLimit, X's and
+ * O's difficulty (255 = human), u64 seed, u8 winner, u8 moveCount, one
+ * u8 cell per move, then each move's node count as a LEB128 varint. All
+ * integers little-endian
+ */
+static size_t GameHistory_encodeReplay(unsigned char *out,
+                                       const GameReplay *replay, time_t when) {
+  unsigned char *p = out + 4;  // Length goes in once the payload is known
+  p = put64(p, (uint64_t)(int64_t)when);
+  const char *names[2] = {replay->player1, replay->player2};
+  for (int side = 0; side < 2; ++side) {
+    size_t len = strnlen(names[side], MAX_USERNAME - 1);
+    *p++ = (unsigned char)len;
+    memcpy(p, names[side], len);
+    p += len;
+  }
+  *p++ = (unsigned char)replay->boardSize;
+  *p++ = (unsigned char)replay->winLength;
+  *p++ = (unsigned char)(replay->depthLimit < 255 ? replay->depthLimit : 255);
+  for (int side = 0; side < 2; ++side)
+    *p++ = (unsigned char)(replay->difficulty[side] < 0 ? 255
+                                                        : replay->difficulty[side]);
+  p = put64(p, replay->seed);
+  *p++ = (unsigned char)replay->winner;
+  *p++ = (unsigned char)replay->moveCount;
+  memcpy(p, replay->moves, (size_t)replay->moveCount);
+  p += replay->moveCount;
+  for (int i = 0; i < replay->moveCount; ++i) {
+    uint32_t v = replay->nodes[i];
+    do {
+      *p++ = (unsigned char)((v & 0x7F) | (v > 0x7F ? 0x80 : 0));
+      v >>= 7;
+    } while (v != 0);
+  }
+  put32(out, (uint32_t)(p - out - 4));
+  return (size_t)(p - out);
+}
+
+/**
+ * GameHistory_decodeReplay - Read the payload of a replay record
+ * @p: Payload
+ * @length: Payload length
+ * @replay: Filled with the game
+ * @when: Filled with its timestamp
+ *
+ * Returns: 1 on success, 0 if the payload is malformed
+ */
+static int GameHistory_decodeReplay(const unsigned char *p, uint32_t length,
+                                    GameReplay *replay, time_t *when) {
+  const unsigned char *end = p + length;
+  uint64_t v64;
+  if (length < HISTORY_REPLAY_HEADER_BYTES)
+    return 0;
+  p = get64(p, &v64);
+  *when = (time_t)(int64_t)v64;
+  char *names[2] = {replay->player1, replay->player2};
+  for (int side = 0; side < 2; ++side) {
+    size_t len = *p++;
+    // The rest of the header is still to come after the name
+    if (len >= MAX_USERNAME ||
+        (size_t)(end - p) < len + HISTORY_REPLAY_HEADER_BYTES - 8 - 2)
+      return 0;
+    memcpy(names[side], p, len);
+    names[side][len] = '\0';
+    p += len;
+  }
+  replay->boardSize = *p++;
+  replay->winLength = *p++;
+  replay->depthLimit = *p++;
+  for (int side = 0; side < 2; ++side) {
+    int d = *p++;
+    replay->difficulty[side] = d == 255 ? -1 : d;
+  }
+  p = get64(p, &v64);
+  replay->seed = v64;
+  replay->winner = (char)*p++;
+  replay->moveCount = *p++;
+  if (replay->boardSize < 3 || replay->boardSize > GAME_MAX_SIZE ||
+      replay->moveCount > replay->boardSize * replay->boardSize ||
+      end - p < replay->moveCount)
+    return 0;
+  memcpy(replay->moves, p, (size_t)replay->moveCount);
+  p += replay->moveCount;
+  for (int i = 0; i < replay->moveCount; ++i) {
+    uint32_t v = 0;
+    int shift = 0;
+    do {
+      if (p == end || shift > 28)
+        return 0;
+      v |= (uint32_t)(*p & 0x7F) << shift;
+      shift += 7;
+    } while (*p++ & 0x80);
+    replay->nodes[i] = v;
+  }
+  return 1;
+}
+
+/**
+ * GameHistory_forEachReplay - Stream every game in a replay history file
+ * @path: File written with HISTORY_FORMAT_REPLAY
+ * @fn: Called with each game and its timestamp, in file order
+ * @arg: Passed to fn
+ *
+ * Returns: Number of games read, or -1 if the file is missing or not a
+ *          replay file
+ */
+int GameHistory_forEachReplay(const char *path, GameReplayFn fn, void *arg) {
+  FILE *file = fopen(path, "rb");
+  char magic[8];
+  if (file == NULL)
+    return -1;
+  if (fread(magic, 1, 8, file) != 8 ||
+      memcmp(magic, HISTORY_REPLAY_MAGIC, 8) != 0) {
+    fclose(file);
+    return -1;
+  }
+
+  unsigned char *payload = malloc(HISTORY_REPLAY_MAX);
+  GameReplay *replay = malloc(sizeof(*replay));
+  unsigned char prefix[4];
+  uint32_t length;
+  time_t when;
+  int count = 0;
+  while (payload != NULL && replay != NULL &&
+         fread(prefix, 1, 4, file) == 4) {
+    get32(prefix, &length);
+    if (length > HISTORY_REPLAY_MAX ||
+        fread(payload, 1, length, file) != length ||
+        !GameHistory_decodeReplay(payload, length, replay, &when))
+      break;  // Corrupt or cut short by an interrupted write
+    fn(replay, when, arg);
+    count++;
+  }
+  free(replay);
+  free(payload);
+  fclose(file);
+  return count;
+}
+
+/**
+ * GameReplay_play - Play a logged game back on a board
+ * @replay: Game to play back
+ * @g: Filled with the final position, played through makeMove
+ *
+ * Returns: 1 if every move was legal and the game ended with the logged
+ *          winner, 0 otherwise
+ */
+int GameReplay_play(const GameReplay *replay, Game *g) {
+  Game_initSized(g, replay->boardSize, replay->winLength);
+  if (g->size != replay->boardSize || g->winLength != replay->winLength)
+    return 0;  // Settings this build cannot play
+  for (int i = 0; i < replay->moveCount; ++i) {
+    int cell = replay->moves[i];
+    int row = cell / g->size, col = cell % g->size;
+    if (g->checkWin(g) != 2 || cell >= g->size * g->size ||
+        g->board[row][col] != ' ')
+      return 0;
+    g->makeMove(g, row, col, (i & 1) ? 'O' : 'X');
+  }
+  int state = g->checkWin(g);
+  char winner = state == 1 ? 'X' : state == -1 ? 'O' : state == 0 ? 'D' : '?';
+  return winner == replay->winner;
+}
+
+/* ==================== PLAYER INDEX ==================== */
+
+#define HISTORY_INDEX_MAGIC "TTTHIDX1"  // Index file signature (8 bytes, includes version)
+#define HISTORY_INDEX_SUFFIX ".idx"     // Index file = history file name + suffix
+#define HISTORY_INDEX_HEADER_BYTES (8 + 8 + 8 + 4)
+#define HISTORY_INDEX_ENTRY_BYTES (MAX_USERNAME + 5 * 4 + 5 * 8)
+#define HISTORY_INDEX_MIN_CAPACITY 64   // Initial player slots (power of 2)
+
+/**
+ * HistoryEntry structure (internal)
+ * One player's totals and the head of their chain of records
+ */
+typedef struct {
+  char username[MAX_USERNAME];
+  PlayerHistory totals;
+  int64_t last;             // Offset of the player's latest record (-1 = none)
+} HistoryEntry;
+
+struct HistoryIndex {
+  char *path;               // Index file
+  FILE *history;            // History file, read for catch-up and queries
+  unsigned char *payload;   // Scratch buffer for one record
+  int64_t covered;          // History bytes accounted in the entries
+  int64_t linkedFrom;       // Every record from here on carries player links
+  HistoryEntry *entries;    // Players in first-seen order
+  int count;                // Players in entries
+  int capacity;             // Slots in entries (power of 2)
+  uint32_t *buckets;        // 2 * capacity hash buckets, entry + 1 (0 = empty)
+  int dirty;                // Entries changed since the index file was read
+};
+
+/**
+ * HistoryIndex_hash - FNV-1a hash of a username
+ */
+static uint32_t HistoryIndex_hash(const char *name) {
+  uint32_t h = 2166136261u;
+  for (; *name; ++name)
+    h = (h ^ (unsigned char)*name) * 16777619u;
+  return h;
+}
+
+/**
+ * HistoryIndex_probe - Find a username's bucket
+ * @idx: Index to search
+ * @name: Username
+ *
+ * Returns: Bucket holding the player, or the empty bucket it would go in
+ */
+static uint32_t HistoryIndex_probe(const HistoryIndex *idx, const char *name) {
+  uint32_t mask = 2 * (uint32_t)idx->capacity - 1;
+  uint32_t b = HistoryIndex_hash(name) & mask;
+  while (idx->buckets[b] != 0 &&
+         strcmp(idx->entries[idx->buckets[b] - 1].username, name) != 0)
+    b = (b + 1) & mask;
+  return b;
+}
+
+/**
+ * HistoryIndex_grow - Double the player slots and rehash
+ * @idx: Index to grow
+ *
+ * Returns: 1 on success, 0 out of memory (the index is left unchanged)
+ */
+static int HistoryIndex_grow(HistoryIndex *idx) {
+  int capacity = 2 * idx->capacity;
+  HistoryEntry *entries =
+      realloc(idx->entries, (size_t)capacity * sizeof(*entries));
+  if (entries == NULL)
+    return 0;
+  idx->entries = entries;
+  uint32_t *buckets = calloc(2 * (size_t)capacity, sizeof(*buckets));
+  if (buckets == NULL)
+    return 0;
+
+  free(idx->buckets);
+  idx->buckets = buckets;
+  idx->capacity = capacity;
+  for (int i = 0; i < idx->count; ++i)
+    idx->buckets[HistoryIndex_probe(idx, idx->entries[i].username)] =
+        (uint32_t)i + 1;
+  return 1;
+}
+
+/**
+ * HistoryIndex_entry - Find or add a player
+ * @idx: Index to update
+ * @name: Username
+ *
+ * Returns: The player's entry, or NULL out of memory
+ */
+static HistoryEntry *HistoryIndex_entry(HistoryIndex *idx, const char *name) {
+  if (idx->count == idx->capacity && !HistoryIndex_grow(idx))
+    return NULL;
+  uint32_t b = HistoryIndex_probe(idx, name);
+  if (idx->buckets[b] == 0) {
+    HistoryEntry *e = &idx->entries[idx->count];
+    memset(e, 0, sizeof(*e));
+    strncpy(e->username, name, MAX_USERNAME - 1);
+    e->last = -1;
+    idx->buckets[b] = (uint32_t)++idx->count;
+  }
+  return &idx->entries[idx->buckets[b] - 1];
+}
+
+/**
+ * HistoryIndex_reset - Forget every player (index covers no records)
+ * @idx: Index to clear
+ */
+static void HistoryIndex_reset(HistoryIndex *idx) {
+  idx->count = 0;
+  memset(idx->buckets, 0, 2 * (size_t)idx->capacity * sizeof(*idx->buckets));
+  idx->covered = idx->linkedFrom = 8;  // Records start after the signature
+}
+
+/**
+ * HistoryIndex_add - Account a record and link it into its players' chains
+ * @idx: Index to update
+ * @stats: Game in the record
+ * @when: Its timestamp
+ * @offset: Position of the record in the history file
+ * @frame: Bytes the record takes
+ * @links: Filled with each player's previous record offset (may be NULL)
+ *
+ * A player listed on both sides is counted once, as player1
+ */
+static void HistoryIndex_add(HistoryIndex *idx, const GameStats *stats,
+                             time_t when, int64_t offset, int64_t frame,
+                             int64_t links[2]) {
+  const char *names[2] = {stats->player1, stats->player2};
+  const AIStats *ai[2] = {&stats->player1AI, &stats->player2AI};
+
+  for (int side = 0; side < 2; ++side) {
+    if (side == 1 && strcmp(names[0], names[1]) == 0) {
+      if (links)
+        links[1] = links[0];
+      break;
+    }
+    HistoryEntry *e = HistoryIndex_entry(idx, names[side]);
+    if (links)
+      links[side] = e ? e->last : -1;
+    if (e == NULL)
+      continue;  // Out of memory: queries for this player fall back to a scan
+
+    PlayerHistory *t = &e->totals;
+    if (t->games++ == 0)
+      t->firstPlayed = when;
+    t->lastPlayed = when;
+    if (stats->winner == 'D')
+      t->draws++;
+    else if (stats->winner == (side == 0 ? 'X' : 'O'))
+      t->wins++;
+    else
+      t->losses++;
+    if (stats->maxDepth > t->maxDepth)
+      t->maxDepth = stats->maxDepth;
+    t->aiNodes += stats->aiNodesExplored;
+    t->searchNodes += ai[side]->nodes;
+    e->last = offset;
+  }
+  idx->covered = offset + frame;
+  idx->dirty = 1;
+}
+
+/**
+ * HistoryIndex_load - Read the index file written by HistoryIndex_save
+ * @idx: Empty index to fill
+ * @historyBytes: Current size of the history file
+ *
+ * An index that is missing, damaged or claims more records than the
+ * history file holds is ignored; catch-up then rebuilds it
+ */
+static void HistoryIndex_load(HistoryIndex *idx, int64_t historyBytes) {
+  FILE *file = fopen(idx->path, "rb");
+  if (file == NULL)
+    return;
+
+  unsigned char buf[HISTORY_INDEX_ENTRY_BYTES];
+  uint64_t covered, linkedFrom;
+  uint32_t count, v32;
+  uint64_t v64;
+  int ok = fread(buf, 1, HISTORY_INDEX_HEADER_BYTES, file) ==
+               HISTORY_INDEX_HEADER_BYTES &&
+           memcmp(buf, HISTORY_INDEX_MAGIC, 8) == 0;
+  if (ok) {
+    get32(get64(get64(buf + 8, &covered), &linkedFrom), &count);
+    ok = covered >= 8 && (int64_t)covered <= historyBytes &&
+         linkedFrom >= 8 && linkedFrom <= covered;
+  }
+
+  for (uint32_t i = 0; ok && i < count; ++i) {
+    ok = fread(buf, 1, HISTORY_INDEX_ENTRY_BYTES, file) ==
+         HISTORY_INDEX_ENTRY_BYTES;
+    buf[MAX_USERNAME - 1] = '\0';
+    HistoryEntry *e = ok ? HistoryIndex_entry(idx, (char *)buf) : NULL;
+    if (e == NULL) {
+      ok = 0;
+      break;
+    }
+    PlayerHistory *t = &e->totals;
+    const unsigned char *p = buf + MAX_USERNAME;
+    p = get32(p, &v32);
+    t->games = (int)v32;
+    p = get32(p, &v32);
+    t->wins = (int)v32;
+    p = get32(p, &v32);
+    t->losses = (int)v32;
+    p = get32(p, &v32);
+    t->draws = (int)v32;
+    p = get32(p, &v32);
+    t->maxDepth = (int)v32;
+    p = get64(p, &v64);
+    t->aiNodes = (long long)v64;
+    p = get64(p, &v64);
+    t->searchNodes = (long long)v64;
+    p = get64(p, &v64);
+    t->firstPlayed = (time_t)(int64_t)v64;
+    p = get64(p, &v64);
+    t->lastPlayed = (time_t)(int64_t)v64;
+    get64(p, &v64);
+    e->last = (int64_t)v64;
+  }
+  fclose(file);
+
+  if (ok) {
+    idx->covered = (int64_t)covered;
+    idx->linkedFrom = (int64_t)linkedFrom;
+  } else {
+    HistoryIndex_reset(idx);
+  }
+}
+
+/**
+ * HistoryIndex_save - Write the index file
+ * @idx: Index to save
+ *
+ * Returns: 1 on success, 0 on I/O error
+ *
+ * Written to a temporary file and renamed over the old index, so a
+ * reader never sees a half-written one
+ */
+static int HistoryIndex_save(const HistoryIndex *idx) {
+  size_t len = strlen(idx->path);
+  char *tmp = malloc(len + 5);
+  if (tmp == NULL)
+    return 0;
+  memcpy(tmp, idx->path, len);
+  memcpy(tmp + len, ".tmp", 5);
+
+  FILE *file = fopen(tmp, "wb");
+  int ok = file != NULL;
+  if (ok) {
+    unsigned char buf[HISTORY_INDEX_ENTRY_BYTES];
+    memcpy(buf, HISTORY_INDEX_MAGIC, 8);
+    put32(put64(put64(buf + 8, (uint64_t)idx->covered),
+                (uint64_t)idx->linkedFrom),
+          (uint32_t)idx->count);
+    ok = fwrite(buf, 1, HISTORY_INDEX_HEADER_BYTES, file) ==
+         HISTORY_INDEX_HEADER_BYTES;
+
+    for (int i = 0; ok && i < idx->count; ++i) {
+      const HistoryEntry *e = &idx->entries[i];
+      const PlayerHistory *t = &e->totals;
+      memcpy(buf, e->username, MAX_USERNAME);
+      unsigned char *p = buf + MAX_USERNAME;
+      p = put32(p, (uint32_t)t->games);
+      p = put32(p, (uint32_t)t->wins);
+      p = put32(p, (uint32_t)t->losses);
+      p = put32(p, (uint32_t)t->draws);
+      p = put32(p, (uint32_t)t->maxDepth);
+      p = put64(p, (uint64_t)t->aiNodes);
+      p = put64(p, (uint64_t)t->searchNodes);
+      p = put64(p, (uint64_t)(int64_t)t->firstPlayed);
+      p = put64(p, (uint64_t)(int64_t)t->lastPlayed);
+      put64(p, (uint64_t)e->last);
+      ok = fwrite(buf, 1, HISTORY_INDEX_ENTRY_BYTES, file) ==
+           HISTORY_INDEX_ENTRY_BYTES;
+    }
+    ok = fclose(file) == 0 && ok;
+  }
+  if (ok)
+    ok = rename(tmp, idx->path) == 0;
+  else
+    remove(tmp);
+  free(tmp);
+  return ok;
+}
+
+/**
+ * HistoryIndex_catchUp - Account the records appended since the index
+ * was saved
+ * @idx: Index to update
+ *
+ * Stops at the end of the file or at a cut-short record
+ */
+static void HistoryIndex_catchUp(HistoryIndex *idx) {
+  GameStats stats;
+  time_t when;
+  int linked;
+  if (fseek(idx->history, (long)idx->covered, SEEK_SET) != 0)
+    return;
+  for (;;) {
+    int64_t frame = GameHistory_readRecord(idx->history, idx->payload, &stats,
+                                           &when, NULL, &linked);
+    if (frame == 0)
+      break;
+    if (!linked)
+      idx->linkedFrom = idx->covered + frame;
+    HistoryIndex_add(idx, &stats, when, idx->covered, frame, NULL);
+  }
+}
+
+/**
+ * HistoryIndex_open - Load a binary history file's player index
+ * @path: History file written with HISTORY_FORMAT_BINARY
+ *
+ * Returns: Index, or NULL if the history file is missing or not a
+ *          history file (or out of memory)
+ */
+HistoryIndex *HistoryIndex_open(const char *path) {
+  HistoryIndex *idx = calloc(1, sizeof(*idx));
+  if (idx == NULL)
+    return NULL;
+  size_t len = strlen(path);
+  idx->path = malloc(len + sizeof(HISTORY_INDEX_SUFFIX));
+  idx->history = GameHistory_openReader(path);
+  idx->payload = malloc(HISTORY_RECORD_MAX);
+  idx->capacity = HISTORY_INDEX_MIN_CAPACITY;
+  idx->entries = malloc((size_t)idx->capacity * sizeof(*idx->entries));
+  idx->buckets = calloc(2 * (size_t)idx->capacity, sizeof(*idx->buckets));
+  if (idx->path == NULL || idx->history == NULL || idx->payload == NULL ||
+      idx->entries == NULL || idx->buckets == NULL) {
+    HistoryIndex_close(idx);
+    return NULL;
+  }
+  memcpy(idx->path, path, len);
+  memcpy(idx->path + len, HISTORY_INDEX_SUFFIX, sizeof(HISTORY_INDEX_SUFFIX));
+
+  fseek(idx->history, 0, SEEK_END);
+  HistoryIndex_reset(idx);
+  HistoryIndex_load(idx, (int64_t)ftell(idx->history));
+  HistoryIndex_catchUp(idx);
+  return idx;
+}
+
+/**
+ * HistoryIndex_close - Save the index if it changed, and free it
+ * @idx: Index to close (NULL is ignored)
+ */
+void HistoryIndex_close(HistoryIndex *idx) {
+  if (idx == NULL)
+    return;
+  if (idx->dirty)
+    HistoryIndex_save(idx);
+  if (idx->history != NULL)
+    fclose(idx->history);
+  free(idx->path);
+  free(idx->payload);
+  free(idx->entries);
+  free(idx->buckets);
+  free(idx);
+}
+
+/**
+ * HistoryIndex_player - Look up a player's totals
+ * @idx: Index to read
+ * @username: Player to find (exact name)
+ * @totals: Filled with the player's totals (all zero if not found)
+ *
+ * Returns: 1 if the player has games in the history, 0 if not
+ */
+int HistoryIndex_player(const HistoryIndex *idx, const char *username,
+                        PlayerHistory *totals) {
+  uint32_t b = HistoryIndex_probe(idx, username);
+  if (idx->buckets[b] == 0) {
+    memset(totals, 0, sizeof(*totals));
+    return 0;
+  }
+  *totals = idx->entries[idx->buckets[b] - 1].totals;
+  return 1;
+}
+
+/**
+ * HistoryIndex_scan - Report a player's games in part of the history file
+ * @idx: Index whose history file to read
+ * @from: First record offset
+ * @to: End of the range
+ * @username: Player to match
+ * @fn: Called with each matching game
+ * @arg: Passed to fn
+ *
+ * Returns: Number of games reported
+ */
+static int HistoryIndex_scan(HistoryIndex *idx, int64_t from, int64_t to,
+                             const char *username, GameHistoryFn fn,
+                             void *arg) {
+  GameStats stats;
+  time_t when;
+  int count = 0;
+  if (fseek(idx->history, (long)from, SEEK_SET) != 0)
+    return 0;
+  while (from < to) {
+    int64_t frame = GameHistory_readRecord(idx->history, idx->payload, &stats,
+                                           &when, NULL, NULL);
+    if (frame == 0)
+      break;
+    if (strcmp(stats.player1, username) == 0 ||
+        strcmp(stats.player2, username) == 0) {
+      fn(&stats, when, arg);
+      count++;
+    }
+    from += frame;
+  }
+  return count;
+}
+
+/**
+ * HistoryIndex_forEachGame - Report every game of one player
+ * @idx: Index to read
+ * @username: Player to match (exact name)
+ * @fn: Called with each game and its timestamp, oldest first
+ * @arg: Passed to fn
+ *
+ * Returns: Number of games reported
+ *
+ * Walks the player's chain back from their latest record, so only their
+ * own records are read. Records older than linkedFrom carry no links and
+ * are scanned; a chain that does not check out (a record lost to a failed
+ * write) falls back to scanning the whole file
+ */
+int HistoryIndex_forEachGame(HistoryIndex *idx, const char *username,
+                             GameHistoryFn fn, void *arg) {
+  uint32_t b = HistoryIndex_probe(idx, username);
+  if (idx->buckets[b] == 0)
+    return 0;
+  const HistoryEntry *e = &idx->entries[idx->buckets[b] - 1];
+
+  int64_t *chain = malloc(((size_t)e->totals.games + 1) * sizeof(*chain));
+  if (chain == NULL)
+    return HistoryIndex_scan(idx, 8, idx->covered, username, fn, arg);
+
+  GameStats stats;
+  time_t when;
+  int64_t links[2];
+  int linked, n = 0;
+  int64_t offset = e->last;
+  while (offset >= idx->linkedFrom) {
+    int side = -1;
+    if (n < e->totals.games && fseek(idx->history, (long)offset, SEEK_SET) == 0 &&
+        GameHistory_readRecord(idx->history, idx->payload, &stats, &when,
+                               links, &linked) > 0 &&
+        linked)
+      side = strcmp(stats.player1, username) == 0   ? 0
+             : strcmp(stats.player2, username) == 0 ? 1
+                                                    : -1;
+    if (side < 0) {
+      free(chain);
+      return HistoryIndex_scan(idx, 8, idx->covered, username, fn, arg);
+    }
+    chain[n++] = offset;
+    offset = links[side];
+  }
+
+  // A chain reaching into the unlinked records continues there
+  int count = 0;
+  if (offset >= 8)
+    count = HistoryIndex_scan(idx, 8, idx->linkedFrom, username, fn, arg);
+  for (int i = n - 1; i >= 0; --i) {
+    fseek(idx->history, (long)chain[i], SEEK_SET);
+    GameHistory_readRecord(idx->history, idx->payload, &stats, &when, NULL,
+                           NULL);
+    fn(&stats, when, arg);
+    count++;
+  }
+  free(chain);
+  return count;
+}
+
+/* ==================== BUFFERED WRITER ==================== */
+
+/**
+ * GameHistory_flushLocked - Write the buffer out (lock held)
+ * @h: Sink to flush
+ *
+ * Returns: 1 on success, 0 on I/O error (the buffered games are dropped
+ *          either way, so one bad write cannot wedge the session)
+ */
+static int GameHistory_flushLocked(GameHistory *h) {
+  int ok = 1;
+  if (h->len > 0) {
+    TRACE_START(t);
+    ok = fwrite(h->buf, 1, h->len, h->file) == h->len;
+    TRACE_END_ARGS(t, "io", "history write", "\"bytes\":%zu", h->len);
+    if (ok) {
+      h->fileBytes += (int64_t)h->len;
+    } else if (fseek(h->file, 0, SEEK_END) == 0) {
+      h->fileBytes = ftell(h->file);  // Part may have been written
+    }
+    h->len = 0;
+  }
+  h->pending = 0;
+  return ok;
+}
+
+/**
+ * GameHistory_flusherMain - Timer thread
+ * @p: GameHistory to watch
+ *
+ * Sleeps until a game is buffered, then writes the buffer flushMs later
+ * unless a batch write emptied it first
+ */
+static void *GameHistory_flusherMain(void *p) {
+  GameHistory *h = p;
+  pthread_mutex_lock(&h->lock);
+  while (!h->stop) {
+    if (h->pending == 0) {
+      pthread_cond_wait(&h->wake, &h->lock);
+      continue;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += h->flushMs / 1000;
+    deadline.tv_nsec += (long)(h->flushMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+    while (!h->stop && h->pending > 0 &&
+           pthread_cond_timedwait(&h->wake, &h->lock, &deadline) != ETIMEDOUT)
+      ;
+    if (!h->stop && h->pending > 0)
+      GameHistory_flushLocked(h);
+  }
+  pthread_mutex_unlock(&h->lock);
+  return NULL;
+}
+
+/**
+ * GameHistory_open - Open a history file for appending
+ * @path: File to append to (created if missing)
+ * @format: HISTORY_FORMAT_TEXT or HISTORY_FORMAT_BINARY
+ * @batchSize: Games to buffer before writing (at least 1)
+ * @flushMs: Milliseconds a buffered game may wait (0 = no timer)
+ *
+ * Returns: New sink, or NULL on failure
+ */
+GameHistory *GameHistory_open(const char *path, int format, int batchSize,
+                              int flushMs) {
+  GameHistory *h = calloc(1, sizeof(*h));
+  if (h == NULL)
+    return NULL;
+  h->format = (format == HISTORY_FORMAT_BINARY ||
+               format == HISTORY_FORMAT_REPLAY) ? format : HISTORY_FORMAT_TEXT;
+  h->batchSize = batchSize > 0 ? batchSize : 1;
+  h->flushMs = flushMs > 0 ? flushMs : 0;
+  h->buf = malloc(HISTORY_BUFFER_SIZE);
+  h->file = fopen(path, h->format == HISTORY_FORMAT_TEXT ? "a" : "a+b");
+  int ok = h->buf != NULL && h->file != NULL;
+
+  if (ok && h->format != HISTORY_FORMAT_TEXT) {
+    // A new file gets the signature; an existing one must carry it
+    const char *signature = h->format == HISTORY_FORMAT_BINARY
+                                ? HISTORY_MAGIC
+                                : HISTORY_REPLAY_MAGIC;
+    char magic[8];
+    ok = fseek(h->file, 0, SEEK_END) == 0;
+    if (ok && ftell(h->file) == 0)
+      ok = fwrite(signature, 1, 8, h->file) == 8 && fflush(h->file) == 0;
+    else if (ok)
+      ok = fseek(h->file, 0, SEEK_SET) == 0 &&
+           fread(magic, 1, 8, h->file) == 8 &&
+           memcmp(magic, signature, 8) == 0;
+  }
+  if (!ok) {
+    if (h->file != NULL)
+      fclose(h->file);
+    free(h->buf);
+    free(h);
+    return NULL;
+  }
+
+  if (h->format == HISTORY_FORMAT_BINARY) {
+    fseek(h->file, 0, SEEK_END);
+    h->fileBytes = ftell(h->file);
+    h->index = HistoryIndex_open(path);
+    // Cut off a record left half-written by an interrupted session
+    if (h->index != NULL && h->index->covered < h->fileBytes &&
+        ftruncate(fileno(h->file), h->index->covered) == 0)
+      h->fileBytes = h->index->covered;
+  }
+
+  setvbuf(h->file, NULL, _IONBF, 0);  // One write() per flush
+  pthread_mutex_init(&h->lock, NULL);
+  pthread_cond_init(&h->wake, NULL);
+  if (h->flushMs > 0)
+    h->hasFlusher =
+        pthread_create(&h->flusher, NULL, GameHistory_flusherMain, h) == 0;
+  return h;
+}
+
+/**
+ * GameHistory_append - Log one finished game
+ * @h: Sink to write to
+ * @stats: Game to log, stamped with the current time
+ *
+ * Returns: 1 on success, 0 if a write the append triggered failed
+ */
+int GameHistory_append(GameHistory *h, const GameStats *stats) {
+  if (h->format == HISTORY_FORMAT_REPLAY)
+    return 0;  // Needs the moves: GameHistory_appendReplay
+  char line[HISTORY_LINE_MAX];
+  time_t now = time(NULL);
+  size_t n = h->format == HISTORY_FORMAT_BINARY
+                 ? 4 + (h->index ? HISTORY_LINKED_BYTES : HISTORY_RECORD_BYTES)
+                 : (size_t)GameHistory_formatLine(line, sizeof(line), stats,
+                                                  now);
+
+  int ok = 1;
+  pthread_mutex_lock(&h->lock);
+  if (h->len + n > HISTORY_BUFFER_SIZE)
+    ok = GameHistory_flushLocked(h);
+  if (h->format == HISTORY_FORMAT_BINARY) {
+    // Links are taken under the lock, so concurrent appends chain in order
+    int64_t links[2];
+    if (h->index)
+      HistoryIndex_add(h->index, stats, now, h->fileBytes + (int64_t)h->len,
+                       (int64_t)n, links);
+    GameHistory_encode(h->buf + h->len, stats, now, h->index ? links : NULL);
+  } else {
+    memcpy(h->buf + h->len, line, n);
+  }
+  h->len += n;
+  if (++h->pending == 1)
+    pthread_cond_signal(&h->wake);
+  if (h->pending >= h->batchSize)
+    ok = GameHistory_flushLocked(h) && ok;
+  pthread_mutex_unlock(&h->lock);
+  return ok;
+}
+
+/**
+ * GameHistory_appendReplay - Log one finished game move by move
+ * @h: Replay sink to write to
+ * @replay: Game to log, stamped with the current time
+ *
+ * Returns: 1 on success, 0 if a write the append triggered failed or
+ *          h is not a replay sink
+ */
+int GameHistory_appendReplay(GameHistory *h, const GameReplay *replay) {
+  if (h->format != HISTORY_FORMAT_REPLAY)
+    return 0;
+  unsigned char record[4 + HISTORY_REPLAY_MAX];
+  size_t n = GameHistory_encodeReplay(record, replay, time(NULL));
+
+  int ok = 1;
+  pthread_mutex_lock(&h->lock);
+  if (h->len + n > HISTORY_BUFFER_SIZE)
+    ok = GameHistory_flushLocked(h);
+  memcpy(h->buf + h->len, record, n);
+  h->len += n;
+  if (++h->pending == 1)
+    pthread_cond_signal(&h->wake);
+  if (h->pending >= h->batchSize)
+    ok = GameHistory_flushLocked(h) && ok;
+  pthread_mutex_unlock(&h->lock);
+  return ok;
+}
+
+/**
+ * GameHistory_flush - Write every buffered game now
+ * @h: Sink to flush (NULL is ignored)
+ *
+ * Returns: 1 on success (or nothing to write), 0 on I/O error
+ */
+int GameHistory_flush(GameHistory *h) {
+  if (h == NULL)
+    return 1;
+  pthread_mutex_lock(&h->lock);
+  int ok = GameHistory_flushLocked(h);
+  pthread_mutex_unlock(&h->lock);
+  return ok;
+}
+
+/**
+ * GameHistory_close - Flush, stop the timer thread and close the file
+ * @h: Sink to close (NULL is ignored)
+ */
+void GameHistory_close(GameHistory *h) {
+  if (h == NULL)
+    return;
+  pthread_mutex_lock(&h->lock);
+  GameHistory_flushLocked(h);
+  h->stop = 1;
+  pthread_cond_signal(&h->wake);
+  pthread_mutex_unlock(&h->lock);
+  if (h->hasFlusher)
+    pthread_join(h->flusher, NULL);
+
+  pthread_cond_destroy(&h->wake);
+  pthread_mutex_destroy(&h->lock);
+  HistoryIndex_close(h->index);
+  fclose(h->file);
+  free(h->buf);
+  free(h);
+}
@@ -0,0 +1,237 @@
+/*
+ * history.h
+ *
+ * Game-history sink header for Tic-Tac-Toe
+ * Keeps the history file open for the whole session and writes finished
+ * games in batches, as text lines or as length-prefixed binary records.
+ * Binary histories also keep a per-player index for fast queries, and
+ * replay histories keep every move so games can be played back
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "utils.h"
+
+#include <time.h>
+
+/* Record formats (see GameHistory_open) */
+#define HISTORY_FORMAT_TEXT 0    // One human-readable line per game (game_stats.txt)
+#define HISTORY_FORMAT_BINARY 1  // Length-prefixed binary records (game_stats.bin)
+#define HISTORY_FORMAT_REPLAY 2  // Move-by-move game records (game_replays.bin)
+
+#define HISTORY_DEFAULT_BATCH 64        // Games buffered before a write
+#define HISTORY_DEFAULT_FLUSH_MS 1000   // Longest a game waits in the buffer
+#define HISTORY_LINE_MAX 1024           // Longest text line written or read
+
+/**
+ * GameHistory - Buffered, append-only game-history writer (opaque)
+ *
+ * Appends are cheap memory copies under a mutex, so any thread may log
+ * games; a write() happens once per batch, when the buffer fills, when
+ * the oldest buffered game is flushMs old (a background thread watches
+ * the clock) and on GameHistory_flush/close
+ */
+typedef struct GameHistory GameHistory;
+
+/**
+ * GameHistoryFn - Callback receiving one game read back from a history
+ * @stats: The game
+ * @when: Time it was logged
+ * @arg: Caller's argument
+ */
+typedef void (*GameHistoryFn)(const GameStats *stats, time_t when, void *arg);
+
+/**
+ * GameReplay structure
+ * Everything needed to play a logged game back move by move
+ */
+typedef struct {
+  char player1[MAX_USERNAME];           // Player X
+  char player2[MAX_USERNAME];           // Player O
+  int boardSize;                        // Board side N
+  int winLength;                        // Stones in a row to win K
+  int depthLimit;                       // AI search depth on boards larger than 3x3
+  int difficulty[2];                    // Difficulty of X's and O's AI (-1 = human)
+  unsigned long long seed;              // X's AI was seeded with seed, O's with seed + 1
+  char winner;                          // 'X', 'O' or 'D'
+  int moveCount;                        // Moves played, X first
+  unsigned char moves[GAME_MAX_CELLS];  // Cell of each move (row * boardSize + col)
+  unsigned nodes[GAME_MAX_CELLS];       // Nodes searched for each move (0 = human)
+} GameReplay;
+
+/**
+ * GameReplayFn - Callback receiving one game read back from a replay history
+ * @replay: The game
+ * @when: Time it was logged
+ * @arg: Caller's argument
+ */
+typedef void (*GameReplayFn)(const GameReplay *replay, time_t when, void *arg);
+
+/**
+ * PlayerHistory structure
+ * One player's totals over every game in a binary history file
+ */
+typedef struct {
+  int games;              // Games the player took part in
+  int wins;               // Games won (as X when player1, as O when player2)
+  int losses;             // Games lost
+  int draws;              // Games drawn
+  int maxDepth;           // Deepest AI search recorded in those games
+  long long aiNodes;      // Sum of the games' aiNodesExplored
+  long long searchNodes;  // Nodes searched by the AI playing this side
+  time_t firstPlayed;     // Timestamp of the player's first game
+  time_t lastPlayed;      // Timestamp of the player's latest game
+} PlayerHistory;
+
+/**
+ * HistoryIndex - Per-player index of a binary history file (opaque)
+ *
+ * Saved next to the history as "<history>.idx": each player's totals and
+ * the offset of their latest record. Every binary record also stores the
+ * offset of each player's previous record, so one player's games are
+ * found by following that chain instead of reading the whole file. The
+ * index notes how much of the history it covers; records appended after
+ * that are read on open, so a stale or missing index is only slower
+ */
+typedef struct HistoryIndex HistoryIndex;
+
+/**
+ * GameHistory_open - Open a history file for appending
+ * @path: File to append to (created if missing)
+ * @format: HISTORY_FORMAT_TEXT, HISTORY_FORMAT_BINARY or HISTORY_FORMAT_REPLAY
+ * @batchSize: Games to buffer before writing (at least 1)
+ * @flushMs: Milliseconds a buffered game may wait (0 = only on batch/flush)
+ *
+ * Returns: New sink, or NULL if the file cannot be opened, or is a
+ *          binary or replay file with a different signature
+ *
+ * A binary sink keeps the file's HistoryIndex current and saves it on
+ * close. A replay sink takes GameHistory_appendReplay games only
+ */
+GameHistory *GameHistory_open(const char *path, int format, int batchSize,
+                              int flushMs);
+
+/**
+ * GameHistory_append - Log one finished game
+ * @h: Sink to write to
+ * @stats: Game to log, stamped with the current time
+ *
+ * Returns: 1 on success, 0 if a write the append triggered failed or
+ *          h is a replay sink
+ */
+int GameHistory_append(GameHistory *h, const GameStats *stats);
+
+/**
+ * GameHistory_appendReplay - Log one finished game move by move
+ * @h: Replay sink (HISTORY_FORMAT_REPLAY) to write to
+ * @replay: Game to log, stamped with the current time
+ *
+ * Returns: 1 on success, 0 if a write the append triggered failed or
+ *          h is not a replay sink
+ *
+ * Records are small: a byte per move plus its node count as a varint,
+ * after the two names and a 25-byte header
+ */
+int GameHistory_appendReplay(GameHistory *h, const GameReplay *replay);
+
+/**
+ * GameHistory_flush - Write every buffered game now
+ * @h: Sink to flush (NULL is ignored)
+ *
+ * Returns: 1 on success (or nothing to write), 0 on I/O error
+ */
+int GameHistory_flush(GameHistory *h);
+
+/**
+ * GameHistory_close - Flush, stop the timer thread and close the file
+ * @h: Sink to close (NULL is ignored)
+ */
+void GameHistory_close(GameHistory *h);
+
+/**
+ * GameHistory_formatLine - Render a game as a text history line
+ * @buf: Output buffer
+ * @size: Buffer size (HISTORY_LINE_MAX is always enough)
+ * @stats: Game to render
+ * @when: Time the game was logged
+ *
+ * Returns: Length of the line, newline included
+ */
+int GameHistory_formatLine(char *buf, size_t size, const GameStats *stats,
+                           time_t when);
+
+/**
+ * GameHistory_forEach - Read every game in a binary history file
+ * @path: File written with HISTORY_FORMAT_BINARY
+ * @fn: Called with each game and its timestamp, in file order
+ * @arg: Passed to fn
+ *
+ * Returns: Number of games read, or -1 if the file is missing or not a
+ *          history file. A truncated last record (interrupted write) is
+ *          ignored
+ */
+int GameHistory_forEach(const char *path, GameHistoryFn fn, void *arg);
+
+/**
+ * GameHistory_forEachReplay - Stream every game in a replay history file
+ * @path: File written with HISTORY_FORMAT_REPLAY
+ * @fn: Called with each game and its timestamp, in file order
+ * @arg: Passed to fn
+ *
+ * Returns: Number of games read, or -1 if the file is missing or not a
+ *          replay file. Reading stops at a corrupt or truncated record.
+ *          One record is held in memory at a time
+ */
+int GameHistory_forEachReplay(const char *path, GameReplayFn fn, void *arg);
+
+/**
+ * GameReplay_play - Play a logged game back on a board
+ * @replay: Game to play back
+ * @g: Filled with the final position, played through makeMove
+ *
+ * Returns: 1 if every move was legal and the game ended with the logged
+ *          winner, 0 otherwise (g then holds the position reached)
+ */
+int GameReplay_play(const GameReplay *replay, Game *g);
+
+/**
+ * HistoryIndex_open - Load a binary history file's player index
+ * @path: History file written with HISTORY_FORMAT_BINARY
+ *
+ * Returns: Index brought up to date with the file, or NULL if the file
+ *          is missing or not a history file
+ */
+HistoryIndex *HistoryIndex_open(const char *path);
+
+/**
+ * HistoryIndex_close - Save the index if it changed, and free it
+ * @idx: Index to close (NULL is ignored)
+ */
+void HistoryIndex_close(HistoryIndex *idx);
+
+/**
+ * HistoryIndex_player - Look up a player's totals
+ * @idx: Index to read
+ * @username: Player to find (exact name)
+ * @totals: Filled with the player's totals (all zero if not found)
+ *
+ * Returns: 1 if the player has games in the history, 0 if not. O(1),
+ *          no history records are read
+ */
+int HistoryIndex_player(const HistoryIndex *idx, const char *username,
+                        PlayerHistory *totals);
+
+/**
+ * HistoryIndex_forEachGame - Report every game of one player
+ * @idx: Index to read
+ * @username: Player to match (exact name)
+ * @fn: Called with each game and its timestamp, oldest first
+ * @arg: Passed to fn
+ *
+ * Returns: Number of games reported. Reads only the player's records
+ */
+int HistoryIndex_forEachGame(HistoryIndex *idx, const char *username,
+                             GameHistoryFn fn, void *arg);
+
+#endif // HISTORY_H
@@ -0,0 +1,754 @@
+/*
+ * leaderboard.c
+ *
+ * Indexed leaderboard store implementation for Tic-Tac-Toe
+ * Fixed-size binary records with an open-addressing hash index, both
+ * accessed through one shared memory mapping of the store file
+ */
+
+#define _POSIX_C_SOURCE 200809L  // mmap, ftruncate, fcntl locks
+
+#include "leaderboard.h"
+#include "trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LEADERBOARD_MAGIC "TTTLEAD1"         // File signature (8 bytes, includes version)
+#define LEADERBOARD_BYTE_ORDER 0x01020304u   // Reads back differently on a foreign-endian host
+#define LEADERBOARD_MIN_CAPACITY 64          // Record slots in a new store
+#define LEADERBOARD_MAX_CAPACITY (1u << 28)  // Keeps 2 * capacity buckets in 32 bits
+#define LEADERBOARD_WRITE_BATCH 32          // Players with pending results before a write-back
+
+/**
+ * LeaderboardHeader structure (internal)
+ * First bytes of the store file
+ */
+typedef struct {
+  char magic[8];       // LEADERBOARD_MAGIC
+  uint32_t byteOrder;  // LEADERBOARD_BYTE_ORDER as written
+  uint32_t count;      // Record slots in use
+  uint32_t capacity;   // Record slots allocated (power of two)
+  uint32_t reserved;   // Zero
+} LeaderboardHeader;
+
+/**
+ * LeaderboardSlot structure (internal)
+ * One player on disk
+ */
+typedef struct {
+  char username[MAX_USERNAME];  // NUL-terminated, zero-padded
+  char pad[2];                  // Keeps the counters 4-byte aligned
+  int32_t wins;
+  int32_t losses;
+  int32_t draws;
+  int32_t totalGames;
+} LeaderboardSlot;
+
+/**
+ * LeaderboardDelta structure (internal)
+ * Results recorded for a player but not yet written to the file
+ */
+typedef struct {
+  char key[MAX_USERNAME];  // Normalized username (see Leaderboard_key)
+  int wins;
+  int losses;
+  int draws;
+} LeaderboardDelta;
+
+struct Leaderboard {
+  int fd;              // Store file, open read/write
+  unsigned char *map;  // Shared mapping of the whole file
+  size_t size;         // Mapped length
+  LeaderboardDelta pending[LEADERBOARD_WRITE_BATCH];  // Write-back buffer
+  int pendingCount;    // Players in pending (0 = nothing dirty)
+};
+
+/**
+ * Leaderboard_fileSize - Bytes needed for a store of a given capacity
+ * @capacity: Record slots
+ */
+static size_t Leaderboard_fileSize(uint32_t capacity) {
+  return sizeof(LeaderboardHeader) + capacity * sizeof(LeaderboardSlot) +
+         2 * (size_t)capacity * sizeof(uint32_t);
+}
+
+static inline LeaderboardHeader *Leaderboard_header(const Leaderboard *lb) {
+  return (LeaderboardHeader *)lb->map;
+}
+
+static inline LeaderboardSlot *Leaderboard_slots(const Leaderboard *lb) {
+  return (LeaderboardSlot *)(lb->map + sizeof(LeaderboardHeader));
+}
+
+/**
+ * Leaderboard_index - Hash buckets of a store laid out for a capacity
+ * @lb: Store
+ * @capacity: Capacity the index was built for
+ */
+static inline uint32_t *Leaderboard_index(const Leaderboard *lb,
+                                          uint32_t capacity) {
+  return (uint32_t *)(lb->map + sizeof(LeaderboardHeader) +
+                      capacity * sizeof(LeaderboardSlot));
+}
+
+/**
+ * Leaderboard_key - Normalize a username to its stored form
+ * @key: Output, MAX_USERNAME bytes, zero-padded
+ * @username: Name as given (truncated like PlayerRecord.username)
+ */
+static void Leaderboard_key(char *key, const char *username) {
+  size_t n = strnlen(username, MAX_USERNAME - 1);
+  memset(key, 0, MAX_USERNAME);
+  memcpy(key, username, n);
+}
+
+/**
+ * Leaderboard_hash - FNV-1a hash of a username
+ */
+static uint32_t Leaderboard_hash(const char *key) {
+  uint32_t h = 2166136261u;
+  for (; *key; ++key)
+    h = (h ^ (unsigned char)*key) * 16777619u;
+  return h;
+}
+
+/**
+ * Leaderboard_probe - Find a username's bucket
+ * @lb: Store
+ * @index: Buckets to search (2 * capacity of them)
+ * @capacity: Capacity the index was built for
+ * @count: Slots in use; buckets pointing past them count as empty
+ * @key: Normalized username
+ *
+ * Returns: Bucket holding the player, or the empty bucket to insert it at
+ * The index is at most half full, so linear probing always terminates
+ */
+static uint32_t Leaderboard_probe(const Leaderboard *lb, const uint32_t *index,
+                                  uint32_t capacity, uint32_t count,
+                                  const char *key) {
+  const LeaderboardSlot *slots = Leaderboard_slots(lb);
+  uint32_t mask = 2 * capacity - 1;
+  for (uint32_t b = Leaderboard_hash(key) & mask;; b = (b + 1) & mask) {
+    uint32_t v = index[b];
+    if (v == 0 || v > count ||
+        strncmp(slots[v - 1].username, key, MAX_USERNAME) == 0)
+      return b;
+  }
+}
+
+/**
+ * Leaderboard_map - Map the first bytes of the store file
+ * @lb: Store whose fd is open
+ * @size: Bytes to map (the file must be at least this long)
+ *
+ * Returns: 1 on success (lb->map replaced, the old mapping is left to the
+ *          caller), 0 on failure (lb unchanged)
+ */
+static int Leaderboard_map(Leaderboard *lb, size_t size) {
+  void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, lb->fd, 0);
+  if (map == MAP_FAILED)
+    return 0;
+  lb->map = map;
+  lb->size = size;
+  return 1;
+}
+
+/**
+ * Leaderboard_lock - Take or release the whole-file lock
+ * @lb: Store
+ * @type: F_RDLCK (readers share it), F_WRLCK (exclusive) or F_UNLCK
+ *
+ * Returns: 1 on success, 0 on failure
+ *
+ * POSIX record locks are advisory and per process, which is exactly the
+ * scope needed: every process using the store goes through these calls
+ */
+static int Leaderboard_lock(const Leaderboard *lb, short type) {
+  struct flock fl;
+  memset(&fl, 0, sizeof(fl));
+  fl.l_type = type;
+  fl.l_whence = SEEK_SET;  // l_start = l_len = 0: the whole file
+  while (fcntl(lb->fd, F_SETLKW, &fl) != 0)
+    if (errno != EINTR)
+      return 0;
+  return 1;
+}
+
+/**
+ * Leaderboard_refresh - Follow a grow done by another process (lock held)
+ * @lb: Store
+ *
+ * Returns: 1 if the mapping covers the store's current capacity, 0 if it
+ *          could not be remapped
+ */
+static int Leaderboard_refresh(Leaderboard *lb) {
+  size_t size = Leaderboard_fileSize(Leaderboard_header(lb)->capacity);
+  if (size <= lb->size)
+    return 1;
+  unsigned char *oldMap = lb->map;
+  size_t oldSize = lb->size;
+  if (!Leaderboard_map(lb, size))
+    return 0;
+  munmap(oldMap, oldSize);
+  return 1;
+}
+
+/**
+ * Leaderboard_beginRead / Leaderboard_beginWrite - Lock and refresh
+ * @lb: Store
+ *
+ * Returns: 1 with the lock held, 0 with no lock held
+ */
+static int Leaderboard_beginRead(Leaderboard *lb) {
+  if (!Leaderboard_lock(lb, F_RDLCK))
+    return 0;
+  if (Leaderboard_refresh(lb))
+    return 1;
+  Leaderboard_lock(lb, F_UNLCK);
+  return 0;
+}
+
+static int Leaderboard_beginWrite(Leaderboard *lb) {
+  if (!Leaderboard_lock(lb, F_WRLCK))
+    return 0;
+  if (Leaderboard_refresh(lb))
+    return 1;
+  Leaderboard_lock(lb, F_UNLCK);
+  return 0;
+}
+
+static inline void Leaderboard_end(Leaderboard *lb) {
+  Leaderboard_lock(lb, F_UNLCK);
+}
+
+/**
+ * Leaderboard_grow - Double a full store's capacity
+ * @lb: Store to grow
+ *
+ * Returns: 1 on success, 0 if the file could not be extended or remapped
+ *          (the store is left as it was)
+ *
+ * Records stay where they are; the new index is built past the end of
+ * the old file and flushed before the header switches to it, so a crash
+ * part way leaves a valid store that is merely longer than needed
+ */
+static int Leaderboard_grow(Leaderboard *lb) {
+  uint32_t capacity = Leaderboard_header(lb)->capacity * 2;
+  size_t size = Leaderboard_fileSize(capacity);
+  unsigned char *oldMap = lb->map;
+  size_t oldSize = lb->size;
+
+  if (capacity > LEADERBOARD_MAX_CAPACITY)
+    return 0;
+  if (size > oldSize &&
+      (ftruncate(lb->fd, (off_t)size) != 0 || !Leaderboard_map(lb, size)))
+    return 0;
+  if (lb->map != oldMap)
+    munmap(oldMap, oldSize);
+
+  LeaderboardHeader *h = Leaderboard_header(lb);
+  const LeaderboardSlot *slots = Leaderboard_slots(lb);
+  uint32_t *index = Leaderboard_index(lb, capacity);
+  memset(index, 0, 2 * (size_t)capacity * sizeof(uint32_t));
+  for (uint32_t i = 0; i < h->count; ++i)
+    index[Leaderboard_probe(lb, index, capacity, h->count,
+                            slots[i].username)] = i + 1;
+  msync(lb->map, lb->size, MS_SYNC);
+  h->capacity = capacity;
+  return 1;
+}
+
+/**
+ * Leaderboard_open - Open or create a leaderboard store
+ * @path: Store file (usually LEADERBOARD_STORE_FILE)
+ *
+ * Returns: Store, or NULL if the file cannot be created, mapped or is not
+ *          a leaderboard store
+ */
+Leaderboard *Leaderboard_open(const char *path) {
+  Leaderboard *lb = malloc(sizeof(*lb));
+  if (lb == NULL)
+    return NULL;
+  lb->map = NULL;
+  lb->pendingCount = 0;
+  lb->fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (lb->fd < 0) {
+    free(lb);
+    return NULL;
+  }
+
+  // Exclusive while checking, so two processes cannot both initialize
+  struct stat st;
+  int locked = Leaderboard_lock(lb, F_WRLCK);
+  int ok = locked && fstat(lb->fd, &st) == 0;
+  if (ok && st.st_size == 0) {
+    // New store: header plus an empty index
+    size_t size = Leaderboard_fileSize(LEADERBOARD_MIN_CAPACITY);
+    ok = ftruncate(lb->fd, (off_t)size) == 0 && Leaderboard_map(lb, size);
+    if (ok) {
+      LeaderboardHeader *h = Leaderboard_header(lb);
+      memcpy(h->magic, LEADERBOARD_MAGIC, 8);
+      h->byteOrder = LEADERBOARD_BYTE_ORDER;
+      h->count = 0;
+      h->capacity = LEADERBOARD_MIN_CAPACITY;
+      h->reserved = 0;
+    }
+  } else if (ok) {
+    ok = (size_t)st.st_size >= sizeof(LeaderboardHeader) &&
+         Leaderboard_map(lb, (size_t)st.st_size);
+    if (ok) {
+      const LeaderboardHeader *h = Leaderboard_header(lb);
+      ok = memcmp(h->magic, LEADERBOARD_MAGIC, 8) == 0 &&
+           h->byteOrder == LEADERBOARD_BYTE_ORDER &&
+           h->capacity >= LEADERBOARD_MIN_CAPACITY &&
+           h->capacity <= LEADERBOARD_MAX_CAPACITY &&
+           (h->capacity & (h->capacity - 1)) == 0 &&
+           h->count <= h->capacity &&
+           Leaderboard_fileSize(h->capacity) <= lb->size;
+    }
+  }
+  if (locked)
+    Leaderboard_end(lb);
+
+  if (!ok) {
+    Leaderboard_close(lb);
+    return NULL;
+  }
+  return lb;
+}
+
+/**
+ * Leaderboard_close - Write back pending results, unmap and close a store
+ * @lb: Store to close (NULL is ignored)
+ */
+void Leaderboard_close(Leaderboard *lb) {
+  if (lb == NULL)
+    return;
+  if (lb->map != NULL && lb->pendingCount > 0)
+    Leaderboard_flush(lb);
+  if (lb->map != NULL)
+    munmap(lb->map, lb->size);
+  close(lb->fd);
+  free(lb);
+}
+
+/**
+ * Leaderboard_read - Copy a slot out of the mapping (lock held)
+ * @lb: Store to read
+ * @index: Slot number, below the record count
+ * @record: Filled with the record
+ */
+static void Leaderboard_read(const Leaderboard *lb, uint32_t index,
+                             PlayerRecord *record) {
+  const LeaderboardSlot *slot = &Leaderboard_slots(lb)[index];
+  memcpy(record->username, slot->username, MAX_USERNAME);
+  record->username[MAX_USERNAME - 1] = '\0';
+  record->wins = slot->wins;
+  record->losses = slot->losses;
+  record->draws = slot->draws;
+  record->totalGames = slot->totalGames;
+}
+
+/**
+ * Leaderboard_find - Look up a normalized username (lock held)
+ * @lb: Store to read
+ * @key: Normalized username
+ * @record: Filled with the player's record if found
+ *
+ * Returns: 1 if found, 0 if not
+ */
+static int Leaderboard_find(const Leaderboard *lb, const char *key,
+                            PlayerRecord *record) {
+  const LeaderboardHeader *h = Leaderboard_header(lb);
+  const uint32_t *index = Leaderboard_index(lb, h->capacity);
+  uint32_t v = index[Leaderboard_probe(lb, index, h->capacity, h->count, key)];
+  if (v == 0 || v > h->count)
+    return 0;
+  Leaderboard_read(lb, v - 1, record);
+  return 1;
+}
+
+/**
+ * Leaderboard_pendingFor - A player's entry in the write-back buffer
+ * @lb: Store
+ * @key: Normalized username
+ *
+ * Returns: The entry, or NULL if the player has no pending results
+ */
+static LeaderboardDelta *Leaderboard_pendingFor(Leaderboard *lb,
+                                                const char *key) {
+  for (int i = 0; i < lb->pendingCount; ++i)
+    if (memcmp(lb->pending[i].key, key, MAX_USERNAME) == 0)
+      return &lb->pending[i];
+  return NULL;
+}
+
+/**
+ * Leaderboard_get - Look up a player
+ * @lb: Store to read
+ * @username: Player to find
+ * @record: Filled with the player's record if found
+ *
+ * Returns: 1 if found, 0 if not
+ *
+ * Pending results from Leaderboard_addResult are included
+ */
+int Leaderboard_get(Leaderboard *lb, const char *username,
+                    PlayerRecord *record) {
+  char key[MAX_USERNAME];
+  Leaderboard_key(key, username);
+  if (!Leaderboard_beginRead(lb))
+    return 0;
+  int found = Leaderboard_find(lb, key, record);
+  Leaderboard_end(lb);
+
+  const LeaderboardDelta *d = Leaderboard_pendingFor(lb, key);
+  if (d == NULL)
+    return found;
+  if (!found) {
+    memcpy(record->username, key, MAX_USERNAME);
+    record->wins = record->losses = record->draws = record->totalGames = 0;
+  }
+  record->wins += d->wins;
+  record->losses += d->losses;
+  record->draws += d->draws;
+  record->totalGames += d->wins + d->losses + d->draws;
+  return 1;
+}
+
+/**
+ * Leaderboard_store - Insert or overwrite a record (write lock held)
+ * @lb: Store to update
+ * @key: Normalized username
+ * @record: Counters to store
+ *
+ * Returns: 1 on success, 0 if the store could not be grown
+ *
+ * A new player's slot is written before the index points at it and the
+ * count is raised last, so readers never see a half-written record
+ */
+static int Leaderboard_store(Leaderboard *lb, const char *key,
+                             const PlayerRecord *record) {
+  LeaderboardHeader *h = Leaderboard_header(lb);
+  uint32_t *index = Leaderboard_index(lb, h->capacity);
+  uint32_t b = Leaderboard_probe(lb, index, h->capacity, h->count, key);
+  uint32_t v = index[b];
+  LeaderboardSlot *slot;
+
+  if (v != 0 && v <= h->count) {
+    slot = &Leaderboard_slots(lb)[v - 1];  // Existing player: update in place
+  } else {
+    if (h->count == h->capacity) {
+      if (!Leaderboard_grow(lb))
+        return 0;
+      h = Leaderboard_header(lb);
+      index = Leaderboard_index(lb, h->capacity);
+      b = Leaderboard_probe(lb, index, h->capacity, h->count, key);
+    }
+    slot = &Leaderboard_slots(lb)[h->count];
+    memset(slot, 0, sizeof(*slot));
+    memcpy(slot->username, key, MAX_USERNAME);
+  }
+
+  slot->wins = record->wins;
+  slot->losses = record->losses;
+  slot->draws = record->draws;
+  slot->totalGames = record->totalGames;
+  if (v == 0 || v > h->count) {
+    index[b] = h->count + 1;
+    h->count++;
+  }
+  return 1;
+}
+
+/**
+ * Leaderboard_put - Insert or overwrite a player's record
+ * @lb: Store to update
+ * @record: Record to store, keyed on record->username
+ *
+ * Returns: 1 on success, 0 if the store could not be grown
+ *
+ * Written straight through; pending results for the player are dropped,
+ * since the record replaces them
+ */
+int Leaderboard_put(Leaderboard *lb, const PlayerRecord *record) {
+  char key[MAX_USERNAME];
+  Leaderboard_key(key, record->username);
+  if (!Leaderboard_beginWrite(lb))
+    return 0;
+  int ok = Leaderboard_store(lb, key, record);
+  Leaderboard_end(lb);
+
+  LeaderboardDelta *d = Leaderboard_pendingFor(lb, key);
+  if (ok && d != NULL)
+    *d = lb->pending[--lb->pendingCount];
+  return ok;
+}
+
+/**
+ * Leaderboard_addResult - Record game results for a player
+ * @lb: Store to update
+ * @username: Player the results belong to
+ * @wins: Games won to add
+ * @losses: Games lost to add
+ * @draws: Games drawn to add
+ *
+ * Returns: 1 on success, 0 if a write-back it triggered failed (the
+ *          results stay pending)
+ *
+ * Results are buffered and written back LEADERBOARD_WRITE_BATCH players
+ * at a time, or on Leaderboard_flush/close. The write-back adds to the
+ * counters on file under the lock, so results recorded by other
+ * processes in the meantime are kept
+ */
+int Leaderboard_addResult(Leaderboard *lb, const char *username, int wins,
+                          int losses, int draws) {
+  char key[MAX_USERNAME];
+  Leaderboard_key(key, username);
+  LeaderboardDelta *d = Leaderboard_pendingFor(lb, key);
+  if (d == NULL) {
+    if (lb->pendingCount == LEADERBOARD_WRITE_BATCH && !Leaderboard_flush(lb))
+      return 0;
+    d = &lb->pending[lb->pendingCount++];
+    memcpy(d->key, key, MAX_USERNAME);
+    d->wins = d->losses = d->draws = 0;
+  }
+  d->wins += wins;
+  d->losses += losses;
+  d->draws += draws;
+  return lb->pendingCount < LEADERBOARD_WRITE_BATCH || Leaderboard_flush(lb);
+}
+
+/**
+ * Leaderboard_flush - Write back every pending result
+ * @lb: Store to update
+ *
+ * Returns: 1 on success (or nothing pending), 0 if the store could not be
+ *          locked or grown (unwritten results stay pending)
+ */
+int Leaderboard_flush(Leaderboard *lb) {
+  if (lb->pendingCount == 0)
+    return 1;
+  TRACE_START(t);
+  if (!Leaderboard_beginWrite(lb))
+    return 0;
+
+  int done = 0;
+  while (done < lb->pendingCount) {
+    const LeaderboardDelta *d = &lb->pending[done];
+    PlayerRecord record;
+    if (!Leaderboard_find(lb, d->key, &record))
+      record.wins = record.losses = record.draws = record.totalGames = 0;
+    record.wins += d->wins;
+    record.losses += d->losses;
+    record.draws += d->draws;
+    record.totalGames += d->wins + d->losses + d->draws;
+    if (!Leaderboard_store(lb, d->key, &record))
+      break;
+    done++;
+  }
+  Leaderboard_end(lb);
+
+  // Keep whatever could not be written
+  memmove(lb->pending, lb->pending + done,
+          (size_t)(lb->pendingCount - done) * sizeof(lb->pending[0]));
+  lb->pendingCount -= done;
+  TRACE_END_ARGS(t, "io", "leaderboard write", "\"players\":%d", done);
+  return lb->pendingCount == 0;
+}
+
+/**
+ * Leaderboard_count - Number of players in a store
+ * @lb: Store to query
+ */
+int Leaderboard_count(Leaderboard *lb) {
+  if (!Leaderboard_beginRead(lb))
+    return 0;
+  int count = (int)Leaderboard_header(lb)->count;
+  Leaderboard_end(lb);
+  return count;
+}
+
+/**
+ * Leaderboard_at - Read a record by position
+ * @lb: Store to read
+ * @index: Position in insertion order
+ * @record: Filled with the record
+ *
+ * Returns: 1 on success, 0 if index is out of range
+ */
+int Leaderboard_at(Leaderboard *lb, int index, PlayerRecord *record) {
+  if (index < 0 || !Leaderboard_beginRead(lb))
+    return 0;
+  int ok = (uint32_t)index < Leaderboard_header(lb)->count;
+  if (ok)
+    Leaderboard_read(lb, (uint32_t)index, record);
+  Leaderboard_end(lb);
+  return ok;
+}
+
+/**
+ * Leaderboard_before - Ranking comparison
+ * @order: LEADERBOARD_BY_*
+ * @aw, @ag, @ap: Wins, total games and store position of the first record
+ * @bw, @bg, @bp: The same for the second record
+ *
+ * Returns: 1 if the first record ranks above the second
+ */
+static int Leaderboard_before(int order, int aw, int ag, int ap, int bw,
+                              int bg, int bp) {
+  if (order == LEADERBOARD_BY_WIN_RATE) {
+    // Compare aw / ag with bw / bg exactly; no games counts as a 0% rate
+    long long lhs = (long long)aw * (bg > 0 ? bg : 1);
+    long long rhs = (long long)bw * (ag > 0 ? ag : 1);
+    if (lhs != rhs)
+      return lhs > rhs;
+    if (ag != bg)
+      return ag > bg;
+  } else if (order == LEADERBOARD_BY_GAMES) {
+    if (ag != bg)
+      return ag > bg;
+  } else if (aw != bw) {
+    return aw > bw;
+  }
+  return ap < bp;
+}
+
+/**
+ * Leaderboard_worse - Heap order: 1 if a ranks below b
+ */
+static inline int Leaderboard_worse(int order, const LeaderboardRank *a,
+                                    const LeaderboardRank *b) {
+  return Leaderboard_before(order, b->record.wins, b->record.totalGames,
+                            b->position, a->record.wins,
+                            a->record.totalGames, a->position);
+}
+
+/**
+ * Leaderboard_siftDown - Restore the heap below an entry
+ * @order: LEADERBOARD_BY_*
+ * @heap: Heap with its worst-ranked entry at index 0
+ * @n: Entries in the heap
+ * @i: Entry that may rank above its children
+ */
+static void Leaderboard_siftDown(int order, LeaderboardRank *heap, int n,
+                                 int i) {
+  for (;;) {
+    int worst = i;
+    int l = 2 * i + 1, r = l + 1;
+    if (l < n && Leaderboard_worse(order, &heap[l], &heap[worst]))
+      worst = l;
+    if (r < n && Leaderboard_worse(order, &heap[r], &heap[worst]))
+      worst = r;
+    if (worst == i)
+      return;
+    LeaderboardRank t = heap[i];
+    heap[i] = heap[worst];
+    heap[worst] = t;
+    i = worst;
+  }
+}
+
+/**
+ * Leaderboard_rank - Stream the next page of a ranking
+ * @lb: Store to rank
+ * @order: LEADERBOARD_BY_WINS, LEADERBOARD_BY_WIN_RATE or LEADERBOARD_BY_GAMES
+ * @after: Last entry of the previous page, or NULL for the first page
+ * @out: Filled with up to k entries, best first
+ * @k: Page size
+ *
+ * Returns: Entries written
+ *
+ * @out is used as a heap with the worst kept entry on top: a record
+ * only costs a heap update if it beats that entry, and skipping the
+ * records at or above @after needs no memory for earlier pages
+ */
+int Leaderboard_rank(Leaderboard *lb, int order,
+                     const LeaderboardRank *after, LeaderboardRank *out,
+                     int k) {
+  if (k <= 0 || !Leaderboard_beginRead(lb))
+    return 0;
+  uint32_t count = Leaderboard_header(lb)->count;
+  const LeaderboardSlot *slots = Leaderboard_slots(lb);
+  int n = 0;
+
+  for (uint32_t i = 0; i < count; ++i) {
+    const LeaderboardSlot *s = &slots[i];
+    int position = (int)i;
+    if (after != NULL &&
+        !Leaderboard_before(order, after->record.wins,
+                            after->record.totalGames, after->position,
+                            s->wins, s->totalGames, position))
+      continue;  // On an earlier page
+    if (n == k &&
+        !Leaderboard_before(order, s->wins, s->totalGames, position,
+                            out[0].record.wins, out[0].record.totalGames,
+                            out[0].position))
+      continue;  // Not better than the worst entry kept
+
+    int at = n < k ? n++ : 0;
+    Leaderboard_read(lb, i, &out[at].record);
+    out[at].position = position;
+    if (at == 0) {
+      Leaderboard_siftDown(order, out, n, 0);
+    } else {
+      // Sift the new entry up past better-ranked parents
+      while (at > 0 && Leaderboard_worse(order, &out[at], &out[(at - 1) / 2])) {
+        LeaderboardRank t = out[at];
+        out[at] = out[(at - 1) / 2];
+        out[(at - 1) / 2] = t;
+        at = (at - 1) / 2;
+      }
+    }
+  }
+
+  Leaderboard_end(lb);
+
+  // Heap sort: move the worst entry to the end until the heap is empty
+  for (int m = n - 1; m > 0; --m) {
+    LeaderboardRank t = out[0];
+    out[0] = out[m];
+    out[m] = t;
+    Leaderboard_siftDown(order, out, m, 0);
+  }
+  return n;
+}
+
+/**
+ * Leaderboard_importText - Copy records from the old text leaderboard
+ * @lb: Store to add the records to
+ * @path: Text file with "username wins losses draws totalGames" lines
+ *
+ * Returns: Number of records imported, or -1 if the file cannot be read
+ */
+int Leaderboard_importText(Leaderboard *lb, const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL)
+    return -1;
+
+  PlayerRecord record;
+  char key[MAX_USERNAME];
+  int count = 0;
+  if (!Leaderboard_beginWrite(lb)) {
+    fclose(file);
+    return -1;
+  }
+  while (fscanf(file, "%49s %d %d %d %d", record.username, &record.wins,
+                &record.losses, &record.draws, &record.totalGames) == 5) {
+    Leaderboard_key(key, record.username);
+    if (!Leaderboard_store(lb, key, &record))
+      break;
+    count++;
+  }
+  Leaderboard_end(lb);
+  fclose(file);
+  return count;
+}
@@ -0,0 +1,158 @@
+/*
+ * leaderboard.h
+ *
+ * Indexed leaderboard store header for Tic-Tac-Toe
+ * Keeps player records in a memory-mapped binary file with an on-disk
+ * hash index on username, so lookups and updates never rescan the file
+ */
+
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include "utils.h"
+
+/**
+ * Leaderboard - Binary player record store (opaque)
+ *
+ * File layout (host byte order, checked on open):
+ *   header   - 8-byte magic, byte-order mark, record count, capacity
+ *   records  - capacity fixed-size slots, filled in insertion order
+ *   index    - 2 * capacity hash buckets holding slot number + 1 (0 = empty)
+ *
+ * The index sits after the records, so growing the store only appends a
+ * larger index; existing records never move and the old index stays
+ * valid until the header is switched over
+ *
+ * Every access holds a POSIX lock on the file (shared to read, exclusive
+ * to write) and remaps first if another process grew the store, so
+ * several processes can share one file. Game results are buffered per
+ * player in the handle and written back in batches (see
+ * Leaderboard_addResult)
+ */
+typedef struct Leaderboard Leaderboard;
+
+/* Ranking orders (see Leaderboard_rank) */
+#define LEADERBOARD_BY_WINS 0      // Most wins first
+#define LEADERBOARD_BY_WIN_RATE 1  // Highest wins / totalGames first, then most games
+#define LEADERBOARD_BY_GAMES 2     // Most games played first
+
+/**
+ * LeaderboardRank structure
+ * One record as ranked by Leaderboard_rank
+ */
+typedef struct {
+  PlayerRecord record;  // The player's record
+  int position;         // Store position (see Leaderboard_at), breaks ties
+} LeaderboardRank;
+
+/**
+ * Leaderboard_open - Open or create a leaderboard store
+ * @path: Store file (usually LEADERBOARD_STORE_FILE)
+ *
+ * Returns: Store, or NULL if the file cannot be created, mapped or is not
+ *          a leaderboard store
+ */
+Leaderboard *Leaderboard_open(const char *path);
+
+/**
+ * Leaderboard_close - Write back pending results, unmap and close a store
+ * @lb: Store to close (NULL is ignored)
+ */
+void Leaderboard_close(Leaderboard *lb);
+
+/**
+ * Leaderboard_get - Look up a player
+ * @lb: Store to read
+ * @username: Player to find
+ * @record: Filled with the player's record if found
+ *
+ * Returns: 1 if found, 0 if not. O(1) expected, reads only the mapping.
+ *          Results still pending write-back are included
+ */
+int Leaderboard_get(Leaderboard *lb, const char *username,
+                    PlayerRecord *record);
+
+/**
+ * Leaderboard_put - Insert or overwrite a player's record
+ * @lb: Store to update
+ * @record: Record to store, keyed on record->username
+ *
+ * Returns: 1 on success, 0 if the store could not be grown
+ * Existing players are updated in place; new ones are appended. Written
+ * through at once, replacing any pending results for the player
+ */
+int Leaderboard_put(Leaderboard *lb, const PlayerRecord *record);
+
+/**
+ * Leaderboard_addResult - Record game results for a player
+ * @lb: Store to update
+ * @username: Player the results belong to
+ * @wins: Games won to add
+ * @losses: Games lost to add
+ * @draws: Games drawn to add
+ *
+ * Returns: 1 on success, 0 if a write-back it triggered failed
+ *
+ * Buffered in the handle (dirty until written). Once results for
+ * LEADERBOARD_WRITE_BATCH players are pending, all of them are added to
+ * the file in one locked pass; concurrent updates from other processes
+ * are kept, since counters are added to rather than overwritten
+ */
+int Leaderboard_addResult(Leaderboard *lb, const char *username, int wins,
+                          int losses, int draws);
+
+/**
+ * Leaderboard_flush - Write back every pending result now
+ * @lb: Store to update
+ *
+ * Returns: 1 on success (or nothing pending), 0 on failure (results that
+ *          could not be written stay pending). Leaderboard_close flushes
+ */
+int Leaderboard_flush(Leaderboard *lb);
+
+/**
+ * Leaderboard_count - Number of players in a store
+ * @lb: Store to query
+ */
+int Leaderboard_count(Leaderboard *lb);
+
+/**
+ * Leaderboard_at - Read a record by position
+ * @lb: Store to read
+ * @index: Position in insertion order (0 to Leaderboard_count - 1)
+ * @record: Filled with the record
+ *
+ * Returns: 1 on success, 0 if index is out of range
+ */
+int Leaderboard_at(Leaderboard *lb, int index, PlayerRecord *record);
+
+/**
+ * Leaderboard_rank - Stream the next page of a ranking
+ * @lb: Store to rank
+ * @order: LEADERBOARD_BY_WINS, LEADERBOARD_BY_WIN_RATE or LEADERBOARD_BY_GAMES
+ * @after: Last entry of the previous page, or NULL for the first page
+ * @out: Filled with up to k entries, best first
+ * @k: Page size
+ *
+ * Returns: Entries written (fewer than k on the last page)
+ *
+ * One pass over the records with a k-entry heap kept in @out, so paging
+ * through any number of players needs O(k) memory and O(n log k) time
+ * per page. Ties rank in store order; pending results are not included
+ * until written back (Leaderboard_flush)
+ */
+int Leaderboard_rank(Leaderboard *lb, int order,
+                     const LeaderboardRank *after, LeaderboardRank *out,
+                     int k);
+
+/**
+ * Leaderboard_importText - Copy records from the old text leaderboard
+ * @lb: Store to add the records to
+ * @path: Text file with "username wins losses draws totalGames" lines
+ *
+ * Returns: Number of records imported, or -1 if the file cannot be read
+ * Players already in the store are overwritten by the text version
+ */
+int Leaderboard_importText(Leaderboard *lb, const char *path);
+
+#endif // LEADERBOARD_H
@@ -15,6 +15,12 @@
 
 #include "ai.h"
 #include "game.h"
+#include "engine.h"
+#include "history.h"
+#include "leaderboard.h"
+#include "ponder.h"
+#include "selfplay.h"
+#include "server.h"
 #include "ui.h"
 #include "utils.h"
 #include <time.h>
@@ -26,6 +32,52 @@ void playPlayerVsPlayer(const char *player1, const char *player2,
                         int aiDifficulty);
 void playAIVsAI(int aiDifficulty1, int aiDifficulty2);
 
+/**
+ * Options structure
+ * Settings taken from the command line (see parseOptions)
+ */
+typedef struct {
+  int boardSize;      // Board side N (--size)
+  int winLength;      // Stones in a row to win K (--k)
+  int depthLimit;     // N x N search depth in plies (--depth)
+  int timeBudget;     // N x N milliseconds per AI move, 0 for fixed depth (--time)
+  int selfPlayGames;  // Headless games to play, 0 for the menu (--selfplay)
+  int xDifficulty;    // Self-play X difficulty (--x)
+  int oDifficulty;    // Self-play O difficulty (--o)
+  int threads;        // Self-play games run in parallel (--threads)
+  int useTable;       // 0 after --no-table
+  int useBook;        // 0 after --no-book
+  int binaryStats;    // 1 after --binary-stats: history goes to game_stats.bin
+  int recordGames;    // 1 after --record: self-play games are logged too
+  int ponder;         // 1 after --ponder: the AI searches during the player's turn
+  int seeded;         // 1 after --seed: AI random choices are repeatable
+  unsigned long long seed;  // Seed for the AIs' random generators (--seed)
+  int servePort;      // TCP port to serve games on, 0 for the menu (--serve)
+  int maxSessions;    // Connections the server accepts at once (--max-sessions)
+  int engine;         // 1 after --engine: answer engine commands on stdin
+  const char *solvePath;  // Solved table to write for --size/--k, NULL for the menu (--solve)
+  const char *replayPath; // Replay history to check the AI against, NULL for the menu (--replay)
+} Options;
+
+int parseOptions(int argc, char **argv, Options *opts);
+int runSelfPlay(const Options *opts);
+int runServer(const Options *opts);
+int runEngine(const Options *opts);
+int runSolve(const Options *opts);
+int runReplay(const Options *opts);
+
+/* Transposition table shared by every AI for the whole session */
+static AITable *sessionTable = NULL;
+
+/* Solved table for O(1) answers (NULL falls back to live search) */
+static SolvedTable *sessionBook = NULL;
+
+/* Workers for root-parallel search (NULL on single-core machines) */
+static ThreadPool *sessionPool = NULL;
+
+/* Board and search settings every game of the session uses */
+static Options sessionOptions;
+
 /**
  * main - Program entry point and main menu loop
  * 
@@ -38,20 +90,51 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2);
  * 6. View My Statistics  
  * 7. Exit
  * 
- * Returns: 0 on successful exit
+ * --size N and --k K play every game on an N x N board won by K in a
+ * row. With --selfplay N the menu is skipped and N headless AI vs AI
+ * games are played instead, with --serve PORT games are served over TCP,
+ * with --engine positions are searched for another program, with
+ * --solve PATH the board is solved outright and with --replay PATH
+ * logged games are played back against the AI (see parseOptions,
+ * runSelfPlay, runServer, runEngine, runSolve and runReplay)
+ *
+ * Returns: 0 on successful exit, 1 on a usage error
  */
-int main() {
+int main(int argc, char **argv) {
   int choice = 0;
   int aiVerbose = 2;      // Default: full verbosity (prediction + details)
   int aiDifficulty = 2;   // Default: Hard difficulty
   char username[MAX_USERNAME];
   int menuChoice = 0;
 
+  if (!parseOptions(argc, argv, &sessionOptions))
+    return 1;
+  if (sessionOptions.binaryStats)
+    setGameStatsFormat(HISTORY_FORMAT_BINARY);
+  if (sessionOptions.selfPlayGames > 0)
+    return runSelfPlay(&sessionOptions);
+  if (sessionOptions.servePort > 0)
+    return runServer(&sessionOptions);
+  if (sessionOptions.engine)
+    return runEngine(&sessionOptions);
+  if (sessionOptions.solvePath)
+    return runSolve(&sessionOptions);
+  if (sessionOptions.replayPath)
+    return runReplay(&sessionOptions);
+
   // Display title
   printf("========================================\n");
   printf("   TIC-TAC-TOE AI\n");
   printf("========================================\n\n");
 
+  // One memo table for all games; searches still work if this fails
+  sessionTable = AITable_create(16);
+  // Load the perfect-play table, building and caching it on first start
+  sessionBook = SolvedTable_open(SOLVED_TABLE_FILE);
+  // Spread live searches over every core when there is more than one
+  if (ThreadPool_cpuCount() > 1)
+    sessionPool = ThreadPool_create(ThreadPool_cpuCount());
+
   // Main menu loop
   do {
     printf("\n===== MAIN MENU =====\n");
@@ -193,7 +276,18 @@ int main() {
 
     case 4:
       /* ===== CASE 4: VIEW LEADERBOARD ===== */
-      displayLeaderboard();
+      int order;
+      printf("\nRank players by:\n");
+      printf("  0. Wins\n");
+      printf("  1. Win rate\n");
+      printf("  2. Games played\n");
+      printf("Select (0-2): ");
+      if (scanf("%d", &order) != 1 || order < LEADERBOARD_BY_WINS ||
+          order > LEADERBOARD_BY_GAMES)
+        order = LEADERBOARD_BY_WINS;
+      while (getchar() != '\n')
+        ;
+      displayLeaderboard(order);
       break;
 
     case 5:
@@ -222,6 +316,11 @@ int main() {
 
   } while (menuChoice != 7);
 
+  ThreadPool_destroy(sessionPool);
+  AITable_destroy(sessionTable);
+  SolvedTable_destroy(sessionBook);
+  closeLeaderboard();
+  closeGameStats();
   return 0;
 }
 
@@ -246,10 +345,17 @@ void playGame(int playerStarts, int aiVerbose, int aiDifficulty,
   GameStats matchStats;
 
   // Initialize game components
-  Game_init(&g);
+  Game_initSized(&g, sessionOptions.boardSize, sessionOptions.winLength);
   AI_init(&ai, &g);
   AI_setDifficulty(&ai, aiDifficulty);
   AI_setVerbose(&ai, aiVerbose);
+  AI_setTable(&ai, sessionTable);
+  AI_setSolvedTable(&ai, sessionBook);
+  AI_setThreadPool(&ai, sessionPool);
+  AI_setDepthLimit(&ai, sessionOptions.depthLimit);
+  AI_setTimeBudget(&ai, sessionOptions.timeBudget);
+  if (sessionOptions.seeded)
+    AI_setSeed(&ai, sessionOptions.seed);
 
   // Initialize UI state
   strncpy(uiState.username, username, 63);
@@ -259,6 +365,7 @@ void playGame(int playerStarts, int aiVerbose, int aiDifficulty,
   uiState.aiDifficulty = aiDifficulty;
   strcpy(uiState.aiThought, getAIQuote(aiDifficulty, 4));
   strcpy(uiState.lastAIComment, "");
+  strcpy(uiState.statusMessage, "");
   uiState.candidateCount = 0;
   uiState.aiNodesExplored = 0;
   uiState.aiMaxDepth = 0;
@@ -273,6 +380,7 @@ void playGame(int playerStarts, int aiVerbose, int aiDifficulty,
   matchStats.player2Moves = 0;
   matchStats.aiNodesExplored = 0;
   matchStats.maxDepth = 0;
+  matchStats.player1AI = matchStats.player2AI = (AIStats){0};
   matchStats.winner = 'D';
 
   UI_init();
@@ -280,23 +388,44 @@ void playGame(int playerStarts, int aiVerbose, int aiDifficulty,
   // Determine starting turn (0=player, 1=AI)
   int turn = playerStarts ? 0 : 1;
   int nodes = 0, maxDepth = 0;
+  int analyzedMoves = -1;       // Move count the current analysis belongs to
+  Move aiChoice = {-1, -1};     // Move the AI picked in that analysis
+  Ponder *ponder = NULL;        // Background analysis during the player's turn
+  PonderAnalysis ahead[2];      // Pondered analyses: AI to move, then player
+  int aheadMoves = -1;          // Move count ahead[0] belongs to
+  int aheadCount = 0;           // Entries of ahead that are filled
 
   // Main game loop
   while (1) {
-    // Generate AI analysis if not first turn
-    if (matchStats.totalMoves > 0) {
-      AICandidate cand[9];
-      int candN = AI_explain(&ai, cand, 9);
-      uiState.candidateCount = candN;
-      for (int i = 0; i < candN; i++) {
-        uiState.candidates[i] = cand[i];
+    // Analyze each position once: the same root search fills the candidate
+    // panel and, on the AI's turn, supplies its move (retries after invalid
+    // input reuse it). A position pondered in advance needs no search
+    if ((matchStats.totalMoves > 0 || turn == 1) &&
+        analyzedMoves != matchStats.totalMoves) {
+      int k = matchStats.totalMoves - aheadMoves;
+      if (k >= 0 && k < aheadCount) {
+        AI_addSearch(&ai, &ahead[k].search);
+        AI_setRandomState(&ai, &ahead[k].random);
+        memcpy(uiState.candidates, ahead[k].candidates,
+               sizeof(AICandidate) * ahead[k].candidateCount);
+        uiState.candidateCount = ahead[k].candidateCount;
+        aiChoice = ahead[k].chosen;
+      } else {
+        AICandidate cand[GAME_MAX_CELLS];
+        int candN = AI_analyze(&ai, cand, GAME_MAX_CELLS, &aiChoice);
+        uiState.candidateCount = candN;
+        for (int i = 0; i < candN; i++) {
+          uiState.candidates[i] = cand[i];
+        }
       }
 
       // Get AI stats
-      AI_getStats(&ai, &nodes, &maxDepth);
+      AI_getStats(&ai, &nodes, &maxDepth, NULL, NULL);
       uiState.aiNodesExplored = nodes;
       uiState.aiMaxDepth = maxDepth;
-    } else {
+      analyzedMoves = matchStats.totalMoves;
+    }
+    if (matchStats.totalMoves == 0) {
       // First turn - no analysis needed
       uiState.candidateCount = 0;
       uiState.aiNodesExplored = 0;
@@ -305,7 +434,6 @@ void playGame(int playerStarts, int aiVerbose, int aiDifficulty,
 
     // Draw game state
     UI_drawGame(&g, &uiState, turn == 0);
-    UI_drawGame(&g, &uiState, turn == 0);
 
     // Check win conditions
     int state = g.checkWin(&g);
@@ -336,48 +464,62 @@ void playGame(int playerStarts, int aiVerbose, int aiDifficulty,
 
     if (turn == 0) {
       /* ===== PLAYER TURN ===== */
+      // Search the AI's replies while the player thinks
+      if (sessionOptions.ponder && !ponder)
+        ponder = Ponder_start(&ai, &g, uiState.candidates,
+                              uiState.candidateCount);
+
       int r, c;
       if (!UI_getPlayerInput(&r, &c)) {
-        printf("Invalid input.\n");
+        snprintf(uiState.statusMessage, 255, "Invalid input.");
         continue;
       }
       // Validate move
-      if (r < 0 || r > 2 || c < 0 || c > 2 || g.board[r][c] != ' ') {
+      if (r < 0 || r >= g.size || c < 0 || c >= g.size || g.board[r][c] != ' ') {
         snprintf(uiState.statusMessage, 255,
                  "Invalid move (row: %d, col: %d), try again.", r, c);
         continue;
       }
       // Make move
+      uiState.statusMessage[0] = '\0';
       g.makeMove(&g, r, c, 'X');
       matchStats.player1Moves++;
       matchStats.totalMoves++;
       turn = 1;  // Switch to AI turn
+
+      // Take the reply (and the position after it) from the speculation
+      if (ponder) {
+        aheadCount = Ponder_finish(ponder, r, c, &ahead[0], &ahead[1]);
+        aheadMoves = matchStats.totalMoves;
+        ponder = NULL;
+      }
     } else {
       /* ===== AI TURN ===== */
       snprintf(uiState.aiThought, 255, "%s", getAIQuote(aiDifficulty, 4));
       UI_drawGame(&g, &uiState, 0);
 
-      sleep(1); // Brief pause to show thinking
+      if (!sessionOptions.ponder)
+        sleep(1); // Brief pause to show thinking (pondered replies are instant)
 
-      // Get best move
-      Move m = AI_findBestMove(&ai);
+      // Play the move chosen by this position's analysis
+      Move m = aiChoice;
       g.makeMove(&g, m.row, m.col, 'O');
       snprintf(uiState.lastAIComment, 255, "Placed at (%d, %d)", m.row, m.col);
 
       matchStats.player2Moves++;
       matchStats.totalMoves++;
 
-      // Update AI statistics
-      AI_getStats(&ai, &nodes, &maxDepth);
-      matchStats.aiNodesExplored = nodes;
-      matchStats.maxDepth = maxDepth;
-
       turn = 0;  // Switch to player turn
     }
   }
 
   UI_cleanup();
 
+  // The AI's search totals cover every analysis of the match
+  AI_getSearchStats(&ai, NULL, &matchStats.player2AI);
+  matchStats.aiNodesExplored = (int)matchStats.player2AI.nodes;
+  matchStats.maxDepth = matchStats.player2AI.maxDepth;
+
   // Save game statistics and update leaderboard
   saveGameStats(&matchStats);
   updateLeaderboard(username, matchStats.winner);
@@ -400,10 +542,17 @@ void playPlayerVsPlayer(const char *player1, const char *player2,
   GameStats matchStats;
 
   // Initialize game components
-  Game_init(&g);
+  Game_initSized(&g, sessionOptions.boardSize, sessionOptions.winLength);
   AI_init(&ai, &g);
   AI_setDifficulty(&ai, aiDifficulty);
   AI_setVerbose(&ai, 2);
+  AI_setTable(&ai, sessionTable);
+  AI_setSolvedTable(&ai, sessionBook);
+  AI_setThreadPool(&ai, sessionPool);
+  AI_setDepthLimit(&ai, sessionOptions.depthLimit);
+  AI_setTimeBudget(&ai, sessionOptions.timeBudget);
+  if (sessionOptions.seeded)
+    AI_setSeed(&ai, sessionOptions.seed);
 
   // Initialize UI state
   snprintf(uiState.username, 64, "%s vs %s", player1, player2);
@@ -412,6 +561,7 @@ void playPlayerVsPlayer(const char *player1, const char *player2,
   uiState.aiDifficulty = aiDifficulty;
   strcpy(uiState.aiThought, "Analyzing positions...");
   strcpy(uiState.lastAIComment, "");
+  strcpy(uiState.statusMessage, "");
   uiState.candidateCount = 0;
   uiState.aiNodesExplored = 0;
   uiState.aiMaxDepth = 0;
@@ -426,29 +576,37 @@ void playPlayerVsPlayer(const char *player1, const char *player2,
   matchStats.player2Moves = 0;
   matchStats.aiNodesExplored = 0;
   matchStats.maxDepth = 0;
+  matchStats.player1AI = matchStats.player2AI = (AIStats){0};
   matchStats.winner = 'D';
 
   UI_init();
 
   int turn = 0;  // 0=player1 (X), 1=player2 (O)
   int nodes = 0, maxDepth = 0;
+  int analyzedMoves = -1;  // Move count the current analysis belongs to
+  const char *rejected = "";  // Why the last input was refused, if it was
 
   // Main game loop
   while (1) {
-    // Get AI analysis
-    if (matchStats.totalMoves > 0) {
-      AICandidate cand[9];
-      int candN = AI_explain(&ai, cand, 9);
+    // Get AI analysis (once per position, not again after invalid input);
+    // sessionTable carries each turn's search over to the next
+    if (matchStats.totalMoves > 0 && analyzedMoves != matchStats.totalMoves) {
+      AICandidate cand[GAME_MAX_CELLS];
+      int candN = AI_analyze(&ai, cand, GAME_MAX_CELLS, NULL);
+      analyzedMoves = matchStats.totalMoves;
       uiState.candidateCount = candN;
       for (int i = 0; i < candN; i++) {
         uiState.candidates[i] = cand[i];
       }
-      AI_getStats(&ai, &nodes, &maxDepth);
+      AI_getStats(&ai, &nodes, &maxDepth, NULL, NULL);
       uiState.aiNodesExplored = nodes;
       uiState.aiMaxDepth = maxDepth;
     }
 
-    // Draw game state
+    // Draw game state; the status line names the player to move
+    snprintf(uiState.statusMessage, 255, "%s%s's turn (%c)", rejected,
+             turn == 0 ? player1 : player2, turn == 0 ? 'X' : 'O');
+    rejected = "";
     UI_drawGame(&g, &uiState, 1);
 
     // Check win conditions
@@ -473,18 +631,15 @@ void playPlayerVsPlayer(const char *player1, const char *player2,
     }
 
     // Get current player move
-    printf("\n%s's turn (%c) - Enter move (row col): ",
-           turn == 0 ? player1 : player2, turn == 0 ? 'X' : 'O');
-
     int r, c;
     if (!UI_getPlayerInput(&r, &c)) {
-      printf("Invalid input.\n");
+      rejected = "Invalid input. ";
       continue;
     }
 
     // Validate move
-    if (r < 0 || r > 2 || c < 0 || c > 2 || g.board[r][c] != ' ') {
-      printf("Invalid move. Try again.\n");
+    if (r < 0 || r >= g.size || c < 0 || c >= g.size || g.board[r][c] != ' ') {
+      rejected = "Invalid move. Try again. ";
       continue;
     }
 
@@ -501,6 +656,12 @@ void playPlayerVsPlayer(const char *player1, const char *player2,
 
   UI_cleanup();
 
+  // The analysis AI plays for neither side, so only the match totals
+  AIStats analysis;
+  AI_getSearchStats(&ai, NULL, &analysis);
+  matchStats.aiNodesExplored = (int)analysis.nodes;
+  matchStats.maxDepth = analysis.maxDepth;
+
   // Save game statistics (no leaderboard update for PvP)
   saveGameStats(&matchStats);
 }
@@ -521,14 +682,29 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2) {
   GameStats matchStats;
 
   // Initialize game and both AIs
-  Game_init(&g);
+  Game_initSized(&g, sessionOptions.boardSize, sessionOptions.winLength);
   AI_init(&ai1, &g);
   AI_setDifficulty(&ai1, aiDifficulty1);
   AI_setVerbose(&ai1, 2);
+  AI_setSymbol(&ai1, 'X');
+  AI_setTable(&ai1, sessionTable);
+  AI_setSolvedTable(&ai1, sessionBook);
+  AI_setThreadPool(&ai1, sessionPool);
+  AI_setDepthLimit(&ai1, sessionOptions.depthLimit);
+  AI_setTimeBudget(&ai1, sessionOptions.timeBudget);
+  if (sessionOptions.seeded)
+    AI_setSeed(&ai1, sessionOptions.seed);
 
   AI_init(&ai2, &g);
   AI_setDifficulty(&ai2, aiDifficulty2);
   AI_setVerbose(&ai2, 2);
+  AI_setTable(&ai2, sessionTable);
+  AI_setSolvedTable(&ai2, sessionBook);
+  AI_setThreadPool(&ai2, sessionPool);
+  AI_setDepthLimit(&ai2, sessionOptions.depthLimit);
+  AI_setTimeBudget(&ai2, sessionOptions.timeBudget);
+  if (sessionOptions.seeded)
+    AI_setSeed(&ai2, sessionOptions.seed + 1);
 
   // Initialize UI state
   snprintf(uiState.username, 64, "%s (X) vs %s (O)", getAIName(aiDifficulty1),
@@ -537,6 +713,7 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2) {
   uiState.aiDifficulty = 2;
   strcpy(uiState.aiThought, "Watching AIs compete...");
   strcpy(uiState.lastAIComment, "");
+  strcpy(uiState.statusMessage, "");
   uiState.candidateCount = 0;
   uiState.aiNodesExplored = 0;
   uiState.aiMaxDepth = 0;
@@ -551,6 +728,7 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2) {
   matchStats.player2Moves = 0;
   matchStats.aiNodesExplored = 0;
   matchStats.maxDepth = 0;
+  matchStats.player1AI = matchStats.player2AI = (AIStats){0};
   matchStats.winner = 'D';
 
   UI_init();
@@ -558,7 +736,6 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2) {
   int turn = 0;  // 0=AI1 (X), 1=AI2 (O)
   int step = 1;
   int nodes = 0, maxDepth = 0;
-  int lastWinnerNodes = 0, lastWinnerDepth = 0;
 
   printf("Press Enter to start AI vs AI match...");
   getchar();
@@ -570,8 +747,6 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2) {
     if (state == 1) {
       UI_drawGameOver(&g, &uiState, "AI X WINS!");
       matchStats.winner = 'X';
-      matchStats.aiNodesExplored = lastWinnerNodes;
-      matchStats.maxDepth = lastWinnerDepth;
       printf("\nPress Enter to continue...");
       getchar();
       break;
@@ -579,8 +754,6 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2) {
     if (state == -1) {
       UI_drawGameOver(&g, &uiState, "AI O WINS!");
       matchStats.winner = 'O';
-      matchStats.aiNodesExplored = lastWinnerNodes;
-      matchStats.maxDepth = lastWinnerDepth;
       printf("\nPress Enter to continue...");
       getchar();
       break;
@@ -588,8 +761,6 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2) {
     if (state == 0) {
       UI_drawGameOver(&g, &uiState, "IT'S A DRAW!");
       matchStats.winner = 'D';
-      matchStats.aiNodesExplored = lastWinnerNodes;
-      matchStats.maxDepth = lastWinnerDepth;
       printf("\nPress Enter to continue...");
       getchar();
       break;
@@ -609,15 +780,15 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2) {
     Move m = AI_findBestMove(currentAI);
     
     // Get stats from this move
-    int moveNodes = 0, moveDepth = 0;
-    AI_getStats(currentAI, &moveNodes, &moveDepth);
-    lastWinnerNodes = moveNodes;
-    lastWinnerDepth = moveDepth;
+    AIStats moveStats;
+    AI_getSearchStats(currentAI, &moveStats, NULL);
 
     printf("\n%s chooses position (%d, %d)\n",
            turn == 0 ? getAIName(aiDifficulty1) : getAIName(aiDifficulty2),
            m.row, m.col);
-    printf("  Nodes explored: %d, Max depth: %d\n", moveNodes, moveDepth);
+    printf("  Nodes explored: %lld, Max depth: %d, Time: %.1f ms (%.0f nodes/s)\n",
+           moveStats.nodes, moveStats.maxDepth, moveStats.seconds * 1e3,
+           moveStats.nodesPerSecond);
 
     // Make move
     g.makeMove(&g, m.row, m.col, turn == 0 ? 'X' : 'O');
@@ -634,6 +805,453 @@ void playAIVsAI(int aiDifficulty1, int aiDifficulty2) {
 
   UI_cleanup();
 
+  // Each AI's own search totals, so neither hides the other's work
+  AI_getSearchStats(&ai1, NULL, &matchStats.player1AI);
+  AI_getSearchStats(&ai2, NULL, &matchStats.player2AI);
+  matchStats.aiNodesExplored =
+      (int)(matchStats.player1AI.nodes + matchStats.player2AI.nodes);
+  matchStats.maxDepth = matchStats.player1AI.maxDepth > matchStats.player2AI.maxDepth
+                            ? matchStats.player1AI.maxDepth
+                            : matchStats.player2AI.maxDepth;
+
   // Save game statistics
   saveGameStats(&matchStats);
 }
+
+/**
+ * parseOptions - Read command-line settings
+ * @argc: Argument count from main
+ * @argv: Arguments from main
+ * @opts: Filled with the settings (defaults for anything not given)
+ *
+ * Options:
+ *   --size N       Board side (3-15, default 3)
+ *   --k K          Stones in a row to win (default: 3, at most N and 8)
+ *   --depth D      Plies the AI searches on boards larger than 3x3
+ *   --time MS      Deepen the search until MS milliseconds per move
+ *                  instead (boards larger than 3x3)
+ *   --selfplay N   Play N headless AI vs AI games instead of the menu
+ *   --x D          Difficulty of the X AI (0-2, default 2)
+ *   --o D          Difficulty of the O AI (0-2, default 2)
+ *   --threads T    Games played in parallel (default: one per core)
+ *   --no-table     Search without the transposition table
+ *   --no-book      Search live instead of using the solved table
+ *   --binary-stats Keep game history in game_stats.bin records
+ *   --record       Log every self-play game to the game history, and
+ *                  its moves to game_replays.bin
+ *   --ponder       Let the AI analyse its replies while the player thinks
+ *   --seed S       Seed the AIs' random choices (Easy, Medium) so games
+ *                  can be replayed; self-play picks and prints one if
+ *                  not given
+ *   --serve PORT   Serve player vs AI games over TCP instead of the menu
+ *   --max-sessions N  Connections the server accepts at once (default 4096)
+ *   --engine       Answer engine commands on stdin instead of the menu
+ *   --solve PATH   Solve every position of the --size/--k board (up to
+ *                  4x4) and write the table to PATH
+ *   --replay PATH  Play back every game of a replay history and report
+ *                  where the AI now moves differently
+ *
+ * Returns: 1 on success, 0 after printing usage for a bad argument
+ */
+int parseOptions(int argc, char **argv, Options *opts) {
+  opts->boardSize = GAME_DEFAULT_SIZE;
+  opts->winLength = 3;
+  opts->depthLimit = AI_DEFAULT_DEPTH_LIMIT;
+  opts->timeBudget = 0;
+  opts->selfPlayGames = 0;
+  opts->xDifficulty = 2;
+  opts->oDifficulty = 2;
+  opts->threads = ThreadPool_cpuCount();
+  opts->useTable = 1;
+  opts->useBook = 1;
+  opts->binaryStats = 0;
+  opts->recordGames = 0;
+  opts->ponder = 0;
+  opts->seeded = 0;
+  opts->seed = 0;
+  opts->servePort = 0;
+  opts->maxSessions = SERVER_DEFAULT_SESSIONS;
+  opts->engine = 0;
+  opts->solvePath = NULL;
+  opts->replayPath = NULL;
+
+  int ok = 1, kGiven = 0;
+  for (int i = 1; i < argc && ok; ++i) {
+    if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+      opts->boardSize = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--k") == 0 && i + 1 < argc) {
+      opts->winLength = atoi(argv[++i]);
+      kGiven = 1;
+    } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+      opts->depthLimit = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+      opts->timeBudget = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--selfplay") == 0 && i + 1 < argc) {
+      opts->selfPlayGames = atoi(argv[++i]);
+      ok = opts->selfPlayGames > 0;
+    } else if (strcmp(argv[i], "--x") == 0 && i + 1 < argc) {
+      opts->xDifficulty = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--o") == 0 && i + 1 < argc) {
+      opts->oDifficulty = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      opts->threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--no-table") == 0) {
+      opts->useTable = 0;
+    } else if (strcmp(argv[i], "--no-book") == 0) {
+      opts->useBook = 0;
+    } else if (strcmp(argv[i], "--binary-stats") == 0) {
+      opts->binaryStats = 1;
+    } else if (strcmp(argv[i], "--record") == 0) {
+      opts->recordGames = 1;
+    } else if (strcmp(argv[i], "--ponder") == 0) {
+      opts->ponder = 1;
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      opts->seed = strtoull(argv[++i], NULL, 0);
+      opts->seeded = 1;
+    } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+      opts->servePort = atoi(argv[++i]);
+      ok = opts->servePort > 0 && opts->servePort <= 65535;
+    } else if (strcmp(argv[i], "--max-sessions") == 0 && i + 1 < argc) {
+      opts->maxSessions = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--engine") == 0) {
+      opts->engine = 1;
+    } else if (strcmp(argv[i], "--solve") == 0 && i + 1 < argc) {
+      opts->solvePath = argv[++i];
+    } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      opts->replayPath = argv[++i];
+    } else {
+      ok = 0;
+    }
+  }
+
+  // Gomoku-style default: 5 in a row on boards large enough for it
+  if (!kGiven && opts->boardSize >= 5)
+    opts->winLength = opts->boardSize >= 9 ? 5 : 4;
+
+  if (!ok || opts->boardSize < 3 || opts->boardSize > GAME_MAX_SIZE ||
+      opts->winLength < 3 || opts->winLength > opts->boardSize ||
+      opts->winLength > GAME_MAX_WIN_LENGTH || opts->depthLimit < 1 ||
+      opts->timeBudget < 0 ||
+      opts->xDifficulty < 0 || opts->xDifficulty > 2 ||
+      opts->oDifficulty < 0 || opts->oDifficulty > 2 || opts->threads < 1 ||
+      opts->maxSessions < 1) {
+    fprintf(stderr,
+            "Usage: %s [--size 3-%d] [--k K] [--depth D | --time MS] "
+            "[--binary-stats] [--ponder] [--seed S]\n"
+            "       %s --selfplay N [--x 0-2] [--o 0-2] [--threads T] "
+            "[--no-table] [--no-book] [--size N] [--k K] "
+            "[--depth D | --time MS] [--record [--binary-stats]] "
+            "[--seed S]\n"
+            "       %s --serve PORT [--max-sessions N] [--threads T] "
+            "[--no-table] [--no-book] [--size N] [--k K] "
+            "[--depth D | --time MS] [--binary-stats] [--seed S]\n"
+            "       %s --engine [--threads T] [--no-table] [--no-book] "
+            "[--depth D | --time MS] [--seed S]\n"
+            "       %s --solve PATH [--size 3-%d] [--k K] [--threads T]\n"
+            "       %s --replay PATH [--no-table] [--no-book]\n",
+            argv[0], GAME_MAX_SIZE, argv[0], argv[0], argv[0], argv[0],
+            SOLVED_MAX_SIZE, argv[0]);
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * runSelfPlay - Run a headless batch as configured on the command line
+ * @opts: Parsed options with selfPlayGames > 0
+ *
+ * Returns: 0 (exit status for main)
+ */
+int runSelfPlay(const Options *opts) {
+  SelfPlayConfig config;
+  config.games = opts->selfPlayGames;
+  config.boardSize = opts->boardSize;
+  config.winLength = opts->winLength;
+  config.depthLimit = opts->depthLimit;
+  config.timeBudget = opts->timeBudget;
+  config.xDifficulty = opts->xDifficulty;
+  config.oDifficulty = opts->oDifficulty;
+  config.seed = opts->seeded ? opts->seed : (unsigned long long)time(NULL);
+  SolvedTable *book = opts->useBook ? SolvedTable_open(SOLVED_TABLE_FILE) : NULL;
+  config.table = opts->useTable ? AITable_create(16) : NULL;
+  config.book = book;
+  // Parallelism is across games, so the AIs themselves search serially
+  config.pool = opts->threads > 1 ? ThreadPool_create(opts->threads) : NULL;
+  config.history = NULL;
+  config.replays = NULL;
+  if (opts->recordGames) {
+    int format = opts->binaryStats ? HISTORY_FORMAT_BINARY : HISTORY_FORMAT_TEXT;
+    const char *path = opts->binaryStats ? STATS_BINARY_FILE : STATS_FILE;
+    config.history = GameHistory_open(path, format, HISTORY_DEFAULT_BATCH,
+                                      HISTORY_DEFAULT_FLUSH_MS);
+    if (config.history == NULL)
+      fprintf(stderr, "Error: Could not open %s, games not recorded.\n", path);
+    config.replays = GameHistory_open(REPLAY_FILE, HISTORY_FORMAT_REPLAY,
+                                      HISTORY_DEFAULT_BATCH,
+                                      HISTORY_DEFAULT_FLUSH_MS);
+    if (config.replays == NULL)
+      fprintf(stderr, "Error: Could not open %s, moves not recorded.\n",
+              REPLAY_FILE);
+  }
+
+  SelfPlayResult result;
+  SelfPlay_run(&config, &result);
+  SelfPlay_print(&result);
+
+  GameHistory_close(config.replays);
+  GameHistory_close(config.history);
+  ThreadPool_destroy(config.pool);
+  AITable_destroy(config.table);
+  SolvedTable_destroy(book);
+  return 0;
+}
+
+/**
+ * runServer - Serve games over TCP as configured on the command line
+ * @opts: Parsed options with servePort > 0
+ *
+ * Returns: Server_run's result (exit status for main)
+ *
+ * Results go to the same leaderboard store and game history as the
+ * menu's games, so they show up there too
+ */
+int runServer(const Options *opts) {
+  ServerConfig config;
+  config.port = opts->servePort;
+  config.maxSessions = opts->maxSessions;
+  config.boardSize = opts->boardSize;
+  config.winLength = opts->winLength;
+  config.depthLimit = opts->depthLimit;
+  config.timeBudget = opts->timeBudget;
+  config.seeded = opts->seeded;
+  config.seed = opts->seed;
+  SolvedTable *book = opts->useBook ? SolvedTable_open(SOLVED_TABLE_FILE) : NULL;
+  config.table = opts->useTable ? AITable_create(16) : NULL;
+  config.book = book;
+  // Parallelism is across sessions, so the AIs themselves search serially
+  config.pool = opts->threads > 1 ? ThreadPool_create(opts->threads) : NULL;
+
+  config.leaderboard = Leaderboard_open(LEADERBOARD_STORE_FILE);
+  if (config.leaderboard == NULL)
+    fprintf(stderr, "Error: Could not open %s, results not ranked.\n",
+            LEADERBOARD_STORE_FILE);
+  else if (Leaderboard_count(config.leaderboard) == 0)
+    Leaderboard_importText(config.leaderboard, LEADERBOARD_FILE);
+  int format = opts->binaryStats ? HISTORY_FORMAT_BINARY : HISTORY_FORMAT_TEXT;
+  const char *path = opts->binaryStats ? STATS_BINARY_FILE : STATS_FILE;
+  config.history = GameHistory_open(path, format, HISTORY_DEFAULT_BATCH,
+                                    HISTORY_DEFAULT_FLUSH_MS);
+  if (config.history == NULL)
+    fprintf(stderr, "Error: Could not open %s, games not recorded.\n", path);
+
+  int status = Server_run(&config);
+
+  GameHistory_close(config.history);
+  Leaderboard_close(config.leaderboard);
+  ThreadPool_destroy(config.pool);
+  AITable_destroy(config.table);
+  SolvedTable_destroy(book);
+  return status;
+}
+
+/**
+ * runEngine - Answer engine commands on stdin as configured on the command line
+ * @opts: Parsed options with engine set
+ *
+ * Returns: Engine_run's result (exit status for main)
+ *
+ * --depth, --time and --seed set the defaults the commands start from;
+ * positions give their own board size
+ */
+int runEngine(const Options *opts) {
+  EngineConfig config;
+  config.difficulty = 2;
+  config.depthLimit = opts->depthLimit;
+  config.timeBudget = opts->timeBudget;
+  config.seeded = opts->seeded;
+  config.seed = opts->seed;
+  SolvedTable *book = opts->useBook ? SolvedTable_open(SOLVED_TABLE_FILE) : NULL;
+  config.table = opts->useTable ? AITable_create(16) : NULL;
+  config.book = book;
+  // One search at a time, so the threads split each root instead
+  config.pool = opts->threads > 1 ? ThreadPool_create(opts->threads) : NULL;
+
+  int status = Engine_run(&config, stdin, stdout);
+
+  ThreadPool_destroy(config.pool);
+  AITable_destroy(config.table);
+  SolvedTable_destroy(book);
+  return status;
+}
+
+/**
+ * runSolve - Solve a small board and write its table, as configured on
+ *            the command line
+ * @opts: Parsed options with solvePath set
+ *
+ * Returns: 0 on success, 1 if the board is too large or the table could
+ *          not be built or written (exit status for main)
+ *
+ * A 3x3 table written this way is the SOLVED_TABLE_FILE the game loads
+ */
+int runSolve(const Options *opts) {
+  if (opts->boardSize > SOLVED_MAX_SIZE) {
+    fprintf(stderr, "Error: --solve handles boards up to %dx%d.\n",
+            SOLVED_MAX_SIZE, SOLVED_MAX_SIZE);
+    return 1;
+  }
+  ThreadPool *pool = opts->threads > 1 ? ThreadPool_create(opts->threads) : NULL;
+  struct timespec start, end;
+  timespec_get(&start, TIME_UTC);
+  SolvedTable *table =
+      SolvedTable_solveGrid(opts->boardSize, opts->winLength, pool);
+  timespec_get(&end, TIME_UTC);
+  ThreadPool_destroy(pool);
+  if (table == NULL) {
+    fprintf(stderr, "Error: Not enough memory to solve %dx%d.\n",
+            opts->boardSize, opts->boardSize);
+    return 1;
+  }
+
+  // Scores are from O's point of view, X to move on the empty board
+  int value = SolvedTable_lookup(table, 0, 0, 0, NULL);
+  printf("Solved %dx%d, %d in a row, in %.3f s\n", opts->boardSize,
+         opts->boardSize, opts->winLength,
+         (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+  printf("  Perfect play: %s (score %d)\n",
+         value > 0 ? "O wins" : value < 0 ? "X wins" : "draw", value);
+
+  int ok = SolvedTable_save(table, opts->solvePath);
+  SolvedTable_destroy(table);
+  if (!ok) {
+    fprintf(stderr, "Error: Could not write %s.\n", opts->solvePath);
+    return 1;
+  }
+  printf("  Table written to %s\n", opts->solvePath);
+  return 0;
+}
+
+#define REPLAY_REPORT_MAX 10  // Divergent games listed by --replay
+
+/**
+ * ReplayCheck structure
+ * Running totals of runReplay
+ */
+typedef struct {
+  Game game;
+  AI ai[2];               // Re-run X and O, reused from game to game
+  int games;              // Games read
+  int broken;             // Games with an illegal move or a wrong winner
+  int diverged;           // Games where the AI now picks another move
+  long long aiMoves;      // AI moves re-searched
+  long long changedMoves; // Of those, moves the AI now picks differently
+  long long nodesThen;    // Nodes logged for the AI moves
+  long long nodesNow;     // Nodes the AI searches for them now
+} ReplayCheck;
+
+/**
+ * checkReplay - Play one logged game back against the AI
+ * @replay: Logged game
+ * @when: Time it was logged (unused)
+ * @arg: ReplayCheck totals
+ *
+ * The logged move is always the one played, so the AI sees the same
+ * positions and draws from the same random stream as when it was logged
+ */
+static void checkReplay(const GameReplay *replay, time_t when, void *arg) {
+  ReplayCheck *check = arg;
+  Game *g = &check->game;
+  (void)when;
+  check->games++;
+  if (!GameReplay_play(replay, g)) {
+    check->broken++;
+    return;
+  }
+
+  Game_initSized(g, replay->boardSize, replay->winLength);
+  for (int side = 0; side < 2; ++side) {
+    AI *ai = &check->ai[side];
+    if (replay->difficulty[side] < 0)
+      continue;
+    AI_setDifficulty(ai, replay->difficulty[side]);
+    AI_setDepthLimit(ai, replay->depthLimit);
+    AI_setSeed(ai, replay->seed + (unsigned)side);
+  }
+  int firstChange = -1;
+  for (int i = 0; i < replay->moveCount; ++i) {
+    int side = i & 1;
+    int row = replay->moves[i] / g->size, col = replay->moves[i] % g->size;
+    if (replay->difficulty[side] >= 0) {
+      Move m = AI_findBestMove(&check->ai[side]);
+      int nodes = 0;
+      AI_getStats(&check->ai[side], &nodes, NULL, NULL, NULL);
+      check->aiMoves++;
+      check->nodesThen += replay->nodes[i];
+      check->nodesNow += nodes;
+      if (m.row != row || m.col != col) {
+        check->changedMoves++;
+        if (firstChange < 0)
+          firstChange = i;
+      }
+    }
+    g->makeMove(g, row, col, side ? 'O' : 'X');
+  }
+
+  if (firstChange >= 0 && check->diverged++ < REPLAY_REPORT_MAX)
+    printf("  Game %d (%s vs %s): first new move at ply %d\n", check->games,
+           replay->player1, replay->player2, firstChange + 1);
+}
+
+/**
+ * runReplay - Check the AI against a replay history, as configured on
+ *             the command line
+ * @opts: Parsed options with replayPath set
+ *
+ * Returns: 0 if every game played back, 1 if the file is missing or
+ *          holds broken games (exit status for main)
+ *
+ * Every AI move is searched again with the logged difficulty, depth and
+ * seed. Games logged with --time may differ without any engine change
+ */
+int runReplay(const Options *opts) {
+  ReplayCheck *check = calloc(1, sizeof(*check));
+  if (check == NULL)
+    return 1;
+  SolvedTable *book = opts->useBook ? SolvedTable_open(SOLVED_TABLE_FILE) : NULL;
+  AITable *table = opts->useTable ? AITable_create(16) : NULL;
+  Game_init(&check->game);
+  for (int side = 0; side < 2; ++side) {
+    AI *ai = &check->ai[side];
+    AI_init(ai, &check->game);
+    AI_setVerbose(ai, 0);
+    AI_setSymbol(ai, side ? 'O' : 'X');
+    AI_setTable(ai, table);
+    AI_setSolvedTable(ai, book);
+  }
+
+  struct timespec start, end;
+  timespec_get(&start, TIME_UTC);
+  int read = GameHistory_forEachReplay(opts->replayPath, checkReplay, check);
+  timespec_get(&end, TIME_UTC);
+  double seconds =
+      (double)(end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  int status = 0;
+  if (read < 0) {
+    fprintf(stderr, "Error: %s is not a replay history.\n", opts->replayPath);
+    status = 1;
+  } else {
+    printf("Replay: %d games from %s in %.3f s\n", check->games,
+           opts->replayPath, seconds);
+    printf("  Broken games: %d\n", check->broken);
+    printf("  AI moves: %lld, %lld now different, in %d games\n",
+           check->aiMoves, check->changedMoves, check->diverged);
+    printf("  Nodes: %lld logged, %lld now\n", check->nodesThen,
+           check->nodesNow);
+    status = check->broken > 0;
+  }
+
+  AITable_destroy(table);
+  SolvedTable_destroy(book);
+  free(check);
+  return status;
+}
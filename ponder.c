@@ -0,0 +1,247 @@
+/*
+ * ponder.c
+ *
+ * Background analysis implementation for Tic-Tac-Toe
+ * One thread speculating on the player's move, a line per candidate
+ */
+
+#include "ponder.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * PonderLine structure (internal)
+ * Speculation on one player move
+ */
+typedef struct {
+  int cell;               // Player's move (row * size + col)
+  int stage;              // Analyses finished: 0, 1 (reply) or 2 (follow-up too)
+  int result;             // Ponder_finish return value once stage is 2
+  PonderAnalysis reply;   // After the player's move
+  PonderAnalysis next;    // After the AI's reply
+} PonderLine;
+
+struct Ponder {
+  Game base;              // Position with the player to move
+  Game work;              // Scratch position the thread searches
+  AI ai;                  // Private copy of the caller's AI, searching work
+  AIRandom random;        // Caller's random generator at Ponder_start
+  char human;             // Player's symbol
+
+  pthread_t thread;
+  pthread_mutex_t lock;   // Guards the line stages and the fields below
+  pthread_cond_t wake;    // Signalled when wanted or stop is set
+  pthread_cond_t done;    // Signalled when a line gains a stage
+  PonderLine *wanted;     // Line Ponder_finish is waiting for (searched first)
+  int stop;               // Set by Ponder_finish
+  int count;              // Lines in use
+  PonderLine lines[PONDER_MAX_LINES + 1];  // One spare for an unexpected move
+};
+
+/**
+ * Ponder_pick - Choose the next analysis to run
+ * @p: Ponder (lock held)
+ *
+ * Returns: Line to advance, or NULL if every line is complete
+ *
+ * The line Ponder_finish waits for goes first, then replies in line
+ * order, then follow-ups in line order
+ */
+static PonderLine *Ponder_pick(Ponder *p) {
+  if (p->wanted && p->wanted->stage < 2)
+    return p->wanted;
+  for (int stage = 0; stage < 2; ++stage)
+    for (int i = 0; i < p->count; ++i)
+      if (p->lines[i].stage == stage)
+        return &p->lines[i];
+  return NULL;
+}
+
+/**
+ * Ponder_analyze - Run one analysis on the scratch position
+ * @p: Ponder
+ * @out: Filled with the candidates, choice and search counters
+ */
+static void Ponder_analyze(Ponder *p, PonderAnalysis *out) {
+  AI_resetStats(&p->ai);
+  out->candidateCount =
+      AI_analyze(&p->ai, out->candidates, GAME_MAX_CELLS, &out->chosen);
+  AI_getSearchStats(&p->ai, &out->search, NULL);
+  AI_getRandomState(&p->ai, &out->random);
+}
+
+/**
+ * Ponder_advance - Run the next analysis of a line
+ * @p: Ponder (lock not held; only this thread touches work and ai)
+ * @line: Line to advance (its analyses are not read by others until
+ *        the stage is bumped under the lock)
+ */
+static void Ponder_advance(Ponder *p, PonderLine *line) {
+  int size = p->base.size;
+  p->work = p->base;
+  Game_play(&p->work, line->cell / size, line->cell % size, p->human);
+
+  if (line->stage == 0) {
+    if (Game_state(&p->work) != 2) {
+      line->result = 0;  // The player's move ends the game
+      return;
+    }
+    AI_setRandomState(&p->ai, &p->random);
+    Ponder_analyze(p, &line->reply);
+    line->result = 1;
+    return;
+  }
+
+  Game_play(&p->work, line->reply.chosen.row, line->reply.chosen.col,
+            p->ai.symbol);
+  if (Game_state(&p->work) != 2) {
+    line->result = 1;  // The AI's reply ends the game
+    return;
+  }
+  AI_setRandomState(&p->ai, &line->reply.random);
+  Ponder_analyze(p, &line->next);
+  line->result = 2;
+}
+
+/**
+ * Ponder_main - Thread body: advance lines until stopped
+ * @arg: The Ponder
+ */
+static void *Ponder_main(void *arg) {
+  Ponder *p = arg;
+  pthread_mutex_lock(&p->lock);
+  while (!p->stop) {
+    PonderLine *line = Ponder_pick(p);
+    if (!line) {
+      pthread_cond_wait(&p->wake, &p->lock);
+      continue;
+    }
+    pthread_mutex_unlock(&p->lock);
+    Ponder_advance(p, line);
+    pthread_mutex_lock(&p->lock);
+    // A move that ends the game has nothing more to search
+    line->stage = (line->stage == 0 && line->result == 0) ? 2 : line->stage + 1;
+    pthread_cond_broadcast(&p->done);
+  }
+  pthread_mutex_unlock(&p->lock);
+  return NULL;
+}
+
+/**
+ * Ponder_addLine - Queue a player move unless already queued
+ * @p: Ponder (lock held, or thread not started)
+ * @cell: Player's move
+ *
+ * Returns: The move's line, or NULL if the lines are full
+ */
+static PonderLine *Ponder_addLine(Ponder *p, int cell) {
+  for (int i = 0; i < p->count; ++i)
+    if (p->lines[i].cell == cell)
+      return &p->lines[i];
+  if (p->count == PONDER_MAX_LINES + 1)
+    return NULL;
+  PonderLine *line = &p->lines[p->count++];
+  line->cell = cell;
+  line->stage = 0;
+  line->result = 0;
+  return line;
+}
+
+/**
+ * Ponder_start - Begin analysing replies to the player's next move
+ * @ai: AI whose settings the analysis copies
+ * @game: Position with the player to move
+ * @hint: Candidates of the current position (may be NULL)
+ * @hintCount: Number of hint candidates
+ *
+ * Returns: Running ponder, or NULL if allocation or the thread failed
+ */
+Ponder *Ponder_start(const AI *ai, const Game *game, const AICandidate *hint,
+                     int hintCount) {
+  Ponder *p = malloc(sizeof(*p));
+  if (!p)
+    return NULL;
+  p->base = *game;
+  p->ai = *ai;
+  p->ai.game = &p->work;
+  p->ai.verbose = 0;
+  AI_getRandomState(ai, &p->random);
+  p->human = (ai->symbol == 'O') ? 'X' : 'O';
+  p->wanted = NULL;
+  p->stop = 0;
+  p->count = 0;
+
+  // Hinted moves by descending score (insertion sort, at most a board)
+  int size = game->size;
+  int order[GAME_MAX_CELLS];
+  int n = 0;
+  for (int i = 0; hint && i < hintCount && i < GAME_MAX_CELLS; ++i) {
+    int j = n++;
+    for (; j > 0 && hint[order[j - 1]].score < hint[i].score; --j)
+      order[j] = order[j - 1];
+    order[j] = i;
+  }
+  for (int i = 0; i < n && p->count < PONDER_MAX_LINES; ++i)
+    if (game->board[hint[order[i]].row][hint[order[i]].col] == ' ')
+      Ponder_addLine(p, hint[order[i]].row * size + hint[order[i]].col);
+
+  // Then empty cells in rings around the centre
+  int mid = (size - 1) / 2;
+  for (int ring = 0; ring <= mid + 1 && p->count < PONDER_MAX_LINES; ++ring)
+    for (int r = 0; r < size && p->count < PONDER_MAX_LINES; ++r)
+      for (int c = 0; c < size && p->count < PONDER_MAX_LINES; ++c) {
+        int dr = abs(r - mid), dc = abs(c - mid);
+        if ((dr > dc ? dr : dc) == ring && game->board[r][c] == ' ')
+          Ponder_addLine(p, r * size + c);
+      }
+
+  pthread_mutex_init(&p->lock, NULL);
+  pthread_cond_init(&p->wake, NULL);
+  pthread_cond_init(&p->done, NULL);
+  if (pthread_create(&p->thread, NULL, Ponder_main, p) != 0) {
+    pthread_cond_destroy(&p->done);
+    pthread_cond_destroy(&p->wake);
+    pthread_mutex_destroy(&p->lock);
+    free(p);
+    return NULL;
+  }
+  return p;
+}
+
+/**
+ * Ponder_finish - Collect the analysis for the move the player made
+ * @p: Ponder from Ponder_start (freed)
+ * @row: Row the player played
+ * @col: Column the player played
+ * @reply: Filled with the analysis after the player's move
+ * @next: Filled with the analysis after the AI's reply
+ *
+ * Returns: 0, 1 or 2: how many of @reply and @next were filled
+ */
+int Ponder_finish(Ponder *p, int row, int col, PonderAnalysis *reply,
+                  PonderAnalysis *next) {
+  pthread_mutex_lock(&p->lock);
+  // The spare slot guarantees room for a move outside the speculation
+  PonderLine *line = Ponder_addLine(p, row * p->base.size + col);
+  p->wanted = line;
+  pthread_cond_signal(&p->wake);
+  while (line->stage < 2)
+    pthread_cond_wait(&p->done, &p->lock);
+  p->stop = 1;
+  pthread_cond_signal(&p->wake);
+  pthread_mutex_unlock(&p->lock);
+  pthread_join(p->thread, NULL);
+
+  int result = line->result;
+  if (result >= 1)
+    *reply = line->reply;
+  if (result == 2)
+    *next = line->next;
+
+  pthread_cond_destroy(&p->done);
+  pthread_cond_destroy(&p->wake);
+  pthread_mutex_destroy(&p->lock);
+  free(p);
+  return result;
+}
@@ -0,0 +1,83 @@
+/*
+ * ponder.h
+ *
+ * Background analysis header for Tic-Tac-Toe
+ * Searches the AI's replies to the player's possible moves while the
+ * player is still thinking, so the AI can answer as soon as a move is in
+ */
+
+#ifndef PONDER_H
+#define PONDER_H
+
+#include "ai.h"
+#include "game.h"
+
+#define PONDER_MAX_LINES 24  // Player moves speculated on per position
+
+/**
+ * Ponder - Speculative search running on its own thread (opaque)
+ *
+ * For each likely player move it runs the AI's analysis of the position
+ * after that move (the reply), then the analysis of the position after
+ * the reply (what the candidate panel shows on the player's next turn).
+ * Replies to every line come first, follow-ups after. The thread works
+ * on its own copies of the game and the AI, sharing only the AI's
+ * transposition table, solved table and thread pool
+ */
+typedef struct Ponder Ponder;
+
+/**
+ * PonderAnalysis structure
+ * One analysis as AI_analyze would have returned it
+ */
+typedef struct {
+  AICandidate candidates[GAME_MAX_CELLS];  // Scored candidates, row-major
+  int candidateCount;                      // AI_analyze's return value
+  Move chosen;                             // Move the AI plays there
+  AIStats search;                          // Counters of that search
+  AIRandom random;                         // AI's random generator after it
+} PonderAnalysis;
+
+/**
+ * Ponder_start - Begin analysing replies to the player's next move
+ * @ai: AI whose settings the analysis copies (difficulty, symbol, tables,
+ *      depth, time budget); the thread never touches it
+ * @game: Position with the player to move (copied)
+ * @hint: Candidates of the current position, used to order the lines
+ *        (may be NULL)
+ * @hintCount: Number of hint candidates
+ *
+ * Returns: Running ponder, or NULL if the thread could not be started
+ *
+ * Hinted cells are tried in descending score order, then the remaining
+ * empty cells nearest the centre, up to PONDER_MAX_LINES lines. The
+ * caller must not search with the same thread pool from another thread
+ * nor change @ai's tables until Ponder_finish
+ */
+Ponder *Ponder_start(const AI *ai, const Game *game, const AICandidate *hint,
+                     int hintCount);
+
+/**
+ * Ponder_finish - Collect the analysis for the move the player made
+ * @p: Ponder from Ponder_start (freed)
+ * @row: Row the player played (must have been empty)
+ * @col: Column the player played
+ * @reply: Filled with the analysis after the player's move
+ * @next: Filled with the analysis after the AI's reply
+ *
+ * Returns: 0 if the player's move ended the game (nothing filled), 1 if
+ *          the AI's reply ends it (only @reply filled), 2 if both are
+ *          filled
+ *
+ * Waits until that line is searched; a move that was not being
+ * speculated on is searched next. The thread is then stopped
+ *
+ * Every reply starts from the random generator the AI had at
+ * Ponder_start and the follow-up continues from there, so Easy and
+ * Medium pick what they would have picked without pondering as long as
+ * the caller adopts the analysis's random state (AI_setRandomState)
+ */
+int Ponder_finish(Ponder *p, int row, int col, PonderAnalysis *reply,
+                  PonderAnalysis *next);
+
+#endif // PONDER_H
@@ -0,0 +1,233 @@
+/*
+ * selfplay.c
+ *
+ * Headless self-play implementation for Tic-Tac-Toe
+ * Runs AI vs AI batches and reports aggregate results
+ */
+
+#include "selfplay.h"
+#include "game.h"
+#include "utils.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * SelfPlay_now - Wall-clock time in seconds
+ */
+static double SelfPlay_now(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * SelfPlayWorker structure (internal)
+ * Board, players and partial totals owned by one pool worker
+ */
+typedef struct {
+  Game game;
+  AI x;
+  AI o;
+  int xWins, oWins, draws;
+  long long nodes;
+  GameReplay replay;  // Moves of the game being played
+} SelfPlayWorker;
+
+/**
+ * SelfPlayBatch structure (internal)
+ * Shared state of one SelfPlay_run call
+ */
+typedef struct {
+  const SelfPlayConfig *config;
+  SelfPlayWorker workers[THREADPOOL_MAX_THREADS];
+} SelfPlayBatch;
+
+/**
+ * SelfPlay_initWorker - Reset a worker's totals and build its AIs
+ * @w: Worker to set up
+ * @config: Batch settings and shared resources
+ */
+static void SelfPlay_initWorker(SelfPlayWorker *w,
+                                const SelfPlayConfig *config) {
+  Game_initSized(&w->game, config->boardSize, config->winLength);
+  AI_init(&w->x, &w->game);
+  AI_setDifficulty(&w->x, config->xDifficulty);
+  AI_setVerbose(&w->x, 0);
+  AI_setSymbol(&w->x, 'X');
+  AI_setTable(&w->x, config->table);
+  AI_setSolvedTable(&w->x, config->book);
+  AI_setDepthLimit(&w->x, config->depthLimit);
+  AI_setTimeBudget(&w->x, config->timeBudget);
+
+  AI_init(&w->o, &w->game);
+  AI_setDifficulty(&w->o, config->oDifficulty);
+  AI_setVerbose(&w->o, 0);
+  AI_setTable(&w->o, config->table);
+  AI_setSolvedTable(&w->o, config->book);
+  AI_setDepthLimit(&w->o, config->depthLimit);
+  AI_setTimeBudget(&w->o, config->timeBudget);
+
+  w->xWins = w->oWins = w->draws = 0;
+  w->nodes = 0;
+}
+
+/**
+ * SelfPlay_record - Log a finished game to the batch's history sink
+ * @config: Batch settings, config->history is the sink
+ * @w: Worker that played the game (its AI totals cover just this game)
+ * @moves: Moves made by X and O
+ * @state: Final checkWin result (1=X won, -1=O won, 0=draw)
+ */
+static void SelfPlay_record(const SelfPlayConfig *config,
+                            const SelfPlayWorker *w, const int moves[2],
+                            int state) {
+  GameStats stats;
+  AIStats xTotal, oTotal;
+  AI_getSearchStats(&w->x, NULL, &xTotal);
+  AI_getSearchStats(&w->o, NULL, &oTotal);
+
+  memset(&stats, 0, sizeof(stats));
+  snprintf(stats.player1, MAX_USERNAME, "%s (X)", getAIName(config->xDifficulty));
+  snprintf(stats.player2, MAX_USERNAME, "%s (O)", getAIName(config->oDifficulty));
+  stats.player1Moves = moves[0];
+  stats.player2Moves = moves[1];
+  stats.totalMoves = moves[0] + moves[1];
+  stats.aiNodesExplored = (int)(xTotal.nodes + oTotal.nodes);
+  stats.maxDepth = xTotal.maxDepth > oTotal.maxDepth ? xTotal.maxDepth
+                                                     : oTotal.maxDepth;
+  stats.player1AI = xTotal;
+  stats.player2AI = oTotal;
+  stats.winner = state == 1 ? 'X' : state == -1 ? 'O' : 'D';
+  GameHistory_append(config->history, &stats);
+}
+
+/**
+ * SelfPlay_recordReplay - Log a finished game's moves to the replay sink
+ * @config: Batch settings, config->replays is the sink
+ * @w: Worker that played the game (w->replay holds its moves)
+ * @seed: Seed X's AI was given (O's was seed + 1)
+ * @state: Final checkWin result (1=X won, -1=O won, 0=draw)
+ */
+static void SelfPlay_recordReplay(const SelfPlayConfig *config,
+                                  SelfPlayWorker *w, unsigned long long seed,
+                                  int state) {
+  GameReplay *r = &w->replay;
+  snprintf(r->player1, MAX_USERNAME, "%s (X)", getAIName(config->xDifficulty));
+  snprintf(r->player2, MAX_USERNAME, "%s (O)", getAIName(config->oDifficulty));
+  r->boardSize = w->game.size;
+  r->winLength = w->game.winLength;
+  r->depthLimit = config->depthLimit;
+  r->difficulty[0] = config->xDifficulty;
+  r->difficulty[1] = config->oDifficulty;
+  r->seed = seed;
+  r->winner = state == 1 ? 'X' : state == -1 ? 'O' : 'D';
+  GameHistory_appendReplay(config->replays, r);
+}
+
+/**
+ * SelfPlay_playGame - Play one game to the end (pool task)
+ * @arg: SelfPlayBatch being run
+ * @index: Game number, selects the AIs' random streams
+ * @worker: Pool worker index, selects the board and AIs to use
+ */
+static void SelfPlay_playGame(void *arg, int index, int worker) {
+  SelfPlayBatch *batch = arg;
+  SelfPlayWorker *w = &batch->workers[worker];
+  Game *g = &w->game;
+  unsigned long long seed = batch->config->seed + 2ull * (unsigned)index;
+
+  Game_initSized(g, batch->config->boardSize, batch->config->winLength);
+  AI_resetStats(&w->x);  // Totals then cover this game only
+  AI_resetStats(&w->o);
+  AI_setSeed(&w->x, seed);
+  AI_setSeed(&w->o, seed + 1);
+  int moves[2] = {0, 0};
+  int turn = 0;  // 0=X, 1=O
+  int state;
+  while ((state = Game_state(g)) == 2) {
+    AI *current = turn == 0 ? &w->x : &w->o;
+    Move m = AI_findBestMove(current);
+    int nodes = 0;
+    AI_getStats(current, &nodes, NULL, NULL, NULL);
+    w->nodes += nodes;
+    w->replay.moves[moves[0] + moves[1]] = (unsigned char)(m.row * g->size + m.col);
+    w->replay.nodes[moves[0] + moves[1]] = (unsigned)nodes;
+    Game_play(g, m.row, m.col, turn == 0 ? 'X' : 'O');
+    moves[turn]++;
+    turn = 1 - turn;
+  }
+
+  if (batch->config->history != NULL)
+    SelfPlay_record(batch->config, w, moves, state);
+  if (batch->config->replays != NULL) {
+    w->replay.moveCount = moves[0] + moves[1];
+    SelfPlay_recordReplay(batch->config, w, seed, state);
+  }
+
+  if (state == 1)
+    w->xWins++;
+  else if (state == -1)
+    w->oWins++;
+  else
+    w->draws++;
+}
+
+/**
+ * SelfPlay_run - Play a batch of headless AI vs AI games
+ * @config: Batch to play
+ * @result: Filled with the batch totals
+ */
+void SelfPlay_run(const SelfPlayConfig *config, SelfPlayResult *result) {
+  SelfPlayBatch batch;
+  int workers = ThreadPool_size(config->pool);
+
+  batch.config = config;
+  for (int i = 0; i < workers; ++i)
+    SelfPlay_initWorker(&batch.workers[i], config);
+
+  double start = SelfPlay_now();
+  ThreadPool_run(config->pool, SelfPlay_playGame, &batch, config->games);
+  result->seconds = SelfPlay_now() - start;
+
+  result->games = config->games;
+  result->boardSize = batch.workers[0].game.size;
+  result->winLength = batch.workers[0].game.winLength;
+  result->xDifficulty = config->xDifficulty;
+  result->oDifficulty = config->oDifficulty;
+  result->seed = config->seed;
+  result->xWins = result->oWins = result->draws = 0;
+  result->nodes = 0;
+  for (int i = 0; i < workers; ++i) {
+    result->xWins += batch.workers[i].xWins;
+    result->oWins += batch.workers[i].oWins;
+    result->draws += batch.workers[i].draws;
+    result->nodes += batch.workers[i].nodes;
+  }
+}
+
+/**
+ * SelfPlay_print - Print a batch summary to stdout
+ * @result: Totals from SelfPlay_run
+ */
+void SelfPlay_print(const SelfPlayResult *result) {
+  double n = result->games > 0 ? result->games : 1;
+
+  printf("Self-play: %d games on %dx%d (%d in a row), %s (X, %d) vs %s (O, %d)\n",
+         result->games, result->boardSize, result->boardSize,
+         result->winLength, getAIName(result->xDifficulty),
+         result->xDifficulty, getAIName(result->oDifficulty),
+         result->oDifficulty);
+  printf("  X wins: %6d (%5.1f%%)\n", result->xWins,
+         100.0 * result->xWins / n);
+  printf("  O wins: %6d (%5.1f%%)\n", result->oWins,
+         100.0 * result->oWins / n);
+  printf("  Draws:  %6d (%5.1f%%)\n", result->draws,
+         100.0 * result->draws / n);
+  printf("  Nodes searched: %lld (%.1f per game)\n", result->nodes,
+         result->nodes / n);
+  printf("  Time: %.3f s (%.0f games/sec)\n", result->seconds,
+         result->seconds > 0 ? result->games / result->seconds : 0.0);
+  printf("  Seed: %llu\n", result->seed);
+}
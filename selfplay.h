@@ -0,0 +1,78 @@
+/*
+ * selfplay.h
+ *
+ * Headless self-play header for Tic-Tac-Toe
+ * Plays AI vs AI matches back to back with no UI or delays, and no file
+ * output unless a history sink is given, so engine changes can be
+ * measured over thousands of games
+ */
+
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+#include "ai.h"
+#include "history.h"
+#include "threadpool.h"
+
+/**
+ * SelfPlayConfig structure
+ * What to play in one batch and the shared resources to play it with
+ */
+typedef struct {
+  int games;                // Games to play
+  int boardSize;            // Board side N
+  int winLength;            // Stones in a row to win K
+  int depthLimit;           // AI search depth on boards larger than 3x3
+  int timeBudget;           // AI milliseconds per move there instead (0 = depth)
+  int xDifficulty;          // Difficulty of the X AI (0=Easy, 1=Medium, 2=Hard)
+  int oDifficulty;          // Difficulty of the O AI
+  AITable *table;           // Transposition table shared by all AIs (NULL for none)
+  const SolvedTable *book;  // Solved table shared by all AIs (NULL for live search)
+  ThreadPool *pool;         // Workers to spread games over (NULL = calling thread)
+  GameHistory *history;     // Sink every finished game is logged to (NULL = none)
+  GameHistory *replays;     // Replay sink for every game's moves (NULL = none)
+  unsigned long long seed;  // Game i seeds X with seed + 2i and O with seed + 2i + 1
+} SelfPlayConfig;
+
+/**
+ * SelfPlayResult structure
+ * Aggregate outcome of one batch of AI vs AI games
+ */
+typedef struct {
+  int games;           // Games played
+  int boardSize;       // Board side N
+  int winLength;       // Stones in a row to win K
+  int xDifficulty;     // Difficulty of the AI playing X (moves first)
+  int oDifficulty;     // Difficulty of the AI playing O
+  int xWins;           // Games won by X
+  int oWins;           // Games won by O
+  int draws;           // Drawn games
+  long long nodes;     // Nodes searched by both AIs over the whole batch
+  double seconds;      // Wall-clock time of the batch
+  unsigned long long seed;  // config->seed, to replay the batch
+} SelfPlayResult;
+
+/**
+ * SelfPlay_run - Play a batch of headless AI vs AI games
+ * @config: Batch to play
+ * @result: Filled with the batch totals
+ *
+ * Each worker builds its own board and pair of AIs once and reuses them,
+ * so only the board is reset between games. Games are handed out by the
+ * pool's range stealing, so a worker stuck on slow games does not hold
+ * up the batch; all workers share the table and book. Random choices
+ * depend only on the seed and the game number, so a batch with the same
+ * seed replays exactly whatever the thread count (fixed-depth searches)
+ */
+void SelfPlay_run(const SelfPlayConfig *config, SelfPlayResult *result);
+
+/**
+ * SelfPlay_print - Print a batch summary to stdout
+ * @result: Totals from SelfPlay_run
+ *
+ * Shows win/draw rates, total nodes, throughput in games per second
+ * and the seed
+ */
+void SelfPlay_print(const SelfPlayResult *result);
+
+#endif // SELFPLAY_H
@@ -0,0 +1,695 @@
+/*
+ * server.c
+ *
+ * Network game server implementation for Tic-Tac-Toe
+ * One epoll loop owns the sockets and sessions; a dispatcher thread
+ * hands queued AI moves to the thread pool in batches
+ */
+
+#define _POSIX_C_SOURCE 200809L  // sigaction, MSG_NOSIGNAL
+
+#include "server.h"
+#include "game.h"
+#include "utils.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SERVER_OUT_MAX 4096     // Replies buffered per session while the socket is full
+#define SERVER_EVENTS 256       // Events taken per epoll_wait
+#define SERVER_BATCH 256        // AI moves handed to the pool per ThreadPool_run
+#define SERVER_TICK_MS 1000     // Longest wait between leaderboard/history flushes
+
+/* Session states */
+#define SERVER_IDLE 0      // Connected, no game in progress
+#define SERVER_PLAYER 1    // Waiting for the player's MOVE
+#define SERVER_THINKING 2  // AI move queued or being searched
+#define SERVER_CLOSING 3   // Socket closed while thinking, freed when the move returns
+
+/**
+ * ServerSession structure (internal)
+ * One connection and the game played on it; a slot of the session arena
+ */
+typedef struct ServerSession ServerSession;
+struct ServerSession {
+  int fd;                      // Client socket, -1 once closed
+  int state;                   // SERVER_IDLE, _PLAYER, _THINKING or _CLOSING
+  int writing;                 // 1 while EPOLLOUT is armed for pending output
+  Game game;
+  AI ai;                       // Plays O on game
+  GameStats stats;             // Record of the current game
+  Move reply;                  // AI move, written by a pool worker
+  int inLen;
+  int outLen;
+  char in[SERVER_LINE_MAX];    // Partial command line
+  char out[SERVER_OUT_MAX];    // Replies not yet sent
+  ServerSession *next;         // Free, job queue, done or closed list link
+};
+
+/**
+ * Server structure (internal)
+ * State of one Server_run call
+ */
+typedef struct {
+  const ServerConfig *config;
+  int epollFd;
+  int listenFd;
+  int wakeFd;                  // eventfd the dispatcher bumps when moves are done
+  ServerSession *sessions;     // Arena of config->maxSessions slots
+  ServerSession *free;         // Unused slots
+  ServerSession *closed;       // Slots released this loop pass, freed after it
+  int active;                  // Slots in use
+  long long games;             // Games finished
+  unsigned long long started;  // Games started (seed offset)
+
+  pthread_t dispatcher;
+  pthread_mutex_t lock;        // Guards the fields below
+  pthread_cond_t wake;         // Signalled when a move is queued or stop is set
+  ServerSession *queueHead;    // Sessions waiting for an AI move, oldest first
+  ServerSession *queueTail;
+  ServerSession *done;         // Sessions whose move is ready
+  int stop;
+} Server;
+
+/* Set by the signal handler to end Server_run */
+static volatile sig_atomic_t g_serverStop = 0;
+
+/**
+ * Server_onSignal - SIGINT/SIGTERM handler
+ * @sig: Signal number (unused)
+ */
+static void Server_onSignal(int sig) {
+  (void)sig;
+  g_serverStop = 1;
+}
+
+/**
+ * Server_now - Monotonic time in milliseconds
+ */
+static long long Server_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Server_think - Search one session's AI move (pool task)
+ * @arg: Batch of sessions
+ * @index: Session in the batch
+ * @worker: Pool worker index (unused)
+ */
+static void Server_think(void *arg, int index, int worker) {
+  ServerSession **batch = arg;
+  (void)worker;
+  batch[index]->reply = AI_findBestMove(&batch[index]->ai);
+}
+
+/**
+ * Server_dispatch - Dispatcher thread body: search queued moves in batches
+ * @arg: The Server
+ *
+ * Only this thread runs the pool, so every search of a batch proceeds in
+ * parallel while the loop thread keeps serving sockets
+ */
+static void *Server_dispatch(void *arg) {
+  Server *sv = arg;
+  ServerSession *batch[SERVER_BATCH];
+  pthread_mutex_lock(&sv->lock);
+  while (!sv->stop) {
+    if (!sv->queueHead) {
+      pthread_cond_wait(&sv->wake, &sv->lock);
+      continue;
+    }
+    int n = 0;
+    while (sv->queueHead && n < SERVER_BATCH) {
+      batch[n++] = sv->queueHead;
+      sv->queueHead = sv->queueHead->next;
+    }
+    if (!sv->queueHead)
+      sv->queueTail = NULL;
+    pthread_mutex_unlock(&sv->lock);
+
+    ThreadPool_run(sv->config->pool, Server_think, batch, n);
+
+    pthread_mutex_lock(&sv->lock);
+    for (int i = 0; i < n; ++i) {
+      batch[i]->next = sv->done;
+      sv->done = batch[i];
+    }
+    uint64_t one = 1;
+    if (write(sv->wakeFd, &one, sizeof(one)) < 0)
+      perror("server: eventfd");
+  }
+  pthread_mutex_unlock(&sv->lock);
+  return NULL;
+}
+
+/**
+ * Server_send - Queue a reply line for a session
+ * @s: Session
+ * @fmt: printf format of the line, without the '\n'
+ *
+ * A session whose client stops reading fills its buffer and is dropped
+ * (see Server_flush)
+ */
+static void Server_send(ServerSession *s, const char *fmt, ...) {
+  if (s->outLen < 0)
+    return;
+  va_list args;
+  va_start(args, fmt);
+  int room = SERVER_OUT_MAX - s->outLen;
+  int len = vsnprintf(s->out + s->outLen, room, fmt, args);
+  va_end(args);
+  if (len < 0 || len + 1 >= room) {
+    s->outLen = -1;  // Overflow: Server_flush closes the connection
+    return;
+  }
+  s->outLen += len;
+  s->out[s->outLen++] = '\n';
+}
+
+/**
+ * Server_sendBoard - Queue a BOARD line with the session's position
+ * @s: Session
+ */
+static void Server_sendBoard(ServerSession *s) {
+  char cells[GAME_MAX_CELLS + 1];
+  int size = s->game.size, n = 0;
+  for (int r = 0; r < size; ++r)
+    for (int c = 0; c < size; ++c)
+      cells[n++] = s->game.board[r][c] == ' ' ? '.' : s->game.board[r][c];
+  cells[n] = '\0';
+  Server_send(s, "BOARD %s", cells);
+}
+
+/**
+ * Server_close - Close a session's connection and release its slot
+ * @sv: Server
+ * @s: Session (its fd must still be open)
+ *
+ * A session whose move is being searched stays allocated until the move
+ * comes back. Released slots are reused only after the current loop pass,
+ * so later events of the same epoll_wait never see a recycled slot
+ */
+static void Server_close(Server *sv, ServerSession *s) {
+  close(s->fd);  // Also removes it from the epoll set
+  s->fd = -1;
+  if (s->state == SERVER_THINKING) {
+    s->state = SERVER_CLOSING;
+    return;
+  }
+  s->next = sv->closed;
+  sv->closed = s;
+}
+
+/**
+ * Server_flush - Send as much queued output as the socket takes
+ * @sv: Server
+ * @s: Session
+ *
+ * Returns: 1 if the session is still open, 0 if it was closed
+ */
+static int Server_flush(Server *sv, ServerSession *s) {
+  if (s->outLen < 0) {
+    Server_close(sv, s);
+    return 0;
+  }
+  int sent = 0;
+  while (sent < s->outLen) {
+    ssize_t n = send(s->fd, s->out + sent, s->outLen - sent, MSG_NOSIGNAL);
+    if (n > 0) {
+      sent += (int)n;
+    } else if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else {
+      Server_close(sv, s);
+      return 0;
+    }
+  }
+  memmove(s->out, s->out + sent, s->outLen - sent);
+  s->outLen -= sent;
+
+  int want = s->outLen > 0;
+  if (want != s->writing) {
+    struct epoll_event ev = {.events = EPOLLIN | (want ? EPOLLOUT : 0),
+                             .data.ptr = s};
+    epoll_ctl(sv->epollFd, EPOLL_CTL_MOD, s->fd, &ev);
+    s->writing = want;
+  }
+  return 1;
+}
+
+/**
+ * Server_enqueue - Queue a session's AI move for the dispatcher
+ * @sv: Server
+ * @s: Session with the AI to move
+ */
+static void Server_enqueue(Server *sv, ServerSession *s) {
+  s->state = SERVER_THINKING;
+  s->next = NULL;
+  pthread_mutex_lock(&sv->lock);
+  if (sv->queueTail)
+    sv->queueTail->next = s;
+  else
+    sv->queueHead = s;
+  sv->queueTail = s;
+  pthread_cond_signal(&sv->wake);
+  pthread_mutex_unlock(&sv->lock);
+}
+
+/**
+ * Server_finish - Record a finished game and tell the player
+ * @sv: Server
+ * @s: Session whose game just ended
+ */
+static void Server_finish(Server *sv, ServerSession *s) {
+  int state = Game_state(&s->game);
+  GameStats *stats = &s->stats;
+  AI_getSearchStats(&s->ai, NULL, &stats->player2AI);
+  stats->aiNodesExplored = (int)stats->player2AI.nodes;
+  stats->maxDepth = stats->player2AI.maxDepth;
+  stats->winner = state == 1 ? 'X' : state == -1 ? 'O' : 'D';
+
+  const ServerConfig *config = sv->config;
+  if (config->history)
+    GameHistory_append(config->history, stats);
+  if (config->leaderboard)
+    Leaderboard_addResult(config->leaderboard, stats->player1, state == 1,
+                          state == -1, state == 0);
+  sv->games++;
+
+  Server_send(s, "RESULT %s", state == 1 ? "WIN" : state == -1 ? "LOSS" : "DRAW");
+  s->state = SERVER_IDLE;
+}
+
+/**
+ * Server_startGame - Handle NEW: set up a game against the session's AI
+ * @sv: Server
+ * @s: Session (not thinking)
+ * @args: Rest of the command line
+ *
+ * A game still in progress is abandoned without being recorded
+ */
+static void Server_startGame(Server *sv, ServerSession *s, const char *args) {
+  char name[SERVER_LINE_MAX], order[8] = "first";
+  int difficulty = 2;
+  int n = sscanf(args, "%127s %d %7s", name, &difficulty, order);
+  if (n < 1 || strlen(name) >= MAX_USERNAME || difficulty < 0 ||
+      difficulty > 2 || (strcmp(order, "first") != 0 && strcmp(order, "second") != 0)) {
+    Server_send(s, "ERR usage: NEW <name> [0-2] [first|second]");
+    return;
+  }
+
+  const ServerConfig *config = sv->config;
+  Game_initSized(&s->game, config->boardSize, config->winLength);
+  AI_init(&s->ai, &s->game);
+  AI_setDifficulty(&s->ai, difficulty);
+  AI_setVerbose(&s->ai, 0);
+  AI_setSymbol(&s->ai, 'O');
+  AI_setTable(&s->ai, config->table);
+  AI_setSolvedTable(&s->ai, config->book);
+  AI_setDepthLimit(&s->ai, config->depthLimit);
+  AI_setTimeBudget(&s->ai, config->timeBudget);
+  if (config->seeded)
+    AI_setSeed(&s->ai, config->seed + sv->started);
+  sv->started++;
+
+  memset(&s->stats, 0, sizeof(s->stats));
+  memcpy(s->stats.player1, name, strlen(name) + 1);  // Length checked above
+  snprintf(s->stats.player2, MAX_USERNAME, "%s", getAIName(difficulty));
+
+  Server_sendBoard(s);
+  if (strcmp(order, "second") == 0) {
+    Server_enqueue(sv, s);
+  } else {
+    s->state = SERVER_PLAYER;
+    Server_send(s, "YOURTURN");
+  }
+}
+
+/**
+ * Server_playMove - Handle MOVE: play the player's stone, then queue the AI
+ * @sv: Server
+ * @s: Session
+ * @args: Rest of the command line
+ */
+static void Server_playMove(Server *sv, ServerSession *s, const char *args) {
+  int row, col;
+  if (s->state != SERVER_PLAYER) {
+    Server_send(s, "ERR not your turn");
+    return;
+  }
+  if (sscanf(args, "%d %d", &row, &col) != 2 || row < 0 || col < 0 ||
+      row >= s->game.size || col >= s->game.size ||
+      s->game.board[row][col] != ' ') {
+    Server_send(s, "ERR illegal move");
+    return;
+  }
+
+  Game_play(&s->game, row, col, 'X');
+  s->stats.player1Moves++;
+  s->stats.totalMoves++;
+  Server_sendBoard(s);
+  if (Game_state(&s->game) != 2)
+    Server_finish(sv, s);
+  else
+    Server_enqueue(sv, s);
+}
+
+/**
+ * Server_command - Handle one command line
+ * @sv: Server
+ * @s: Session
+ * @line: Command, '\0'-terminated without the newline
+ *
+ * Returns: 1 to keep the connection, 0 after QUIT
+ */
+static int Server_command(Server *sv, ServerSession *s, const char *line) {
+  char verb[8];
+  int len = 0;
+  if (sscanf(line, "%7s%n", verb, &len) != 1)
+    return 1;  // Blank line
+  if (strcmp(verb, "QUIT") == 0) {
+    Server_send(s, "BYE");
+    return 0;
+  }
+  if (s->state == SERVER_THINKING)
+    Server_send(s, "ERR thinking");
+  else if (strcmp(verb, "NEW") == 0)
+    Server_startGame(sv, s, line + len);
+  else if (strcmp(verb, "MOVE") == 0)
+    Server_playMove(sv, s, line + len);
+  else
+    Server_send(s, "ERR unknown command");
+  return 1;
+}
+
+/**
+ * Server_read - Read and handle a session's pending input
+ * @sv: Server
+ * @s: Session with readable data (or a hang-up)
+ */
+static void Server_read(Server *sv, ServerSession *s) {
+  for (;;) {
+    ssize_t n = recv(s->fd, s->in + s->inLen, SERVER_LINE_MAX - s->inLen, 0);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+    if (n <= 0) {
+      Server_close(sv, s);
+      return;
+    }
+    s->inLen += (int)n;
+
+    // Handle each complete line; a line that fills the buffer is refused
+    int start = 0;
+    for (int i = 0; i < s->inLen; ++i) {
+      if (s->in[i] != '\n')
+        continue;
+      s->in[i] = '\0';
+      if (i > start && s->in[i - 1] == '\r')
+        s->in[i - 1] = '\0';
+      if (!Server_command(sv, s, s->in + start)) {
+        Server_flush(sv, s);
+        if (s->fd >= 0)
+          Server_close(sv, s);
+        return;
+      }
+      start = i + 1;
+    }
+    memmove(s->in, s->in + start, s->inLen - start);
+    s->inLen -= start;
+    if (s->inLen == SERVER_LINE_MAX) {
+      Server_send(s, "ERR line too long");
+      s->inLen = 0;
+    }
+  }
+  Server_flush(sv, s);
+}
+
+/**
+ * Server_accept - Accept every pending connection
+ * @sv: Server
+ */
+static void Server_accept(Server *sv) {
+  for (;;) {
+    int fd = accept(sv->listenFd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        perror("server: accept");
+      return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    ServerSession *s = sv->free;
+    if (!s) {
+      static const char full[] = "ERR server full\n";
+      send(fd, full, sizeof(full) - 1, MSG_NOSIGNAL);
+      close(fd);
+      continue;
+    }
+    sv->free = s->next;
+    sv->active++;
+    s->fd = fd;
+    s->state = SERVER_IDLE;
+    s->writing = 0;
+    s->inLen = 0;
+    s->outLen = 0;
+
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = s};
+    if (epoll_ctl(sv->epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+      perror("server: epoll_ctl");
+      Server_close(sv, s);
+      continue;
+    }
+    Server_send(s, "HELLO %d %d", sv->config->boardSize, sv->config->winLength);
+    Server_flush(sv, s);
+  }
+}
+
+/**
+ * Server_collect - Play the AI moves the dispatcher has finished
+ * @sv: Server
+ */
+static void Server_collect(Server *sv) {
+  uint64_t count;
+  if (read(sv->wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+    perror("server: eventfd");
+
+  pthread_mutex_lock(&sv->lock);
+  ServerSession *s = sv->done;
+  sv->done = NULL;
+  pthread_mutex_unlock(&sv->lock);
+
+  while (s) {
+    ServerSession *next = s->next;
+    if (s->state == SERVER_CLOSING) {
+      s->next = sv->closed;
+      sv->closed = s;
+    } else {
+      Game_play(&s->game, s->reply.row, s->reply.col, 'O');
+      s->stats.player2Moves++;
+      s->stats.totalMoves++;
+      Server_send(s, "AI %d %d", s->reply.row, s->reply.col);
+      Server_sendBoard(s);
+      if (Game_state(&s->game) != 2) {
+        Server_finish(sv, s);
+      } else {
+        s->state = SERVER_PLAYER;
+        Server_send(s, "YOURTURN");
+      }
+      Server_flush(sv, s);
+    }
+    s = next;
+  }
+}
+
+/**
+ * Server_listen - Open the non-blocking listening socket
+ * @port: TCP port (all interfaces)
+ *
+ * Returns: Socket, or -1 on failure (the reason is printed)
+ */
+static int Server_listen(int port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    perror("server: socket");
+    return -1;
+  }
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons((uint16_t)port);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(fd, SOMAXCONN) < 0) {
+    fprintf(stderr, "server: cannot listen on port %d: %s\n", port,
+            strerror(errno));
+    close(fd);
+    return -1;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+  return fd;
+}
+
+/**
+ * Server_loop - Serve events until a stop signal
+ * @sv: Server with its sockets registered
+ */
+static void Server_loop(Server *sv) {
+  struct epoll_event events[SERVER_EVENTS];
+  long long lastFlush = Server_now();
+  while (!g_serverStop) {
+    int n = epoll_wait(sv->epollFd, events, SERVER_EVENTS, SERVER_TICK_MS);
+    if (n < 0 && errno != EINTR) {
+      perror("server: epoll_wait");
+      break;
+    }
+    for (int i = 0; i < n; ++i) {
+      void *ptr = events[i].data.ptr;
+      if (ptr == &sv->listenFd) {
+        Server_accept(sv);
+      } else if (ptr == &sv->wakeFd) {
+        Server_collect(sv);
+      } else {
+        ServerSession *s = ptr;
+        if (s->fd < 0)
+          continue;  // Closed earlier in this pass
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+          Server_read(sv, s);
+        else if (events[i].events & EPOLLOUT)
+          Server_flush(sv, s);
+      }
+    }
+
+    while (sv->closed) {
+      ServerSession *s = sv->closed;
+      sv->closed = s->next;
+      s->next = sv->free;
+      sv->free = s;
+      sv->active--;
+    }
+
+    long long now = Server_now();
+    if (now - lastFlush >= SERVER_TICK_MS) {
+      if (sv->config->leaderboard)
+        Leaderboard_flush(sv->config->leaderboard);
+      if (sv->config->history)
+        GameHistory_flush(sv->config->history);
+      lastFlush = now;
+    }
+  }
+}
+
+/**
+ * Server_run - Serve games until SIGINT or SIGTERM
+ * @config: Server settings
+ *
+ * Returns: 0 after a clean shutdown, 1 if the server could not start
+ */
+int Server_run(const ServerConfig *config) {
+  Server sv;
+  memset(&sv, 0, sizeof(sv));
+  sv.config = config;
+  sv.epollFd = sv.wakeFd = -1;
+  sv.listenFd = Server_listen(config->port);
+  if (sv.listenFd < 0)
+    return 1;
+
+  sv.sessions = calloc(config->maxSessions, sizeof(ServerSession));
+  sv.epollFd = epoll_create1(EPOLL_CLOEXEC);
+  sv.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  struct epoll_event listenEv = {.events = EPOLLIN, .data.ptr = &sv.listenFd};
+  struct epoll_event wakeEv = {.events = EPOLLIN, .data.ptr = &sv.wakeFd};
+  if (!sv.sessions || sv.epollFd < 0 || sv.wakeFd < 0 ||
+      epoll_ctl(sv.epollFd, EPOLL_CTL_ADD, sv.listenFd, &listenEv) < 0 ||
+      epoll_ctl(sv.epollFd, EPOLL_CTL_ADD, sv.wakeFd, &wakeEv) < 0) {
+    perror("server: setup");
+    goto fail;
+  }
+  for (int i = config->maxSessions - 1; i >= 0; --i) {
+    sv.sessions[i].fd = -1;
+    sv.sessions[i].next = sv.free;
+    sv.free = &sv.sessions[i];
+  }
+
+  pthread_mutex_init(&sv.lock, NULL);
+  pthread_cond_init(&sv.wake, NULL);
+  if (pthread_create(&sv.dispatcher, NULL, Server_dispatch, &sv) != 0) {
+    fprintf(stderr, "server: cannot start the dispatcher thread\n");
+    pthread_cond_destroy(&sv.wake);
+    pthread_mutex_destroy(&sv.lock);
+    goto fail;
+  }
+
+  // No SA_RESTART: the signal interrupts epoll_wait
+  struct sigaction sa, oldInt, oldTerm;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = Server_onSignal;
+  sigemptyset(&sa.sa_mask);
+  g_serverStop = 0;
+  sigaction(SIGINT, &sa, &oldInt);
+  sigaction(SIGTERM, &sa, &oldTerm);
+
+  printf("Serving %dx%d (%d in a row) on port %d, %d sessions, %d workers\n",
+         config->boardSize, config->boardSize, config->winLength, config->port,
+         config->maxSessions, ThreadPool_size(config->pool));
+  fflush(stdout);
+  Server_loop(&sv);
+
+  sigaction(SIGINT, &oldInt, NULL);
+  sigaction(SIGTERM, &oldTerm, NULL);
+  pthread_mutex_lock(&sv.lock);
+  sv.stop = 1;
+  pthread_cond_signal(&sv.wake);
+  pthread_mutex_unlock(&sv.lock);
+  pthread_join(sv.dispatcher, NULL);
+  pthread_cond_destroy(&sv.wake);
+  pthread_mutex_destroy(&sv.lock);
+
+  for (int i = 0; i < config->maxSessions; ++i)
+    if (sv.sessions[i].fd >= 0)
+      close(sv.sessions[i].fd);
+  if (config->leaderboard)
+    Leaderboard_flush(config->leaderboard);
+  if (config->history)
+    GameHistory_flush(config->history);
+  printf("Server stopped after %lld games\n", sv.games);
+
+  close(sv.wakeFd);
+  close(sv.epollFd);
+  close(sv.listenFd);
+  free(sv.sessions);
+  return 0;
+
+fail:
+  if (sv.wakeFd >= 0)
+    close(sv.wakeFd);
+  if (sv.epollFd >= 0)
+    close(sv.epollFd);
+  close(sv.listenFd);
+  free(sv.sessions);
+  return 1;
+}
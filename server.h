@@ -0,0 +1,69 @@
+/*
+ * server.h
+ *
+ * Network game server header for Tic-Tac-Toe
+ * Hosts many player vs AI games over TCP at once: one event-driven
+ * thread owns every socket and session, and the AIs' moves are searched
+ * in batches on a thread pool
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "ai.h"
+#include "history.h"
+#include "leaderboard.h"
+#include "threadpool.h"
+
+#define SERVER_DEFAULT_SESSIONS 4096  // Concurrent connections accepted by default
+#define SERVER_LINE_MAX 128           // Longest command line a client may send
+
+/**
+ * ServerConfig structure
+ * Where to listen, what every game is played on and the shared resources
+ */
+typedef struct {
+  int port;                 // TCP port to listen on (all interfaces)
+  int maxSessions;          // Connections served at once; more are turned away
+  int boardSize;            // Board side N of every game
+  int winLength;            // Stones in a row to win K
+  int depthLimit;           // AI search depth on boards larger than 3x3
+  int timeBudget;           // AI milliseconds per move there instead (0 = depth)
+  AITable *table;           // Transposition table shared by all AIs (NULL for none)
+  const SolvedTable *book;  // Solved table shared by all AIs (NULL for live search)
+  ThreadPool *pool;         // Workers searching the AIs' moves (NULL = one thread)
+  Leaderboard *leaderboard; // Store every result is added to (NULL = none)
+  GameHistory *history;     // Sink every finished game is logged to (NULL = none)
+  int seeded;               // 1 to seed game i's AI with seed + i
+  unsigned long long seed;  // Base seed when seeded
+} ServerConfig;
+
+/**
+ * Server_run - Serve games until SIGINT or SIGTERM
+ * @config: Server settings
+ *
+ * Returns: 0 after a clean shutdown, 1 if the server could not start
+ *          (the reason is printed)
+ *
+ * Line protocol, one command or reply per '\n'-terminated line:
+ *   client: NEW <name> [0-2] [first|second]  Start a game (Hard, player
+ *                                            first by default); the
+ *                                            player is X
+ *           MOVE <row> <col>                 Play a move
+ *           QUIT                             Close the connection
+ *   server: HELLO <size> <k>                 On connect
+ *           BOARD <cells>                    Row-major, '.' for empty
+ *           AI <row> <col>                   The AI's move
+ *           YOURTURN                         Waiting for MOVE
+ *           RESULT WIN|LOSS|DRAW             Game over (then NEW again)
+ *           ERR <reason>                     Command rejected
+ *           BYE                              Reply to QUIT
+ *
+ * Sessions live in one arena of @config->maxSessions slots allocated up
+ * front and recycled. Results go through the leaderboard's and the
+ * history's write buffers, which the server flushes at least once a
+ * second and on shutdown; neither is closed here
+ */
+int Server_run(const ServerConfig *config);
+
+#endif // SERVER_H
@@ -0,0 +1,497 @@
+/*
+ * solver.c
+ *
+ * Solved-position table implementation for Tic-Tac-Toe
+ * Builds, stores and queries the exact minimax value of every board
+ */
+
+#include "solver.h"
+#include "game.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SOLVED_MAGIC "TTTSOLV3"  // File signature (8 bytes, includes version); size and K follow
+#define SOLVED_MAX_CELLS (SOLVED_MAX_SIZE * SOLVED_MAX_SIZE)
+#define SOLVED_MAX_LINES 64      // Winning lines of the largest board (4x4, K=3: 24)
+#define SOLVED_IO_ENTRIES 4096   // Positions per read or write
+
+/**
+ * SolvedEntry structure (internal)
+ * Value and optimal moves of one position for its side to move
+ */
+typedef struct {
+  signed char score;        // From O's point of view
+  unsigned short best;      // Bitmask of optimal moves for the mover
+} SolvedEntry;
+
+struct SolvedTable {
+  int size;                 // Board side N
+  int winLength;            // Stones in a row to win K
+  int cells;                // N * N
+  unsigned count;           // Positions over every layer
+  unsigned layerBase[SOLVED_MAX_CELLS + 2];  // First index of each stone count
+  unsigned binom[SOLVED_MAX_CELLS + 1][SOLVED_MAX_CELLS + 1];  // binom[n][k] = C(n, k)
+  unsigned *rank;           // Colex rank of each cell mask among masks of its size
+  unsigned char squeeze[256][256];  // [m][b]: bits of b under m's set bits, packed low
+  SolvedEntry *entries;     // One per position, layer by layer
+  int lineCount;
+  unsigned short lines[SOLVED_MAX_LINES];  // Winning line masks
+};
+
+/*
+ * X moves first, so a board with s stones holds ceil(s/2) X stones and
+ * floor(s/2) O stones, and O moves next exactly when X is one ahead.
+ * Only those positions are stored: a layer is every X mask of its size
+ * times every O mask of its size on the free cells
+ */
+static inline int SolvedTable_xStones(int stones) { return (stones + 1) / 2; }
+static inline int SolvedTable_oStones(int stones) { return stones / 2; }
+
+/**
+ * SolvedTable_rank - Rank of a mask among the masks of its bit count
+ * @t: Table (supplies the binomials)
+ * @mask: Mask to rank
+ *
+ * Returns: Colex rank, 0 to C(cells, |mask|) - 1 (builds SolvedTable.rank)
+ */
+static unsigned SolvedTable_rank(const SolvedTable *t, unsigned mask) {
+  unsigned rank = 0;
+  int k = 0;
+  for (int j = 0; j < t->cells; ++j)
+    if (mask & (1u << j))
+      rank += t->binom[j][++k];
+  return rank;
+}
+
+/**
+ * SolvedTable_packBits - Pack the bits of a value found under a mask
+ * @bits: Value
+ * @mask: Positions to keep; the i-th lowest set bit becomes bit i
+ *
+ * Builds SolvedTable.squeeze (a byte at a time, for SolvedTable_index)
+ */
+static unsigned SolvedTable_packBits(unsigned bits, unsigned mask) {
+  unsigned out = 0;
+  for (int i = 0; mask; mask &= mask - 1, ++i)
+    if (bits & mask & -mask)
+      out |= 1u << i;
+  return out;
+}
+
+/**
+ * SolvedTable_create - Allocate an empty table for one board
+ * @size: Board side (3 to SOLVED_MAX_SIZE)
+ * @winLength: Stones in a row to win (3 to size)
+ *
+ * Returns: Table with its index and lines built and entries zeroed, or
+ *          NULL for a bad size or if allocation fails
+ *
+ * Lines are listed rows, columns, diagonals, then anti-diagonals, which
+ * on 3x3 is BOARD_WIN_LINES order
+ */
+static SolvedTable *SolvedTable_create(int size, int winLength) {
+  if (size < 3 || size > SOLVED_MAX_SIZE || winLength < 3 || winLength > size)
+    return NULL;
+  SolvedTable *t = malloc(sizeof(*t));
+  if (t == NULL)
+    return NULL;
+  t->size = size;
+  t->winLength = winLength;
+  t->cells = size * size;
+
+  for (int n = 0; n <= t->cells; ++n)
+    for (int k = 0; k <= t->cells; ++k)
+      t->binom[n][k] = k > n              ? 0
+                       : k == 0 || k == n ? 1
+                                          : t->binom[n - 1][k - 1] + t->binom[n - 1][k];
+  t->count = 0;
+  for (int stones = 0; stones <= t->cells; ++stones) {
+    int x = SolvedTable_xStones(stones), o = SolvedTable_oStones(stones);
+    t->layerBase[stones] = t->count;
+    t->count += t->binom[t->cells][x] * t->binom[t->cells - x][o];
+  }
+  t->layerBase[t->cells + 1] = t->count;
+  t->rank = malloc(sizeof(unsigned) << t->cells);
+  t->entries = calloc(t->count, sizeof(SolvedEntry));
+  if (t->rank == NULL || t->entries == NULL) {
+    SolvedTable_destroy(t);
+    return NULL;
+  }
+  for (unsigned m = 0; m < (1u << t->cells); ++m)
+    t->rank[m] = SolvedTable_rank(t, m);
+  for (unsigned m = 0; m < 256; ++m)
+    for (unsigned b = 0; b < 256; ++b)
+      t->squeeze[m][b] = (unsigned char)SolvedTable_packBits(b, m);
+
+  static const int dirs[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+  t->lineCount = 0;
+  for (int d = 0; d < 4; ++d)
+    for (int r = 0; r < size; ++r)
+      for (int c = 0; c < size; ++c) {
+        int endR = r + dirs[d][0] * (winLength - 1);
+        int endC = c + dirs[d][1] * (winLength - 1);
+        if (endR < 0 || endR >= size || endC < 0 || endC >= size)
+          continue;
+        unsigned mask = 0;
+        for (int i = 0; i < winLength; ++i)
+          mask |= 1u << ((r + dirs[d][0] * i) * size + c + dirs[d][1] * i);
+        t->lines[t->lineCount++] = (unsigned short)mask;
+      }
+  return t;
+}
+
+/**
+ * SolvedTable_index - Entry of a stored position
+ * @t: Table
+ * @xBits: Bitboard of X stones
+ * @oBits: Bitboard of O stones (counts as for SolvedTable_xStones)
+ */
+static inline unsigned SolvedTable_index(const SolvedTable *t, unsigned xBits,
+                                         unsigned oBits) {
+  unsigned freeCells = ~xBits & ((1u << t->cells) - 1);
+  int x = __builtin_popcount(xBits), o = __builtin_popcount(oBits);
+  // O's stones renumbered over the free cells, one byte of cells at a time
+  unsigned low = freeCells & 0xFF, high = freeCells >> 8;
+  unsigned packed = t->squeeze[low][oBits & 0xFF] |
+                    (unsigned)t->squeeze[high][(oBits >> 8) & 0xFF]
+                        << __builtin_popcount(low);
+  return t->layerBase[x + o] + t->rank[xBits] * t->binom[t->cells - x][o] +
+         t->rank[packed];
+}
+
+/**
+ * SolvedTable_deposit - Spread the low bits of a value over a mask
+ * @bits: Bit i goes to the i-th lowest set bit of @mask
+ * @mask: Target cells
+ */
+static inline unsigned SolvedTable_deposit(unsigned bits, unsigned mask) {
+  unsigned out = 0;
+  for (; mask && bits; mask &= mask - 1, bits >>= 1)
+    if (bits & 1)
+      out |= mask & -mask;
+  return out;
+}
+
+/**
+ * SolvedTable_nextCombination - Next larger mask with the same bit count
+ * @v: Current mask (not 0)
+ *
+ * Gosper's hack: masks of one size come out in ascending (colex) order
+ */
+static inline unsigned SolvedTable_nextCombination(unsigned v) {
+  unsigned low = v & -v, ripple = v + low;
+  return ripple | (((v ^ ripple) >> 2) / low);
+}
+
+/**
+ * SolvedTable_winner - Evaluate a board
+ * @t: Table (supplies the lines)
+ * @xBits: Bitboard of X stones
+ * @oBits: Bitboard of O stones
+ *
+ * Returns: BOARD_X_WINS, BOARD_O_WINS, BOARD_DRAW or BOARD_ONGOING, with
+ *          lines checked in order like Board_winner
+ */
+static int SolvedTable_winner(const SolvedTable *t, unsigned xBits,
+                              unsigned oBits) {
+  for (int i = 0; i < t->lineCount; ++i) {
+    unsigned line = t->lines[i];
+    if ((xBits & line) == line)
+      return BOARD_X_WINS;
+    if ((oBits & line) == line)
+      return BOARD_O_WINS;
+  }
+  return (xBits | oBits) == (1u << t->cells) - 1 ? BOARD_DRAW : BOARD_ONGOING;
+}
+
+/**
+ * SolvedTable_solveEntry - Solve one position from its children
+ * @t: Table whose next layer (one more stone) is already solved
+ * @xBits: Bitboard of X stones
+ * @oBits: Bitboard of O stones (the counts fix the side to move)
+ *
+ * A child's score is one ply further from its result, so it is shrunk
+ * by one towards zero before being compared at the parent
+ */
+static void SolvedTable_solveEntry(SolvedTable *t, unsigned xBits,
+                                   unsigned oBits) {
+  int oToMove = __builtin_popcount(xBits) > __builtin_popcount(oBits);
+  int win = t->cells + 1;
+  int state = SolvedTable_winner(t, xBits, oBits);
+  int best;
+  unsigned bestMask = 0;
+  if (state == BOARD_O_WINS) {
+    best = win;   // O has a line
+  } else if (state == BOARD_X_WINS) {
+    best = -win;  // X has a line
+  } else if (state == BOARD_DRAW) {
+    best = 0;     // Full board
+  } else {
+    best = oToMove ? -100 : 100;
+    unsigned empty = ~(xBits | oBits) & ((1u << t->cells) - 1);
+    for (; empty; empty &= empty - 1) {
+      unsigned bit = empty & -empty;
+      int v = oToMove ? t->entries[SolvedTable_index(t, xBits, oBits | bit)].score
+                      : t->entries[SolvedTable_index(t, xBits | bit, oBits)].score;
+      v = v > 0 ? v - 1 : v < 0 ? v + 1 : 0;
+      if (v == best) {
+        bestMask |= bit;
+      } else if (oToMove ? v > best : v < best) {
+        best = v;
+        bestMask = bit;
+      }
+    }
+  }
+
+  SolvedEntry *e = &t->entries[SolvedTable_index(t, xBits, oBits)];
+  e->score = (signed char)best;
+  e->best = (unsigned short)bestMask;
+}
+
+/**
+ * SolvedLayer structure (internal)
+ * One ply layer of a retrograde pass
+ */
+typedef struct {
+  SolvedTable *table;
+  int stones;             // Stones on every board of the layer
+  const unsigned *xMasks; // Every X mask of the layer's size, one per task
+} SolvedLayer;
+
+/**
+ * SolvedTable_layerTask - Solve the layer's boards with one X mask (pool task)
+ * @arg: SolvedLayer being solved
+ * @index: Index into layer->xMasks
+ * @worker: Pool worker index (unused)
+ *
+ * Boards of one layer only read the layer above, so tasks never touch
+ * each other's entries
+ */
+static void SolvedTable_layerTask(void *arg, int index, int worker) {
+  const SolvedLayer *layer = arg;
+  SolvedTable *t = layer->table;
+  unsigned x = layer->xMasks[index];
+  int oStones = SolvedTable_oStones(layer->stones);
+  unsigned freeCells = ~x & ((1u << t->cells) - 1);
+  (void)worker;
+
+  // Every O mask of the layer's size: combinations of the free cells
+  unsigned end = 1u << (t->cells - __builtin_popcount(x));
+  unsigned pick = (1u << oStones) - 1;
+  do {
+    SolvedTable_solveEntry(t, x, SolvedTable_deposit(pick, freeCells));
+    pick = pick ? SolvedTable_nextCombination(pick) : end;
+  } while (pick < end);
+}
+
+/**
+ * SolvedTable_solveGrid - Solve every position of a small board
+ * @size: Board side (3 to SOLVED_MAX_SIZE)
+ * @winLength: Stones in a row to win (3 to size)
+ * @pool: Workers to split each layer across (NULL = calling thread)
+ *
+ * Returns: New table, or NULL for a bad size or if allocation fails
+ */
+SolvedTable *SolvedTable_solveGrid(int size, int winLength, ThreadPool *pool) {
+  SolvedTable *t = SolvedTable_create(size, winLength);
+  if (t == NULL)
+    return NULL;
+  unsigned *xMasks = malloc(sizeof(unsigned) * t->binom[t->cells][t->cells / 2]);
+  if (xMasks == NULL) {
+    SolvedTable_destroy(t);
+    return NULL;
+  }
+
+  // Full boards first, then one stone fewer at a time
+  for (int stones = t->cells; stones >= 0; --stones) {
+    int xStones = SolvedTable_xStones(stones), n = 0;
+    unsigned end = 1u << t->cells;
+    for (unsigned x = (1u << xStones) - 1; x < end;
+         x = x ? SolvedTable_nextCombination(x) : end)
+      xMasks[n++] = x;
+    SolvedLayer layer = {t, stones, xMasks};
+    ThreadPool_run(pool, SolvedTable_layerTask, &layer, n);
+  }
+  free(xMasks);
+  return t;
+}
+
+/**
+ * SolvedTable_generate - Solve every 3x3 position in memory
+ *
+ * Returns: New table, or NULL if allocation fails
+ */
+SolvedTable *SolvedTable_generate(void) {
+  return SolvedTable_solveGrid(3, 3, NULL);
+}
+
+/**
+ * SolvedTable_save - Write a table in the compact binary format
+ * @table: Table to write
+ * @path: Destination file (overwritten)
+ *
+ * Format: 8-byte magic, a size byte and a K byte, then per position in
+ * index order (layer by layer, see SolvedTable_index): 1 signed score
+ * byte and the best-move mask as 2 bytes little-endian - 18,138 bytes
+ * of payload on 3x3
+ *
+ * Returns: 1 on success, 0 on I/O error
+ */
+int SolvedTable_save(const SolvedTable *table, const char *path) {
+  unsigned char *buf = malloc(SOLVED_IO_ENTRIES * 3);
+  if (buf == NULL)
+    return 0;
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    free(buf);
+    return 0;
+  }
+
+  unsigned char shape[2] = {(unsigned char)table->size,
+                            (unsigned char)table->winLength};
+  int ok = fwrite(SOLVED_MAGIC, 1, 8, file) == 8 &&
+           fwrite(shape, 1, 2, file) == 2;
+  for (unsigned i = 0; ok && i < table->count; i += SOLVED_IO_ENTRIES) {
+    size_t n = 0;
+    for (unsigned j = i; j < table->count && j < i + SOLVED_IO_ENTRIES; ++j) {
+      buf[n++] = (unsigned char)table->entries[j].score;
+      buf[n++] = (unsigned char)(table->entries[j].best & 0xFF);
+      buf[n++] = (unsigned char)(table->entries[j].best >> 8);
+    }
+    ok = fwrite(buf, 1, n, file) == n;
+  }
+  if (fclose(file) != 0)
+    ok = 0;
+  free(buf);
+  return ok;
+}
+
+/**
+ * SolvedTable_load - Read a table previously written by SolvedTable_save
+ * @path: File to read
+ *
+ * Returns: New table, or NULL if the file is missing, truncated or
+ *          carries a different signature
+ */
+SolvedTable *SolvedTable_load(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+    return NULL;
+
+  char magic[8];
+  unsigned char shape[2];
+  int ok = fread(magic, 1, 8, file) == 8 &&
+           memcmp(magic, SOLVED_MAGIC, 8) == 0 &&
+           fread(shape, 1, 2, file) == 2;
+  SolvedTable *t = ok ? SolvedTable_create(shape[0], shape[1]) : NULL;
+  unsigned char *buf = malloc(SOLVED_IO_ENTRIES * 3);
+  ok = t != NULL && buf != NULL;
+
+  for (unsigned i = 0; ok && i < t->count; i += SOLVED_IO_ENTRIES) {
+    unsigned end = i + SOLVED_IO_ENTRIES < t->count ? i + SOLVED_IO_ENTRIES
+                                                    : t->count;
+    size_t size = (size_t)(end - i) * 3;
+    if (fread(buf, 1, size, file) != size) {
+      ok = 0;
+      break;
+    }
+    for (unsigned j = i, n = 0; j < end; ++j, n += 3) {
+      t->entries[j].score = (signed char)buf[n];
+      t->entries[j].best = (unsigned short)(buf[n + 1] | (buf[n + 2] << 8));
+    }
+  }
+  if (ok)
+    ok = fgetc(file) == EOF;
+  fclose(file);
+  free(buf);
+  if (!ok) {
+    SolvedTable_destroy(t);
+    return NULL;
+  }
+  return t;
+}
+
+/**
+ * SolvedTable_open - Load the cached table, generating and caching it if needed
+ * @path: Cache file (usually SOLVED_TABLE_FILE)
+ *
+ * Returns: Table, or NULL only if it could be neither loaded nor generated
+ *
+ * A cache holding another board's table is replaced by the 3x3 one
+ */
+SolvedTable *SolvedTable_open(const char *path) {
+  SolvedTable *t = SolvedTable_load(path);
+  if (t != NULL && SolvedTable_matches(t, 3, 3))
+    return t;
+  SolvedTable_destroy(t);
+
+  t = SolvedTable_generate();
+  if (t != NULL)
+    SolvedTable_save(t, path);  // Best effort: next start loads instead
+  return t;
+}
+
+/**
+ * SolvedTable_destroy - Free a table
+ * @table: Table to free (NULL is ignored)
+ */
+void SolvedTable_destroy(SolvedTable *table) {
+  if (table == NULL)
+    return;
+  free(table->rank);
+  free(table->entries);
+  free(table);
+}
+
+/**
+ * SolvedTable_matches - Whether a table solves a given board
+ * @table: Table to check
+ * @size: Board side
+ * @winLength: Stones in a row to win
+ */
+int SolvedTable_matches(const SolvedTable *table, int size, int winLength) {
+  return table->size == size && table->winLength == winLength;
+}
+
+/**
+ * SolvedTable_covers - Whether a table stores a position
+ * @table: Table to check
+ * @xBits: Bitboard of X stones
+ * @oBits: Bitboard of O stones
+ * @oToMove: 1 if O moves next, 0 if X does
+ *
+ * Returns: 1 if the stones fit the board and the counts match the mover
+ *          (X one ahead with O to move, equal with X to move), 0 otherwise
+ */
+int SolvedTable_covers(const SolvedTable *table, unsigned xBits,
+                       unsigned oBits, int oToMove) {
+  unsigned full = (1u << table->cells) - 1;
+  return !(xBits & oBits) && !((xBits | oBits) & ~full) &&
+         __builtin_popcount(xBits) - __builtin_popcount(oBits) == !!oToMove;
+}
+
+/**
+ * SolvedTable_lookup - Exact value of a position
+ * @table: Table to query
+ * @xBits: Bitboard of X stones
+ * @oBits: Bitboard of O stones
+ * @oToMove: 1 if O moves next, 0 if X does
+ * @bestMask: Optional output bitmask of every optimal move for the mover
+ *
+ * Returns: Minimax score of the position, or 0 (and no best moves) for a
+ *          position the table does not cover
+ */
+int SolvedTable_lookup(const SolvedTable *table, unsigned xBits, unsigned oBits,
+                       int oToMove, unsigned *bestMask) {
+  if (!SolvedTable_covers(table, xBits, oBits, oToMove)) {
+    if (bestMask)
+      *bestMask = 0;
+    return 0;
+  }
+  const SolvedEntry *e = &table->entries[SolvedTable_index(table, xBits, oBits)];
+  if (bestMask)
+    *bestMask = e->best;
+  return e->score;
+}
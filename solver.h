@@ -0,0 +1,126 @@
+/*
+ * solver.h
+ *
+ * Solved-position table header for Tic-Tac-Toe
+ * Maps every board to its exact minimax value and set of best moves
+ * so the AI can answer without searching
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "threadpool.h"
+
+#define SOLVED_TABLE_FILE "solved_table.bin"  // Cached table written on first start
+#define SOLVED_MAX_SIZE 4  // Largest board SolvedTable_solveGrid accepts (16 cells)
+
+/**
+ * SolvedTable - Perfect-play table for every position of a small board (opaque)
+ *
+ * Holds one entry per position whose stone counts fit X moving first,
+ * for the side to move those counts imply (6,046 on 3x3, a superset of
+ * the 5,478 legal positions that also keeps boards past a win). Other
+ * positions, such as O to move with equal counts, are not stored; see
+ * SolvedTable_covers. Scores use the
+ * same encoding as the AI search: from O's point of view, +10/-10 for a
+ * win or loss by the side, minus one per ply until it happens, 0 for a
+ * draw. On an NxN board the win score is N*N + 1 instead of 10
+ */
+typedef struct SolvedTable SolvedTable;
+
+/**
+ * SolvedTable_generate - Solve every 3x3 position in memory
+ *
+ * Returns: New table, or NULL if allocation fails
+ * Takes well under a millisecond; positions are solved once each
+ */
+SolvedTable *SolvedTable_generate(void);
+
+/**
+ * SolvedTable_solveGrid - Solve every position of a small board
+ * @size: Board side (3 to SOLVED_MAX_SIZE)
+ * @winLength: Stones in a row to win (3 to size)
+ * @pool: Workers to split each layer across (NULL = calling thread)
+ *
+ * Returns: New table, or NULL for a bad size or if allocation fails
+ *
+ * Retrograde: boards are solved a ply layer at a time from the full
+ * boards back to the empty one, each from the already-solved layer with
+ * one more stone, so no position is searched twice and a layer's boards
+ * are independent. Only each layer's own stone split is enumerated; 4x4
+ * holds about 10.2 million positions (about 30MB)
+ */
+SolvedTable *SolvedTable_solveGrid(int size, int winLength, ThreadPool *pool);
+
+/**
+ * SolvedTable_load - Read a table previously written by SolvedTable_save
+ * @path: File to read
+ *
+ * Returns: New table, or NULL if the file is missing or malformed
+ * Accepts tables of any board SolvedTable_save wrote
+ */
+SolvedTable *SolvedTable_load(const char *path);
+
+/**
+ * SolvedTable_save - Write a table in the compact binary format
+ * @table: Table to write
+ * @path: Destination file (overwritten)
+ *
+ * Returns: 1 on success, 0 on I/O error
+ */
+int SolvedTable_save(const SolvedTable *table, const char *path);
+
+/**
+ * SolvedTable_open - Load the cached table, generating and caching it if needed
+ * @path: Cache file (usually SOLVED_TABLE_FILE)
+ *
+ * Returns: 3x3 table, or NULL only if it could be neither loaded nor
+ *          generated
+ * A failure to write the cache is not an error
+ */
+SolvedTable *SolvedTable_open(const char *path);
+
+/**
+ * SolvedTable_destroy - Free a table
+ * @table: Table to free (NULL is ignored)
+ */
+void SolvedTable_destroy(SolvedTable *table);
+
+/**
+ * SolvedTable_matches - Whether a table solves a given board
+ * @table: Table to check
+ * @size: Board side
+ * @winLength: Stones in a row to win
+ *
+ * Returns: 1 if the table was solved for that size and K, 0 otherwise
+ */
+int SolvedTable_matches(const SolvedTable *table, int size, int winLength);
+
+/**
+ * SolvedTable_covers - Whether a table stores a position
+ * @table: Table to check
+ * @xBits: Bitboard of X stones (bit = row * size + col)
+ * @oBits: Bitboard of O stones
+ * @oToMove: 1 if O moves next, 0 if X does
+ *
+ * Returns: 1 if the stone counts fit the mover (X moves first), 0 otherwise
+ */
+int SolvedTable_covers(const SolvedTable *table, unsigned xBits,
+                       unsigned oBits, int oToMove);
+
+/**
+ * SolvedTable_lookup - Exact value of a position
+ * @table: Table to query
+ * @xBits: Bitboard of X stones (bit = row * size + col)
+ * @oBits: Bitboard of O stones
+ * @oToMove: 1 if O moves next, 0 if X does
+ * @bestMask: Optional output bitmask of every optimal move for the mover
+ *
+ * Returns: Minimax score of the position (see SolvedTable for encoding),
+ *          or 0 with no best moves if SolvedTable_covers says it is not
+ *          stored
+ */
+int SolvedTable_lookup(const SolvedTable *table, unsigned xBits, unsigned oBits,
+                       int oToMove, unsigned *bestMask);
+
+#endif // SOLVER_H
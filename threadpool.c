@@ -0,0 +1,251 @@
+/*
+ * threadpool.c
+ *
+ * Worker thread pool implementation for Tic-Tac-Toe
+ * Fixed workers with per-worker task ranges and range stealing
+ */
+
+#include "threadpool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * ThreadPoolQueue structure (internal)
+ * Task indices [next, end) still owned by one worker
+ */
+typedef struct {
+  pthread_mutex_t lock;
+  int next;
+  int end;
+} ThreadPoolQueue;
+
+/**
+ * ThreadPoolWorker structure (internal)
+ * Per-thread handle passed to the worker loop
+ */
+typedef struct {
+  ThreadPool *pool;
+  int id;
+} ThreadPoolWorker;
+
+struct ThreadPool {
+  int size;                      // Number of workers
+  pthread_t threads[THREADPOOL_MAX_THREADS];
+  ThreadPoolWorker workers[THREADPOOL_MAX_THREADS];
+  ThreadPoolQueue queues[THREADPOOL_MAX_THREADS];
+
+  pthread_mutex_t runLock;       // Serializes ThreadPool_run callers
+  pthread_mutex_t lock;          // Guards the batch fields below
+  pthread_cond_t wake;           // Signalled when a batch starts or on stop
+  pthread_cond_t done;           // Signalled when the last worker finishes
+  ThreadPoolTask task;           // Current batch
+  void *arg;
+  unsigned generation;           // Bumped once per batch
+  int active;                    // Workers still busy with the batch
+  int stop;                      // Set by ThreadPool_destroy
+};
+
+/**
+ * ThreadPool_take - Pop the next index from a worker's own range
+ * @q: The worker's queue
+ *
+ * Returns: Task index, or -1 if the range is empty
+ */
+static int ThreadPool_take(ThreadPoolQueue *q) {
+  int index = -1;
+  pthread_mutex_lock(&q->lock);
+  if (q->next < q->end)
+    index = q->next++;
+  pthread_mutex_unlock(&q->lock);
+  return index;
+}
+
+/**
+ * ThreadPool_steal - Move half of another worker's range to this one
+ * @pool: Pool being run
+ * @id: Thief's worker index
+ *
+ * Returns: 1 if work was stolen into the thief's queue, 0 if every other
+ *          range is empty (the batch has no unclaimed tasks left)
+ *
+ * Only one queue lock is held at a time, so thieves cannot deadlock
+ */
+static int ThreadPool_steal(ThreadPool *pool, int id) {
+  for (int k = 1; k < pool->size; ++k) {
+    ThreadPoolQueue *victim = &pool->queues[(id + k) % pool->size];
+    int lo = 0, hi = 0;
+    pthread_mutex_lock(&victim->lock);
+    int left = victim->end - victim->next;
+    if (left > 0) {
+      hi = victim->end;
+      lo = hi - (left + 1) / 2;
+      victim->end = lo;
+    }
+    pthread_mutex_unlock(&victim->lock);
+
+    if (hi > lo) {
+      ThreadPoolQueue *own = &pool->queues[id];
+      pthread_mutex_lock(&own->lock);
+      own->next = lo;
+      own->end = hi;
+      pthread_mutex_unlock(&own->lock);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * ThreadPool_workerMain - Worker thread loop
+ * @p: ThreadPoolWorker handle
+ *
+ * Sleeps until a batch starts, drains its own range then steals until
+ * nothing is left, reports completion and waits for the next batch
+ */
+static void *ThreadPool_workerMain(void *p) {
+  ThreadPoolWorker *w = p;
+  ThreadPool *pool = w->pool;
+  unsigned seen = 0;
+
+  for (;;) {
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stop && pool->generation == seen)
+      pthread_cond_wait(&pool->wake, &pool->lock);
+    if (pool->stop) {
+      pthread_mutex_unlock(&pool->lock);
+      return NULL;
+    }
+    seen = pool->generation;
+    ThreadPoolTask task = pool->task;
+    void *arg = pool->arg;
+    pthread_mutex_unlock(&pool->lock);
+
+    do {
+      int index;
+      while ((index = ThreadPool_take(&pool->queues[w->id])) >= 0)
+        task(arg, index, w->id);
+    } while (ThreadPool_steal(pool, w->id));
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->active == 0)
+      pthread_cond_signal(&pool->done);
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+/**
+ * ThreadPool_create - Start a pool of worker threads
+ * @threads: Number of workers (clamped to 1..THREADPOOL_MAX_THREADS)
+ *
+ * Returns: New pool, or NULL if the threads could not be started
+ */
+ThreadPool *ThreadPool_create(int threads) {
+  if (threads < 1)
+    threads = 1;
+  if (threads > THREADPOOL_MAX_THREADS)
+    threads = THREADPOOL_MAX_THREADS;
+
+  ThreadPool *pool = calloc(1, sizeof(*pool));
+  if (pool == NULL)
+    return NULL;
+  pthread_mutex_init(&pool->runLock, NULL);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  for (int i = 0; i < THREADPOOL_MAX_THREADS; ++i)
+    pthread_mutex_init(&pool->queues[i].lock, NULL);
+
+  for (int i = 0; i < threads; ++i) {
+    pool->workers[i].pool = pool;
+    pool->workers[i].id = i;
+    if (pthread_create(&pool->threads[i], NULL, ThreadPool_workerMain,
+                       &pool->workers[i]) != 0) {
+      pool->size = i;  // Only the started workers are joined
+      ThreadPool_destroy(pool);
+      return NULL;
+    }
+    pool->size = i + 1;
+  }
+  return pool;
+}
+
+/**
+ * ThreadPool_destroy - Stop the workers and free the pool
+ * @pool: Pool to free (NULL is ignored)
+ */
+void ThreadPool_destroy(ThreadPool *pool) {
+  if (pool == NULL)
+    return;
+  pthread_mutex_lock(&pool->lock);
+  pool->stop = 1;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+  for (int i = 0; i < pool->size; ++i)
+    pthread_join(pool->threads[i], NULL);
+
+  for (int i = 0; i < THREADPOOL_MAX_THREADS; ++i)
+    pthread_mutex_destroy(&pool->queues[i].lock);
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->wake);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_mutex_destroy(&pool->runLock);
+  free(pool);
+}
+
+/**
+ * ThreadPool_size - Number of workers in a pool
+ * @pool: Pool to query (NULL counts as a single worker)
+ */
+int ThreadPool_size(const ThreadPool *pool) { return pool ? pool->size : 1; }
+
+/**
+ * ThreadPool_run - Run a batch of tasks and wait for all of them
+ * @pool: Pool to run on (NULL runs the tasks inline as worker 0)
+ * @task: Function called once per index
+ * @arg: Passed to every call
+ * @count: Number of tasks
+ *
+ * Worker i starts with the i-th contiguous slice of [0, count)
+ */
+void ThreadPool_run(ThreadPool *pool, ThreadPoolTask task, void *arg,
+                    int count) {
+  if (count <= 0)
+    return;
+  if (pool == NULL) {
+    for (int i = 0; i < count; ++i)
+      task(arg, i, 0);
+    return;
+  }
+
+  pthread_mutex_lock(&pool->runLock);
+  for (int i = 0; i < pool->size; ++i) {
+    ThreadPoolQueue *q = &pool->queues[i];
+    pthread_mutex_lock(&q->lock);
+    q->next = (int)((long long)count * i / pool->size);
+    q->end = (int)((long long)count * (i + 1) / pool->size);
+    pthread_mutex_unlock(&q->lock);
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->task = task;
+  pool->arg = arg;
+  pool->active = pool->size;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->wake);
+  while (pool->active > 0)
+    pthread_cond_wait(&pool->done, &pool->lock);
+  pthread_mutex_unlock(&pool->lock);
+  pthread_mutex_unlock(&pool->runLock);
+}
+
+/**
+ * ThreadPool_cpuCount - Number of online processors
+ *
+ * Returns: At least 1
+ */
+int ThreadPool_cpuCount(void) {
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+}
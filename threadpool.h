@@ -0,0 +1,74 @@
+/*
+ * threadpool.h
+ *
+ * Worker thread pool header for Tic-Tac-Toe
+ * Runs batches of independent tasks across several cores; used by the
+ * AI for root-parallel search and by self-play for parallel tournaments
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#define THREADPOOL_MAX_THREADS 64  // Upper bound on workers per pool
+
+/**
+ * ThreadPool - Fixed set of worker threads (opaque)
+ *
+ * Each batch is split into one contiguous range of task indices per
+ * worker. A worker that runs out of its own range steals the back half
+ * of another worker's remaining range, so uneven tasks still keep every
+ * core busy until the batch is done
+ */
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * ThreadPoolTask - Function run once per task index
+ * @arg: Batch argument passed to ThreadPool_run
+ * @index: Task index in [0, count)
+ * @worker: Index of the worker running it in [0, ThreadPool_size)
+ *
+ * Tasks sharing a worker index never run at the same time, so per-worker
+ * scratch state can be indexed by it without locking
+ */
+typedef void (*ThreadPoolTask)(void *arg, int index, int worker);
+
+/**
+ * ThreadPool_create - Start a pool of worker threads
+ * @threads: Number of workers (clamped to 1..THREADPOOL_MAX_THREADS)
+ *
+ * Returns: New pool, or NULL if the threads could not be started
+ */
+ThreadPool *ThreadPool_create(int threads);
+
+/**
+ * ThreadPool_destroy - Stop the workers and free the pool
+ * @pool: Pool to free (NULL is ignored)
+ */
+void ThreadPool_destroy(ThreadPool *pool);
+
+/**
+ * ThreadPool_size - Number of workers in a pool
+ * @pool: Pool to query (NULL counts as a single worker)
+ */
+int ThreadPool_size(const ThreadPool *pool);
+
+/**
+ * ThreadPool_run - Run a batch of tasks and wait for all of them
+ * @pool: Pool to run on (NULL runs the tasks inline as worker 0)
+ * @task: Function called once per index
+ * @arg: Passed to every call
+ * @count: Number of tasks
+ *
+ * Concurrent callers are served one batch at a time. Must not be called
+ * from inside a task of the same pool
+ */
+void ThreadPool_run(ThreadPool *pool, ThreadPoolTask task, void *arg, int count);
+
+/**
+ * ThreadPool_cpuCount - Number of online processors
+ *
+ * Returns: At least 1
+ */
+int ThreadPool_cpuCount(void);
+
+#endif // THREADPOOL_H
@@ -0,0 +1,109 @@
+/*
+ * trace.c
+ *
+ * Compile-time tracing implementation for Tic-Tac-Toe
+ * Buffered Chrome trace writer; empty unless built with -DTICTACTOE_TRACE
+ */
+
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, getpid
+
+#include "trace.h"
+
+#ifdef TICTACTOE_TRACE
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Output file and its state, guarded by g_traceLock */
+static pthread_mutex_t g_traceLock = PTHREAD_MUTEX_INITIALIZER;
+static FILE *g_traceFile = NULL;
+static int g_traceEvents = 0;  // Events written (0: not opened yet)
+static int g_traceFailed = 0;  // 1 once the file could not be opened
+
+/* Small per-thread ids, in order of each thread's first event */
+static atomic_int g_traceThreads = 0;
+static _Thread_local int t_traceId = 0;
+
+/**
+ * Trace_now - Microseconds on the trace clock (monotonic)
+ */
+double Trace_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+ * Trace_close - Terminate the event array (atexit handler)
+ */
+static void Trace_close(void) {
+  pthread_mutex_lock(&g_traceLock);
+  if (g_traceFile) {
+    fputs("\n]\n", g_traceFile);
+    fclose(g_traceFile);
+    g_traceFile = NULL;
+  }
+  pthread_mutex_unlock(&g_traceLock);
+}
+
+/**
+ * Trace_open - Open the output file on the first event
+ *
+ * Returns: 1 if events can be written (lock held by the caller)
+ */
+static int Trace_open(void) {
+  if (g_traceFile)
+    return 1;
+  if (g_traceFailed)
+    return 0;
+  const char *path = getenv("TICTACTOE_TRACE_FILE");
+  if (!path || !*path)
+    path = TRACE_DEFAULT_FILE;
+  g_traceFile = fopen(path, "w");
+  if (!g_traceFile) {
+    fprintf(stderr, "trace: cannot write %s\n", path);
+    g_traceFailed = 1;
+    return 0;
+  }
+  fputs("[\n", g_traceFile);
+  atexit(Trace_close);
+  return 1;
+}
+
+/**
+ * Trace_event - Record one complete event ending now
+ * @category: Event group
+ * @name: Event name
+ * @start: Trace_now value when the event began
+ * @args: printf format of the JSON args members (NULL for none)
+ */
+void Trace_event(const char *category, const char *name, double start,
+                 const char *args, ...) {
+  double end = Trace_now();
+  if (t_traceId == 0)
+    t_traceId = atomic_fetch_add(&g_traceThreads, 1) + 1;
+
+  pthread_mutex_lock(&g_traceLock);
+  if (Trace_open()) {
+    fprintf(g_traceFile,
+            "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,"
+            "\"dur\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{",
+            g_traceEvents++ ? ",\n" : "", name, category, start, end - start,
+            (int)getpid(), t_traceId);
+    if (args) {
+      va_list ap;
+      va_start(ap, args);
+      vfprintf(g_traceFile, args, ap);
+      va_end(ap);
+    }
+    fputs("}}", g_traceFile);
+  }
+  pthread_mutex_unlock(&g_traceLock);
+}
+
+#endif // TICTACTOE_TRACE
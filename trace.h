@@ -0,0 +1,53 @@
+/*
+ * trace.h
+ *
+ * Compile-time tracing hooks for Tic-Tac-Toe
+ * Built with -DTICTACTOE_TRACE (make TRACE=1) the hooks record timed
+ * events in Chrome trace format; otherwise every hook compiles to nothing
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#define TRACE_DEFAULT_FILE "trace.json"  // Output unless TICTACTOE_TRACE_FILE is set
+
+#ifdef TICTACTOE_TRACE
+
+/**
+ * Trace_now - Microseconds on the trace clock (monotonic)
+ */
+double Trace_now(void);
+
+/**
+ * Trace_event - Record one complete event ending now
+ * @category: Event group ("ai", "ui", "io")
+ * @name: Event name
+ * @start: Trace_now value when the event began
+ * @args: printf format of the event's JSON args members, e.g.
+ *        "\"nodes\":%d" (NULL for none)
+ *
+ * Thread-safe. The first event opens the output file (the
+ * TICTACTOE_TRACE_FILE environment variable, or TRACE_DEFAULT_FILE) and
+ * the array is closed at exit. Load it in chrome://tracing or Perfetto
+ */
+void Trace_event(const char *category, const char *name, double start,
+                 const char *args, ...)
+    __attribute__((format(printf, 4, 5)));
+
+#define TRACE_START(t) double t = Trace_now()
+#define TRACE_END(t, category, name) Trace_event(category, name, t, NULL)
+#define TRACE_END_ARGS(t, category, name, ...) \
+  Trace_event(category, name, t, __VA_ARGS__)
+#define TRACE_ONLY(code) code
+
+#else
+
+/* Tracing off: no code, no clock reads, arguments not evaluated */
+#define TRACE_START(t) do { } while (0)
+#define TRACE_END(t, category, name) do { } while (0)
+#define TRACE_END_ARGS(t, category, name, ...) do { } while (0)
+#define TRACE_ONLY(code)
+
+#endif // TICTACTOE_TRACE
+
+#endif // TRACE_H
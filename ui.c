@@ -3,18 +3,39 @@
  * 
  * User interface implementation for Tic-Tac-Toe
  * Handles terminal display using ANSI escape codes and input processing
+ *
+ * Screens are composed in an off-screen frame buffer and diffed against
+ * the frame on the terminal; only changed cells are sent, in one write
  */
 
 #include "ui.h"
+#include "trace.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 
+#define UI_MAX_ROWS 128   // Largest terminal the frame buffers cover
+#define UI_MAX_COLS 256
+#define UI_MERGE_GAP 6    // Unchanged cells resent rather than jumped over (a jump costs ~7 bytes)
+
 /* Terminal dimensions (default 80x24, updated at init) */
 static int termWidth = 80, termHeight = 24;
 
+/* Double-buffered frames: screens[frontScreen] is what the terminal shows */
+static char screens[2][UI_MAX_ROWS][UI_MAX_COLS];
+static int frontScreen = 0;
+static int frontValid = 0;  // 0 until a full frame has been sent (or after foreign output)
+static int frameRows = 0;   // Rows above the prompt, the part that is diffed
+
+/* Escape sequences and text for one frame, sent with a single write */
+static char frameOut[UI_MAX_ROWS * (UI_MAX_COLS + 16) + 512];
+static size_t frameLen;
+
 /**
  * UI_init - Initialize UI system and detect terminal size
  * 
@@ -24,11 +45,19 @@ static int termWidth = 80, termHeight = 24;
 void UI_init(void) {
 #ifdef TIOCGWINSZ
   struct winsize ws;
-  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != -1) {
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != -1 && ws.ws_col > 0 &&
+      ws.ws_row > 0) {
     termWidth = ws.ws_col;
     termHeight = ws.ws_row;
   }
 #endif
+  if (termWidth > UI_MAX_COLS)
+    termWidth = UI_MAX_COLS;
+  if (termHeight > UI_MAX_ROWS)
+    termHeight = UI_MAX_ROWS;
+  if (termHeight < 4)
+    termHeight = 4;
+  frontValid = 0;  // The menu drew over whatever was shown before
 }
 
 /**
@@ -39,14 +68,166 @@ void UI_init(void) {
 void UI_cleanup(void) {}
 
 /**
- * clearScreen - Clear terminal screen using ANSI escape codes
+ * promptRow - Screen row of the input prompt
+ * 
+ * The prompt row and everything below it are rewritten every frame, since
+ * the player's typing lands there without the frame buffer knowing
+ */
+static int promptRow(void) { return termHeight - 2; }
+
+/**
+ * frameBegin - Start composing a frame in the back buffer
+ * 
+ * The back buffer starts blank; draw calls then place text into it
+ */
+static void frameBegin(void) {
+  memset(screens[1 - frontScreen], ' ', sizeof(screens[0]));
+  frameRows = promptRow() - 1;
+}
+
+/**
+ * framePrint - printf into the back buffer at a screen position
+ * @row: Screen row (1-based, like the ANSI cursor address)
+ * @col: Screen column (1-based)
+ * 
+ * Text is clipped at the right edge and at the prompt area; control
+ * characters are drawn as spaces
+ */
+static void framePrint(int row, int col, const char *fmt, ...) {
+  char text[UI_MAX_COLS + 1];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(text, sizeof(text), fmt, ap);
+  va_end(ap);
+  if (row < 1 || row > frameRows)
+    return;
+
+  char *line = screens[1 - frontScreen][row - 1];
+  for (int i = 0; text[i] != '\0' && col - 1 + i < termWidth; ++i)
+    if (col - 1 + i >= 0)
+      line[col - 1 + i] = isprint((unsigned char)text[i]) ? text[i] : ' ';
+}
+
+/**
+ * frameEmit - Append formatted output to the pending write
+ */
+static void frameEmit(const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(frameOut + frameLen, sizeof(frameOut) - frameLen, fmt, ap);
+  va_end(ap);
+  if (n > 0)
+    frameLen = frameLen + (size_t)n < sizeof(frameOut) ? frameLen + (size_t)n
+                                                       : sizeof(frameOut) - 1;
+}
+
+/**
+ * framePresent - Send the back buffer to the terminal and make it current
+ * @prompt: Text for the prompt row; the cursor is left after it
+ * 
+ * Each row is compared with the frame on screen and only changed runs
+ * are sent, each behind one cursor move; runs separated by a few equal
+ * cells are merged, which is shorter than a second move. The first
+ * frame (or one after foreign output) clears the screen and sends only
+ * non-blank cells. Everything goes out in one write()
+ */
+static void framePresent(const char *prompt) {
+  char (*back)[UI_MAX_COLS] = screens[1 - frontScreen];
+  char (*shown)[UI_MAX_COLS] = screens[frontScreen];
+
+  frameLen = 0;
+  if (!frontValid)
+    frameEmit("\033[H\033[2J");
+  for (int r = 0; r < frameRows; ++r) {
+    // After a clear, compare against a blank screen
+    const char *was = frontValid ? shown[r] : NULL;
+    int c = 0;
+    while (c < termWidth) {
+      if (back[r][c] == (was ? was[c] : ' ')) {
+        c++;
+        continue;
+      }
+      int last = c;
+      for (int e = c + 1; e < termWidth && e - last <= UI_MERGE_GAP; ++e)
+        if (back[r][e] != (was ? was[e] : ' '))
+          last = e;
+      frameEmit("\033[%d;%dH%.*s", r + 1, c + 1, last - c + 1, &back[r][c]);
+      c = last + 1;
+    }
+  }
+  frameEmit("\033[%d;1H%s\033[J", promptRow(), prompt);
+
+  fflush(stdout);  // Keep order with anything printed through stdio
+  const char *p = frameOut;
+  while (frameLen > 0) {
+    ssize_t n = write(STDOUT_FILENO, p, frameLen);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    p += n;
+    frameLen -= (size_t)n;
+  }
+  frontScreen = 1 - frontScreen;
+  frontValid = 1;
+}
+
+/**
+ * boardCellWidth - Screen columns used per cell on larger boards
+ * @g: Pointer to Game structure
+ */
+static int boardCellWidth(const Game *g) { return g->size > 10 ? 3 : 2; }
+
+/**
+ * boardWidth - Screen columns taken by the drawn board
+ * @g: Pointer to Game structure
+ */
+static int boardWidth(const Game *g) {
+  if (Game_isClassic(g))
+    return 17;  // Width of the position guide
+  return 3 + g->size * boardCellWidth(g);
+}
+
+/**
+ * drawBoardRows - Render the board grid starting at a screen position
+ * @g: Pointer to Game structure
+ * @row: First screen row
+ * @startCol: Screen column of the left edge
+ * 
+ * Returns: Next free screen row
  * 
- * Uses: \033[2J (clear entire screen)
- *       \033[H  (move cursor to home position)
+ * 3x3 boards keep the "X | O | X" layout; larger boards are drawn as a
+ * compact grid with row and column numbers, '.' marking empty cells
  */
-static void clearScreen(void) {
-  printf("\033[2J\033[H");
-  fflush(stdout);
+static int drawBoardRows(Game *g, int row, int startCol) {
+  if (Game_isClassic(g)) {
+    for (int i = 0; i < 3; ++i) {
+      if (i > 0)
+        framePrint(row++, startCol, "--+---+--");  // Separator
+      framePrint(row++, startCol, "%c | %c | %c", g->board[i][0],
+                 g->board[i][1], g->board[i][2]);
+    }
+    return row;
+  }
+
+  int w = boardCellWidth(g);
+  char line[UI_MAX_COLS];
+  int len;
+
+  // Column numbers
+  len = snprintf(line, sizeof(line), "  ");
+  for (int j = 0; j < g->size; ++j)
+    len += snprintf(line + len, sizeof(line) - len, "%*d", w, j);
+  framePrint(row++, startCol, "%s", line);
+
+  for (int i = 0; i < g->size; ++i) {
+    len = snprintf(line, sizeof(line), "%2d", i);
+    for (int j = 0; j < g->size; ++j)
+      len += snprintf(line + len, sizeof(line) - len, "%*c", w,
+                      g->board[i][j] == ' ' ? '.' : g->board[i][j]);
+    framePrint(row++, startCol, "%s", line);
+  }
+  return row;
 }
 
 /**
@@ -55,49 +236,34 @@ static void clearScreen(void) {
  * @startCol: Starting column position for drawing
  * 
  * Displays:
- * - Current board state (3x3 grid)
+ * - Current board state (N x N grid)
  * - Position reference guide showing (row,col) coordinates
  */
 static void drawBoardColumn(Game *g, int startCol) {
   int row = 2;
 
   // Title
-  printf("\033[%d;%dH", row++, startCol);
-  printf("GAME BOARD");
+  if (Game_isClassic(g))
+    framePrint(row++, startCol, "GAME BOARD");
+  else
+    framePrint(row++, startCol, "GAME BOARD (%dx%d, %d in a row)", g->size,
+               g->size, g->winLength);
 
   row++;
 
-  // Row 0 of board
-  printf("\033[%d;%dH", row++, startCol);
-  printf("%c | %c | %c", g->board[0][0], g->board[0][1], g->board[0][2]);
-
-  // Separator
-  printf("\033[%d;%dH", row++, startCol);
-  printf("--+---+--");
-
-  // Row 1 of board
-  printf("\033[%d;%dH", row++, startCol);
-  printf("%c | %c | %c", g->board[1][0], g->board[1][1], g->board[1][2]);
-
-  // Separator
-  printf("\033[%d;%dH", row++, startCol);
-  printf("--+---+--");
-
-  // Row 2 of board
-  printf("\033[%d;%dH", row++, startCol);
-  printf("%c | %c | %c", g->board[2][0], g->board[2][1], g->board[2][2]);
+  row = drawBoardRows(g, row, startCol);
 
   row++;
 
   // Position reference guide
-  printf("\033[%d;%dH", row++, startCol);
-  printf("Positions:");
-  printf("\033[%d;%dH", row++, startCol);
-  printf("(0,0) (0,1) (0,2)");
-  printf("\033[%d;%dH", row++, startCol);
-  printf("(1,0) (1,1) (1,2)");
-  printf("\033[%d;%dH", row++, startCol);
-  printf("(2,0) (2,1) (2,2)");
+  framePrint(row++, startCol, "Positions:");
+  if (!Game_isClassic(g)) {
+    framePrint(row++, startCol, "row col, each 0-%d", g->size - 1);
+    return;
+  }
+  framePrint(row++, startCol, "(0,0) (0,1) (0,2)");
+  framePrint(row++, startCol, "(1,0) (1,1) (1,2)");
+  framePrint(row++, startCol, "(2,0) (2,1) (2,2)");
 }
 
 /**
@@ -116,43 +282,34 @@ static void drawAIColumn(UIGameState *state, int startCol) {
   int row = 2;
 
   // AI name and difficulty
-  printf("\033[%d;%dH", row++, startCol);
-  printf("%s (Lvl %d)", state->aiName, state->aiDifficulty);
+  framePrint(row++, startCol, "%s (Lvl %d)", state->aiName,
+             state->aiDifficulty);
 
   row++;
 
   // Display AI's current thought
-  if (strlen(state->aiThought) > 0) {
-    printf("\033[%d;%dH", row++, startCol);
-    printf("Thinking: %.50s", state->aiThought);
-  }
+  if (strlen(state->aiThought) > 0)
+    framePrint(row++, startCol, "Thinking: %.50s", state->aiThought);
 
   row++;
 
   // Display top candidate moves
-  printf("\033[%d;%dH", row++, startCol);
-  printf("Top Moves:");
-  for (int i = 0; i < state->candidateCount && i < 4; i++) {
-    printf("\033[%d;%dH", row++, startCol);
-    printf("  (%d,%d) score:%d", state->candidates[i].row,
-           state->candidates[i].col, state->candidates[i].score);
-  }
+  framePrint(row++, startCol, "Top Moves:");
+  for (int i = 0; i < state->candidateCount && i < 4; i++)
+    framePrint(row++, startCol, "  (%d,%d) score:%d", state->candidates[i].row,
+               state->candidates[i].col, state->candidates[i].score);
 
   row++;
 
   // Display AI personality comment
-  if (strlen(state->lastAIComment) > 0) {
-    printf("\033[%d;%dH", row++, startCol);
-    printf("Comment: %.50s", state->lastAIComment);
-  }
+  if (strlen(state->lastAIComment) > 0)
+    framePrint(row++, startCol, "Comment: %.50s", state->lastAIComment);
 
   row++;
 
   // Display performance metrics
-  printf("\033[%d;%dH", row++, startCol);
-  printf("Nodes: %d", state->aiNodesExplored);
-  printf("\033[%d;%dH", row++, startCol);
-  printf("Depth: %d", state->aiMaxDepth);
+  framePrint(row++, startCol, "Nodes: %d", state->aiNodesExplored);
+  framePrint(row++, startCol, "Depth: %d", state->aiMaxDepth);
 }
 
 /**
@@ -164,30 +321,35 @@ static void drawAIColumn(UIGameState *state, int startCol) {
  * Creates two-column layout:
  * - Left: Game board and position guide
  * - Right: AI analysis and statistics
- * Bottom: Input prompt or status message
+ * Bottom: Status message and input prompt
+ * 
+ * Only the cells that differ from the previous frame are sent, so
+ * redrawing an unchanged screen costs one short write
  */
 void UI_drawGame(Game *g, UIGameState *state, int isPlayerTurn) {
-  clearScreen();
+  TRACE_START(t);
+  frameBegin();
 
   // Header showing players
-  printf("\033[1;1HTC-TAC-TOE: %s vs %s", state->username, state->aiName);
+  framePrint(1, 1, "TC-TAC-TOE: %s vs %s", state->username, state->aiName);
 
-  // Calculate column positions (split screen in half)
+  // Calculate column positions (split screen in half, wider for big boards)
   int colWidth = termWidth / 2;
+  if (colWidth < boardWidth(g) + 2)
+    colWidth = boardWidth(g) + 2;
 
   // Draw both columns
   drawBoardColumn(g, 2);
   drawAIColumn(state, colWidth + 2);
 
+  // Status line above the prompt (e.g. a rejected move)
+  if (strlen(state->statusMessage) > 0)
+    framePrint(promptRow() - 1, 1, "%s", state->statusMessage);
+
   // Bottom prompt
-  printf("\033[%d;1H", termHeight - 2);
-  if (isPlayerTurn) {
-    printf("YOUR TURN - Enter move (row col): ");
-    fflush(stdout);
-  } else {
-    printf("AI is thinking...");
-    fflush(stdout);
-  }
+  framePresent(isPlayerTurn ? "YOUR TURN - Enter move (row col): "
+                            : "AI is thinking...");
+  TRACE_END(t, "ui", "drawGame");
 }
 
 /**
@@ -198,48 +360,36 @@ void UI_drawGame(Game *g, UIGameState *state, int isPlayerTurn) {
  * 
  * Shows final board state and game result
  * Waits for user to press Enter before continuing
+ * 
+ * Always sent as a full frame: AI vs AI prints its moves as plain text,
+ * so what is on screen no longer matches the last frame
  */
 void UI_drawGameOver(Game *g, UIGameState *state __attribute__((unused)),
                      const char *result) {
-  clearScreen();
+  frontValid = 0;
+  frameBegin();
 
   // Title
-  printf("\033[1;1HGAME OVER");
+  framePrint(1, 1, "GAME OVER");
 
   int row = 3;
 
   // Display final board state
-  printf("\033[%d;2H", row++);
-  printf("%c | %c | %c", g->board[0][0], g->board[0][1], g->board[0][2]);
-
-  printf("\033[%d;2H", row++);
-  printf("--+---+--");
-
-  printf("\033[%d;2H", row++);
-  printf("%c | %c | %c", g->board[1][0], g->board[1][1], g->board[1][2]);
-
-  printf("\033[%d;2H", row++);
-  printf("--+---+--");
-
-  printf("\033[%d;2H", row++);
-  printf("%c | %c | %c", g->board[2][0], g->board[2][1], g->board[2][2]);
+  row = drawBoardRows(g, row, 2);
 
   row += 2;
 
   // Display result message
-  printf("\033[%d;2H", row++);
-  printf("%s", result);
+  framePrint(row++, 2, "%s", result);
 
   // Prompt to continue
-  printf("\033[%d;1H", termHeight - 2);
-  printf("Press Enter to continue...");
-  fflush(stdout);
+  framePresent("Press Enter to continue...");
 }
 
 /**
  * UI_getPlayerInput - Get player move input from keyboard
- * @row: Pointer to store row coordinate (0-2)
- * @col: Pointer to store column coordinate (0-2)
+ * @row: Pointer to store row coordinate (0 to size-1)
+ * @col: Pointer to store column coordinate (0 to size-1)
  * 
  * Returns: 1 if valid input received, 0 if invalid
  * 
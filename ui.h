@@ -20,8 +20,8 @@ typedef struct {
   char aiName[64];              // Name of AI opponent (e.g., "Kitty", "Cop", "Sera")
   int aiDifficulty;             // AI difficulty level (0-2)
   char username[64];            // Current player's username
-  AICandidate candidates[9];    // Array of candidate moves with scores
-  int candidateCount;           // Number of valid candidates (0-9)
+  AICandidate candidates[GAME_MAX_CELLS];  // Array of candidate moves with scores
+  int candidateCount;           // Number of valid candidates (0 to size * size)
   char aiThought[256];          // AI's current thought/analysis
   char lastAIComment[256];      // AI's personality comment
   int aiNodesExplored;          // Number of nodes explored in last search
@@ -63,11 +63,11 @@ void UI_drawGameOver(Game *g, UIGameState *state, const char *result);
 
 /**
  * UI_getPlayerInput - Get and validate player move input
- * @row: Pointer to store row coordinate (0-2)
- * @col: Pointer to store column coordinate (0-2)
+ * @row: Pointer to store row coordinate (0 to size-1)
+ * @col: Pointer to store column coordinate (0 to size-1)
  * 
  * Returns: 1 if valid input received, 0 if invalid
- * Prompts user for "row col" input and validates coordinates
+ * Prompts user for "row col" input; the caller checks the range
  */
 int UI_getPlayerInput(int *row, int *col);
 
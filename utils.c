@@ -6,6 +6,9 @@
  */
 
 #include "utils.h"
+#include "history.h"
+#include "leaderboard.h"
+#include "trace.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -29,96 +32,75 @@ void clearScreen() {
 
 /* ==================== LEADERBOARD FUNCTIONS ==================== */
 
+/* Leaderboard store shared by every call in this process (see getLeaderboard) */
+static Leaderboard *g_leaderboard = NULL;
+
 /**
- * savePlayerRecord - Save or update player record in leaderboard file
- * @record: Pointer to PlayerRecord to save
+ * getLeaderboard - Open the leaderboard store on first use
  * 
- * Process:
- * 1. Read all existing records from file
- * 2. Update record if username exists, otherwise add new record
- * 3. Write all records back to file
+ * Returns: Store, or NULL if it cannot be opened (an error is printed)
  * 
- * File format: "username wins losses draws totalGames" (space-separated)
- * Maximum 100 players supported
+ * A store that is still empty is seeded from the old text leaderboard if
+ * one exists, so existing players carry over once
  */
-void savePlayerRecord(const PlayerRecord *record) {
-  FILE *file = fopen(LEADERBOARD_FILE, "r");
-  PlayerRecord records[100];  // Max 100 players
-  int count = 0;
-  int found = 0;
-
-  // Read existing records from file
-  if (file != NULL) {
-    while (count < 100 &&
-           fscanf(file, "%49s %d %d %d %d", records[count].username,
-                  &records[count].wins, &records[count].losses,
-                  &records[count].draws, &records[count].totalGames) == 5) {
-      // Check if this is the record to update
-      if (strcmp(records[count].username, record->username) == 0) {
-        records[count] = *record;  // Update existing record
-        found = 1;
-      }
-      count++;
-    }
-    fclose(file);
+static Leaderboard *getLeaderboard() {
+  if (g_leaderboard == NULL) {
+    g_leaderboard = Leaderboard_open(LEADERBOARD_STORE_FILE);
+    if (g_leaderboard == NULL)
+      printf("Error: Could not open leaderboard data.\n");
+    else if (Leaderboard_count(g_leaderboard) == 0)
+      Leaderboard_importText(g_leaderboard, LEADERBOARD_FILE);
   }
+  return g_leaderboard;
+}
 
-  // Add new record if username not found
-  if (!found && count < 100) {
-    records[count++] = *record;
-  }
+/**
+ * closeLeaderboard - Write back pending results and close the store
+ * 
+ * Safe to call when it was never opened; the next leaderboard call
+ * reopens it
+ */
+void closeLeaderboard() {
+  TRACE_START(t);
+  Leaderboard_close(g_leaderboard);
+  TRACE_END(t, "io", "closeLeaderboard");
+  g_leaderboard = NULL;
+}
 
-  // Write all records back to file
-  file = fopen(LEADERBOARD_FILE, "w");
-  if (file == NULL) {
+/**
+ * savePlayerRecord - Save or update player record in the leaderboard store
+ * @record: Pointer to PlayerRecord to save
+ * 
+ * Updates the player's fixed-size record in place, or appends it for a
+ * new player; other records are not touched. No limit on player count
+ */
+void savePlayerRecord(const PlayerRecord *record) {
+  TRACE_START(t);
+  Leaderboard *lb = getLeaderboard();
+  if (lb == NULL || !Leaderboard_put(lb, record))
     printf("Error: Could not save leaderboard data.\n");
-    return;
-  }
-
-  for (int i = 0; i < count; i++) {
-    fprintf(file, "%s %d %d %d %d\n", records[i].username, records[i].wins,
-            records[i].losses, records[i].draws, records[i].totalGames);
-  }
-
-  fclose(file);
+  TRACE_END(t, "io", "savePlayerRecord");
 }
 
 /**
- * loadPlayerRecord - Load player record from leaderboard file
+ * loadPlayerRecord - Load player record from the leaderboard store
  * @username: Player's username to search for
  * @record: Pointer to PlayerRecord to fill with loaded data
  * 
  * Returns: 1 if player found (returning player), 0 if not found (new player)
  * 
  * If player not found, initializes record with username and zero stats
+ * The lookup goes through the store's hash index, not a scan
  */
 int loadPlayerRecord(const char *username, PlayerRecord *record) {
-  FILE *file = fopen(LEADERBOARD_FILE, "r");
-  if (file == NULL) {
-    // File doesn't exist - initialize new player
-    strncpy(record->username, username, MAX_USERNAME - 1);
-    record->username[MAX_USERNAME - 1] = '\0';
-    record->wins = 0;
-    record->losses = 0;
-    record->draws = 0;
-    record->totalGames = 0;
-    return 0; // New player
-  }
-
-  // Search file for matching username
-  PlayerRecord temp;
-  while (fscanf(file, "%49s %d %d %d %d", temp.username, &temp.wins,
-                &temp.losses, &temp.draws, &temp.totalGames) == 5) {
-    if (strcmp(temp.username, username) == 0) {
-      *record = temp;  // Found - copy data
-      fclose(file);
-      return 1; // Returning player
-    }
-  }
-
-  fclose(file);
-
-  // Not found in file - initialize new player
+  TRACE_START(t);
+  Leaderboard *lb = getLeaderboard();
+  int found = lb != NULL && Leaderboard_get(lb, username, record);
+  TRACE_END_ARGS(t, "io", "loadPlayerRecord", "\"found\":%d", found);
+  if (found)
+    return 1; // Returning player
+
+  // Not found in store - initialize new player
   strncpy(record->username, username, MAX_USERNAME - 1);
   record->username[MAX_USERNAME - 1] = '\0';
   record->wins = 0;
@@ -129,65 +111,70 @@ int loadPlayerRecord(const char *username, PlayerRecord *record) {
 }
 
 /**
- * displayLeaderboard - Display ranked list of all players
+ * displayLeaderboard - Display ranked list of players, a page at a time
+ * @order: LEADERBOARD_BY_WINS, LEADERBOARD_BY_WIN_RATE or
+ *         LEADERBOARD_BY_GAMES (see leaderboard.h)
  * 
  * Shows table with:
- * - Player name
+ * - Rank and player name
  * - Total games played
  * - Wins, losses, draws
  * - Win rate percentage
  * 
- * Players sorted by win count (descending)
+ * Shows LEADERBOARD_PAGE_SIZE players, then asks before the next page.
+ * Each page is ranked straight from the store, so memory use does not
+ * grow with the number of players
  */
-void displayLeaderboard() {
-  FILE *file = fopen(LEADERBOARD_FILE, "r");
-  if (file == NULL) {
+void displayLeaderboard(int order) {
+  static const char *orderNames[] = {"wins", "win rate", "games played"};
+  Leaderboard *lb = getLeaderboard();
+  LeaderboardRank page[LEADERBOARD_PAGE_SIZE];
+  if (lb != NULL)
+    Leaderboard_flush(lb);  // Rank this session's results too
+  if (order < LEADERBOARD_BY_WINS || order > LEADERBOARD_BY_GAMES)
+    order = LEADERBOARD_BY_WINS;
+  int n = lb != NULL ? Leaderboard_rank(lb, order, NULL, page,
+                                        LEADERBOARD_PAGE_SIZE)
+                     : 0;
+  if (n == 0) {
     printf("\n=== LEADERBOARD ===\n");
     printf("No games played yet!\n");
     printf("===================\n\n");
     return;
   }
-
-  PlayerRecord records[100];
-  int count = 0;
-
-  // Read all records from file
-  while (count < 100 &&
-         fscanf(file, "%49s %d %d %d %d", records[count].username,
-                &records[count].wins, &records[count].losses,
-                &records[count].draws, &records[count].totalGames) == 5) {
-    count++;
-  }
-  fclose(file);
-
-  // Sort by wins (descending) using bubble sort
-  for (int i = 0; i < count - 1; i++) {
-    for (int j = 0; j < count - i - 1; j++) {
-      if (records[j].wins < records[j + 1].wins) {
-        PlayerRecord temp = records[j];
-        records[j] = records[j + 1];
-        records[j + 1] = temp;
-      }
-    }
-  }
+  int count = Leaderboard_count(lb);
 
   // Display formatted table
   printf("\n=================================== LEADERBOARD "
          "===================================\n");
-  printf("%-20s | %5s | %6s | %5s | %6s | Win Rate\n", "Player", "Games",
-         "Wins", "Loss", "Draws");
+  printf("Ranked by %s, %d players\n", orderNames[order], count);
+  printf("%5s | %-20s | %5s | %6s | %5s | %6s | Win Rate\n", "Rank", "Player",
+         "Games", "Wins", "Loss", "Draws");
   printf(
       "------------------------------------------------------------------------"
       "-----------\n");
 
-  for (int i = 0; i < count; i++) {
-    // Calculate win rate percentage
-    double winRate = records[i].totalGames > 0
-                         ? (records[i].wins * 100.0) / records[i].totalGames
-                         : 0.0;
-    printf("%-20s | %5d | %6d | %5d | %6d | %.1f%%\n", records[i].username,
-           records[i].totalGames, records[i].wins, records[i].losses,
-           records[i].draws, winRate);
+  int rank = 0;
+  while (n > 0) {
+    for (int i = 0; i < n; i++) {
+      const PlayerRecord *r = &page[i].record;
+      // Calculate win rate percentage
+      double winRate = r->totalGames > 0 ? (r->wins * 100.0) / r->totalGames
+                                         : 0.0;
+      printf("%5d | %-20s | %5d | %6d | %5d | %6d | %.1f%%\n", ++rank,
+             r->username, r->totalGames, r->wins, r->losses, r->draws,
+             winRate);
+    }
+    if (n < LEADERBOARD_PAGE_SIZE || rank >= count)
+      break;
+
+    char answer[16];
+    printf("-- %d of %d shown, Enter for more, q to stop: ", rank, count);
+    if (fgets(answer, sizeof(answer), stdin) == NULL || answer[0] == 'q' ||
+        answer[0] == 'Q')
+      break;
+    LeaderboardRank last = page[n - 1];
+    n = Leaderboard_rank(lb, order, &last, page, LEADERBOARD_PAGE_SIZE);
   }
   printf(
       "========================================================================"
@@ -199,60 +186,117 @@ void displayLeaderboard() {
  * @username: Player's username
  * @winner: Game result ('X'=player won, 'O'=player lost, 'D'=draw)
  * 
- * Process:
- * 1. Load player's current record
- * 2. Increment total games
- * 3. Update appropriate counter (wins/losses/draws)
- * 4. Save updated record back to file
+ * The result is buffered in the leaderboard handle and written back with
+ * the rest of its batch (see Leaderboard_addResult), when the leaderboard
+ * is displayed, or on closeLeaderboard
  */
 void updateLeaderboard(const char *username, char winner) {
-  PlayerRecord record;
-  loadPlayerRecord(username, &record);
-
-  record.totalGames++;
-  if (winner == 'X')      // Player wins
-    record.wins++;
-  else if (winner == 'O') // AI wins (player loses)
-    record.losses++;
-  else                    // Draw
-    record.draws++;
-
-  savePlayerRecord(&record);
+  TRACE_START(t);
+  Leaderboard *lb = getLeaderboard();
+  if (lb == NULL)
+    return;
+  if (!Leaderboard_addResult(lb, username, winner == 'X', winner == 'O',
+                             winner != 'X' && winner != 'O'))
+    printf("Error: Could not save player record.\n");
+  TRACE_END(t, "io", "updateLeaderboard");
 }
 
 /* ==================== STATISTICS FUNCTIONS ==================== */
 
+/* History sink shared by every call in this process (see getGameHistory) */
+static GameHistory *g_history = NULL;
+static int g_historyFormat = HISTORY_FORMAT_TEXT;
+
+/**
+ * statsFilePath - History file for the current format
+ */
+static const char *statsFilePath() {
+  return g_historyFormat == HISTORY_FORMAT_BINARY ? STATS_BINARY_FILE
+                                                  : STATS_FILE;
+}
+
+/**
+ * getGameHistory - Open the history sink on first use
+ * 
+ * Returns: Sink, or NULL if it cannot be opened (an error is printed)
+ */
+static GameHistory *getGameHistory() {
+  if (g_history == NULL) {
+    g_history = GameHistory_open(statsFilePath(), g_historyFormat,
+                                 HISTORY_DEFAULT_BATCH,
+                                 HISTORY_DEFAULT_FLUSH_MS);
+    if (g_history == NULL)
+      printf("Error: Could not open game statistics file %s.\n",
+             statsFilePath());
+  }
+  return g_history;
+}
+
+/**
+ * setGameStatsFormat - Choose the history file format
+ * @format: HISTORY_FORMAT_TEXT (game_stats.txt) or HISTORY_FORMAT_BINARY
+ *          (game_stats.bin)
+ * 
+ * Any games buffered for the previous format are written first
+ */
+void setGameStatsFormat(int format) {
+  closeGameStats();
+  g_historyFormat = format;
+}
+
+/**
+ * closeGameStats - Write buffered games and close the history file
+ * 
+ * Safe to call when it was never opened; the next statistics call
+ * reopens it
+ */
+void closeGameStats() {
+  TRACE_START(t);
+  GameHistory_close(g_history);
+  TRACE_END(t, "io", "closeGameStats");
+  g_history = NULL;
+}
+
 /**
  * saveGameStats - Append game statistics to history file
  * @stats: Pointer to GameStats containing match details
  * 
- * Logs to file with format:
- * "Timestamp | Match: P1 vs P2 | Moves: N (P1: X, P2: Y) | AI Nodes: N | Depth: D | Winner: W"
+ * The game is buffered in memory and written with the rest of its batch,
+ * at most HISTORY_DEFAULT_FLUSH_MS later, or when the history is read or
+ * closed. Text lines use the format of GameHistory_formatLine
  * 
  * File is appended (not overwritten) to maintain complete history
  */
 void saveGameStats(const GameStats *stats) {
-  FILE *file = fopen(STATS_FILE, "a");  // Append mode
-  if (file == NULL) {
+  TRACE_START(t);
+  GameHistory *history = getGameHistory();
+  if (history == NULL || !GameHistory_append(history, stats))
     printf("Error: Could not save game statistics.\n");
-    return;
-  }
+  TRACE_END(t, "io", "saveGameStats");
+}
 
-  // Get current timestamp
-  time_t now = time(NULL);
-  char *timeStr = ctime(&now);
-  timeStr[strlen(timeStr) - 1] = '\0'; // Remove newline from timestamp
+/**
+ * StatsFilter - Which binary history entries displayStats prints
+ */
+typedef struct {
+  const char *username;  // Player to match, or NULL for every game
+  int gameNum;           // Next game number to print
+  int found;             // 1 once a game was printed
+} StatsFilter;
 
-  // Write formatted game statistics
-  fprintf(file,
-          "%s | Match: %s vs %s | Moves: %d (%s: %d, %s: %d) | AI Nodes: %d | "
-          "Depth: %d | Winner: %c\n",
-          timeStr, stats->player1, stats->player2, stats->totalMoves,
-          stats->player1, stats->player1Moves, stats->player2,
-          stats->player2Moves, stats->aiNodesExplored, stats->maxDepth,
-          stats->winner);
+/**
+ * printStatsEntry - GameHistory_forEach callback printing one game
+ */
+static void printStatsEntry(const GameStats *stats, time_t when, void *arg) {
+  StatsFilter *filter = arg;
+  if (filter->username != NULL && strcmp(stats->player1, filter->username) &&
+      strcmp(stats->player2, filter->username))
+    return;
 
-  fclose(file);
+  char line[HISTORY_LINE_MAX];
+  GameHistory_formatLine(line, sizeof(line), stats, when);
+  printf("Game %d: %s", filter->gameNum++, line);
+  filter->found = 1;
 }
 
 /**
@@ -262,7 +306,10 @@ void saveGameStats(const GameStats *stats) {
  * Games numbered sequentially for easy reference
  */
 void displayAllStats() {
-  FILE *file = fopen(STATS_FILE, "r");
+  TRACE_START(t);
+  GameHistory_flush(g_history);  // Include games still in the buffer
+
+  FILE *file = fopen(statsFilePath(), "r");
   if (file == NULL) {
     printf("\n=== GAME STATISTICS ===\n");
     printf("No game statistics available yet!\n");
@@ -273,18 +320,25 @@ void displayAllStats() {
   printf("\n================================= GAME STATISTICS "
          "=================================\n");
 
-  char line[512];
-  int gameNum = 1;
-  
-  // Read and display each line from file
-  while (fgets(line, sizeof(line), file) != NULL) {
-    printf("Game %d: %s", gameNum++, line);
+  if (g_historyFormat == HISTORY_FORMAT_BINARY) {
+    StatsFilter filter = {NULL, 1, 0};
+    if (GameHistory_forEach(STATS_BINARY_FILE, printStatsEntry, &filter) < 0)
+      printf("Error: %s is not a game history file.\n", STATS_BINARY_FILE);
+  } else {
+    char line[HISTORY_LINE_MAX];
+    int gameNum = 1;
+
+    // Read and display each line from file
+    while (fgets(line, sizeof(line), file) != NULL) {
+      printf("Game %d: %s", gameNum++, line);
+    }
   }
 
   printf(
       "========================================================================"
       "===========\n\n");
   fclose(file);
+  TRACE_END(t, "io", "displayAllStats");
 }
 
 /**
@@ -295,7 +349,10 @@ void displayAllStats() {
  * Searches for username in both player1 and player2 positions
  */
 void displayPlayerStats(const char *username) {
-  FILE *file = fopen(STATS_FILE, "r");
+  TRACE_START(t);
+  GameHistory_flush(g_history);  // Include games still in the buffer
+
+  FILE *file = fopen(statsFilePath(), "r");
   if (file == NULL) {
     printf("\n=== STATISTICS FOR %s ===\n", username);
     printf("No game statistics available yet!\n");
@@ -307,23 +364,43 @@ void displayPlayerStats(const char *username) {
          "===========================\n",
          username);
 
-  char line[512];
-  int gameNum = 1;
   int found = 0;
 
-  // Read each line and check if username appears
-  while (fgets(line, sizeof(line), file) != NULL) {
-    // Create search patterns for both player positions
-    char searchPattern1[MAX_USERNAME + 10];
-    char searchPattern2[MAX_USERNAME + 10];
-    snprintf(searchPattern1, sizeof(searchPattern1), "Match: %s vs", username);
-    snprintf(searchPattern2, sizeof(searchPattern2), "vs %s |", username);
-
-    // Check if username appears in either position
-    if (strstr(line, searchPattern1) != NULL ||
-        strstr(line, searchPattern2) != NULL) {
-      printf("Game %d: %s", gameNum++, line);
-      found = 1;
+  if (g_historyFormat == HISTORY_FORMAT_BINARY) {
+    // The player index finds the player's records without a full scan
+    HistoryIndex *index = HistoryIndex_open(STATS_BINARY_FILE);
+    StatsFilter filter = {username, 1, 0};
+    PlayerHistory totals;
+    if (index == NULL) {
+      printf("Error: %s is not a game history file.\n", STATS_BINARY_FILE);
+    } else if (HistoryIndex_player(index, username, &totals)) {
+      HistoryIndex_forEachGame(index, username, printStatsEntry, &filter);
+      printf("Totals: %d games, %d wins, %d losses, %d draws | AI nodes: %lld"
+             " | Own AI nodes: %lld | Max depth: %d\n",
+             totals.games, totals.wins, totals.losses, totals.draws,
+             totals.aiNodes, totals.searchNodes, totals.maxDepth);
+    }
+    HistoryIndex_close(index);
+    found = filter.found;
+  } else {
+    char line[HISTORY_LINE_MAX];
+    int gameNum = 1;
+
+    // Read each line and check if username appears
+    while (fgets(line, sizeof(line), file) != NULL) {
+      // Create search patterns for both player positions
+      char searchPattern1[MAX_USERNAME + 10];
+      char searchPattern2[MAX_USERNAME + 10];
+      snprintf(searchPattern1, sizeof(searchPattern1), "Match: %s vs",
+               username);
+      snprintf(searchPattern2, sizeof(searchPattern2), "vs %s |", username);
+
+      // Check if username appears in either position
+      if (strstr(line, searchPattern1) != NULL ||
+          strstr(line, searchPattern2) != NULL) {
+        printf("Game %d: %s", gameNum++, line);
+        found = 1;
+      }
     }
   }
 
@@ -335,6 +412,7 @@ void displayPlayerStats(const char *username) {
       "========================================================================"
       "===\n\n");
   fclose(file);
+  TRACE_END(t, "io", "displayPlayerStats");
 }
 
 /* ==================== AI PERSONALITY FUNCTIONS ==================== */
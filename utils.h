@@ -8,10 +8,16 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include "ai.h"
+
 /* File and configuration constants */
 #define MAX_USERNAME 50              // Maximum length for player usernames
-#define LEADERBOARD_FILE "leaderboard.txt"  // File storing player rankings
+#define LEADERBOARD_FILE "leaderboard.txt"  // Old text leaderboard, imported once
+#define LEADERBOARD_STORE_FILE "leaderboard.bin"  // Indexed binary player records
+#define LEADERBOARD_PAGE_SIZE 20     // Players per leaderboard page
 #define STATS_FILE "game_stats.txt"         // File storing game history
+#define STATS_BINARY_FILE "game_stats.bin"  // Game history in binary records
+#define REPLAY_FILE "game_replays.bin"      // Move-by-move records of logged games
 
 /**
  * PlayerRecord structure
@@ -36,8 +42,10 @@ typedef struct {
   int totalMoves;               // Total moves made in the game
   int player1Moves;             // Number of X moves
   int player2Moves;             // Number of O moves
-  int aiNodesExplored;          // Nodes explored by AI (minimax performance)
-  int maxDepth;                 // Maximum search depth reached by AI
+  int aiNodesExplored;          // Nodes explored by every AI in the match
+  int maxDepth;                 // Maximum search depth reached by any AI
+  AIStats player1AI;            // Search totals of the AI playing X (zero for a human)
+  AIStats player2AI;            // Search totals of the AI playing O (zero for a human)
   char winner;                  // 'X' for player1 wins, 'O' for player2 wins, 'D' for draw
 } GameStats;
 
@@ -54,7 +62,8 @@ void clearScreen();
  * savePlayerRecord - Save or update a player's record to leaderboard file
  * @record: Pointer to PlayerRecord to save
  * 
- * Updates existing record or appends new record to leaderboard.txt
+ * Updates the record in place, or appends it for a new player, in the
+ * indexed store (leaderboard.bin)
  */
 void savePlayerRecord(const PlayerRecord *record);
 
@@ -68,11 +77,21 @@ void savePlayerRecord(const PlayerRecord *record);
 int loadPlayerRecord(const char *username, PlayerRecord *record);
 
 /**
- * displayLeaderboard - Display ranked list of all players
+ * displayLeaderboard - Display ranked list of players, a page at a time
+ * @order: LEADERBOARD_BY_WINS, LEADERBOARD_BY_WIN_RATE or
+ *         LEADERBOARD_BY_GAMES (see leaderboard.h)
+ * 
+ * Shows rank, username, games, wins, losses, draws, and win rate,
+ * LEADERBOARD_PAGE_SIZE players per page
+ */
+void displayLeaderboard(int order);
+
+/**
+ * closeLeaderboard - Write back pending results and close the store
  * 
- * Shows all players sorted by win count with statistics table
+ * Call once before exit; any later leaderboard call reopens it
  */
-void displayLeaderboard();
+void closeLeaderboard();
 
 /**
  * updateLeaderboard - Update a player's record after game completion
@@ -89,10 +108,26 @@ void updateLeaderboard(const char *username, char winner);
  * saveGameStats - Log game statistics to history file
  * @stats: Pointer to GameStats containing match details
  * 
- * Appends game record to game_stats.txt with timestamp
+ * Appends game record to game_stats.txt (or game_stats.bin) with
+ * timestamp, plus the search totals of each side played by an AI.
+ * Records are buffered and written in batches
  */
 void saveGameStats(const GameStats *stats);
 
+/**
+ * setGameStatsFormat - Choose the history file format
+ * @format: HISTORY_FORMAT_TEXT (game_stats.txt) or HISTORY_FORMAT_BINARY
+ *          (game_stats.bin), see history.h
+ */
+void setGameStatsFormat(int format);
+
+/**
+ * closeGameStats - Write buffered games and close the history file
+ * 
+ * Call once before exit; any later statistics call reopens it
+ */
+void closeGameStats();
+
 /**
  * displayAllStats - Display complete game history
  * 